@@ -7,13 +7,34 @@ apt-get -qq install libusb-1.0-0-dev
 apt-get -qq install qt5-default
 apt-get -qq install qtbase5-dev
 echo Copying source code files...
+mkdir -p /usr/local/src/mcp2210-conf/benchmarks/mcp2210-codecbench
+mkdir -p /usr/local/src/mcp2210-conf/benchmarks/mcp2210-coroping
+mkdir -p /usr/local/src/mcp2210-conf/benchmarks/mcp2210-lockstress
+mkdir -p /usr/local/src/mcp2210-conf/benchmarks/mcp2210-ping
+mkdir -p /usr/local/src/mcp2210-conf/benchmarks/mcp2210-spisweep
+mkdir -p /usr/local/src/mcp2210-conf/daemon
 mkdir -p /usr/local/src/mcp2210-conf/icons/buttons
 mkdir -p /usr/local/src/mcp2210-conf/images
+mkdir -p /usr/local/src/mcp2210-conf/lib
 mkdir -p /usr/local/src/mcp2210-conf/misc
 mkdir -p /usr/local/src/mcp2210-conf/translations
 cp -f src/aboutdialog.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/aboutdialog.h /usr/local/src/mcp2210-conf/.
 cp -f src/aboutdialog.ui /usr/local/src/mcp2210-conf/.
+cp -f src/benchmarks/benchmarkcommon.cpp /usr/local/src/mcp2210-conf/benchmarks/.
+cp -f src/benchmarks/benchmarkcommon.h /usr/local/src/mcp2210-conf/benchmarks/.
+cp -f src/benchmarks/benchmarks.pri /usr/local/src/mcp2210-conf/benchmarks/.
+cp -f src/benchmarks/benchmarks.pro /usr/local/src/mcp2210-conf/benchmarks/.
+cp -f src/benchmarks/mcp2210-codecbench/main.cpp /usr/local/src/mcp2210-conf/benchmarks/mcp2210-codecbench/.
+cp -f src/benchmarks/mcp2210-codecbench/mcp2210-codecbench.pro /usr/local/src/mcp2210-conf/benchmarks/mcp2210-codecbench/.
+cp -f src/benchmarks/mcp2210-coroping/main.cpp /usr/local/src/mcp2210-conf/benchmarks/mcp2210-coroping/.
+cp -f src/benchmarks/mcp2210-coroping/mcp2210-coroping.pro /usr/local/src/mcp2210-conf/benchmarks/mcp2210-coroping/.
+cp -f src/benchmarks/mcp2210-lockstress/main.cpp /usr/local/src/mcp2210-conf/benchmarks/mcp2210-lockstress/.
+cp -f src/benchmarks/mcp2210-lockstress/mcp2210-lockstress.pro /usr/local/src/mcp2210-conf/benchmarks/mcp2210-lockstress/.
+cp -f src/benchmarks/mcp2210-ping/main.cpp /usr/local/src/mcp2210-conf/benchmarks/mcp2210-ping/.
+cp -f src/benchmarks/mcp2210-ping/mcp2210-ping.pro /usr/local/src/mcp2210-conf/benchmarks/mcp2210-ping/.
+cp -f src/benchmarks/mcp2210-spisweep/main.cpp /usr/local/src/mcp2210-conf/benchmarks/mcp2210-spisweep/.
+cp -f src/benchmarks/mcp2210-spisweep/mcp2210-spisweep.pro /usr/local/src/mcp2210-conf/benchmarks/mcp2210-spisweep/.
 cp -f src/common.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/common.h /usr/local/src/mcp2210-conf/.
 cp -f src/configuration.cpp /usr/local/src/mcp2210-conf/.
@@ -25,7 +46,17 @@ cp -f src/configurationwriter.h /usr/local/src/mcp2210-conf/.
 cp -f src/configuratorwindow.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/configuratorwindow.h /usr/local/src/mcp2210-conf/.
 cp -f src/configuratorwindow.ui /usr/local/src/mcp2210-conf/.
+cp -f src/daemon/main.cpp /usr/local/src/mcp2210-conf/daemon/.
+cp -f src/daemon/mcp2210d.pro /usr/local/src/mcp2210-conf/daemon/.
+cp -f src/daemon/mcp2210server.cpp /usr/local/src/mcp2210-conf/daemon/.
+cp -f src/daemon/mcp2210server.h /usr/local/src/mcp2210-conf/daemon/.
+cp -f src/deviceinventoryworker.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/deviceinventoryworker.h /usr/local/src/mcp2210-conf/.
+cp -f src/devicetablemodel.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/devicetablemodel.h /usr/local/src/mcp2210-conf/.
 cp -f src/GPL.txt /usr/local/src/mcp2210-conf/.
+cp -f src/hidrawtransport.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/hidrawtransport.h /usr/local/src/mcp2210-conf/.
 cp -f src/icons/active64.png /usr/local/src/mcp2210-conf/icons/.
 cp -f src/icons/buttons/password-reveal.png /usr/local/src/mcp2210-conf/icons/buttons/.
 cp -f src/icons/buttons/password-reveal.svg /usr/local/src/mcp2210-conf/icons/buttons/.
@@ -36,23 +67,67 @@ cp -f src/icons/selected64.png /usr/local/src/mcp2210-conf/icons/.
 cp -f src/images/banner.png /usr/local/src/mcp2210-conf/images/.
 cp -f src/images/banner.svg /usr/local/src/mcp2210-conf/images/.
 cp -f src/LGPL.txt /usr/local/src/mcp2210-conf/.
+cp -f src/lib/mcp2210core.pro /usr/local/src/mcp2210-conf/lib/.
 cp -f src/libusb-extra.c /usr/local/src/mcp2210-conf/.
 cp -f src/libusb-extra.h /usr/local/src/mcp2210-conf/.
+cp -f src/libusbeventthread.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/libusbeventthread.h /usr/local/src/mcp2210-conf/.
+cp -f src/libusbtransport.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/libusbtransport.h /usr/local/src/mcp2210-conf/.
 cp -f src/main.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/mainwindow.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/mainwindow.h /usr/local/src/mcp2210-conf/.
 cp -f src/mainwindow.ui /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210-conf-app.pro /usr/local/src/mcp2210-conf/.
 cp -f src/mcp2210-conf.pro /usr/local/src/mcp2210-conf/.
 cp -f src/mcp2210.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/mcp2210.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210async.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210async.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210coalescer.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210coalescer.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210codec.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210contextswitcher.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210contextswitcher.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210core.pri /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210corelib.pri /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210coro.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210devicecache.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210devicecache.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210devicelock.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210devicelock.h /usr/local/src/mcp2210-conf/.
 cp -f src/mcp2210eeprom.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/mcp2210eeprom.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210emulator.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210emulator.h /usr/local/src/mcp2210-conf/.
 cp -f src/mcp2210limits.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210monitor.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210monitor.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210pool.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210pool.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210protocol.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210protocol.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210state.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210state.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210stats.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210stats.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210tracer.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210tracer.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210transport.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210transport.h /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210watchdog.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/mcp2210watchdog.h /usr/local/src/mcp2210-conf/.
 cp -f src/misc/mcp2210-conf.desktop /usr/local/src/mcp2210-conf/misc/.
 cp -f src/passworddialog.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/passworddialog.h /usr/local/src/mcp2210-conf/.
 cp -f src/passworddialog.ui /usr/local/src/mcp2210-conf/.
+cp -f src/recordingtransport.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/recordingtransport.h /usr/local/src/mcp2210-conf/.
+cp -f src/replaytransport.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/replaytransport.h /usr/local/src/mcp2210-conf/.
 cp -f src/resources.qrc /usr/local/src/mcp2210-conf/.
+cp -f src/sockettransport.cpp /usr/local/src/mcp2210-conf/.
+cp -f src/sockettransport.h /usr/local/src/mcp2210-conf/.
 cp -f src/statusdialog.cpp /usr/local/src/mcp2210-conf/.
 cp -f src/statusdialog.h /usr/local/src/mcp2210-conf/.
 cp -f src/statusdialog.ui /usr/local/src/mcp2210-conf/.
@@ -0,0 +1,101 @@
+/* MCP2210 benchmark common functions for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <algorithm>
+#include <QObject>
+#include "benchmarkcommon.h"
+
+// Returns the summary as a JSON object
+QJsonObject LatencySummary::toJson() const
+{
+    QJsonObject object;
+    object["samples"] = samples;
+    object["min_us"] = min;
+    object["median_us"] = median;
+    object["p99_us"] = p99;
+    object["max_us"] = max;
+    object["mean_us"] = mean;
+    object["ops_per_second"] = rate;
+    return object;
+}
+
+// Returns the summary in human readable form
+QString LatencySummary::toString() const
+{
+    return QObject::tr("samples: %1, min: %2 us, median: %3 us, p99: %4 us, max: %5 us, mean: %6 us, rate: %7 ops/s")
+        .arg(samples)
+        .arg(min, 0, 'f', 1)
+        .arg(median, 0, 'f', 1)
+        .arg(p99, 0, 'f', 1)
+        .arg(max, 0, 'f', 1)
+        .arg(mean, 0, 'f', 1)
+        .arg(rate, 0, 'f', 1);
+}
+
+// Opens the device having the given VID, PID and, optionally, serial number, reporting any failure via "errstr"
+bool openDevice(MCP2210 &mcp2210, quint16 vid, quint16 pid, const QString &serial, QString &errstr)
+{
+    int err = mcp2210.open(vid, pid, serial);
+    if (err == MCP2210::ERROR_INIT) {
+        errstr += QObject::tr("Could not initialize libusb.\n");
+    } else if (err == MCP2210::ERROR_NOT_FOUND) {
+        errstr += QObject::tr("Could not find device.\n");
+    } else if (err == MCP2210::ERROR_BUSY) {
+        errstr += QObject::tr("Device is currently unavailable.\n");
+    } else if (err == MCP2210::ERROR_ACCESS) {
+        errstr += QObject::tr("Access to the device was denied.\n");
+    } else if (err != MCP2210::SUCCESS) {
+        errstr += QObject::tr("Could not open device (error %1).\n").arg(err);
+    }
+    return err == MCP2210::SUCCESS;
+}
+
+// Parses a hexadecimal VID or PID
+quint16 parseHexID(const QString &text, bool &ok)
+{
+    uint value = text.toUInt(&ok, 16);
+    ok = ok && value <= 0xffff;
+    return static_cast<quint16>(value);
+}
+
+// Summarizes the given latencies (in nanoseconds), measured over the given elapsed time (also in nanoseconds)
+LatencySummary summarizeLatencies(QVector<qint64> latencies, qint64 elapsed)
+{
+    LatencySummary summary;
+    summary.samples = latencies.size();
+    if (latencies.isEmpty()) {
+        summary.min = summary.median = summary.p99 = summary.max = summary.mean = summary.rate = 0;
+    } else {
+        std::sort(latencies.begin(), latencies.end());
+        qint64 sum = 0;
+        for (qint64 latency : latencies) {
+            sum += latency;
+        }
+        int last = latencies.size() - 1;
+        summary.min = latencies.first() / 1000.0;
+        summary.median = latencies.at(last / 2) / 1000.0;
+        summary.p99 = latencies.at(static_cast<int>(0.99 * last + 0.5)) / 1000.0;
+        summary.max = latencies.last() / 1000.0;
+        summary.mean = static_cast<double>(sum) / latencies.size() / 1000.0;
+        summary.rate = elapsed > 0 ? 1e9 * latencies.size() / elapsed : 0;
+    }
+    return summary;
+}
@@ -0,0 +1,48 @@
+/* MCP2210 benchmark common functions for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef BENCHMARKCOMMON_H
+#define BENCHMARKCOMMON_H
+
+// Includes
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include "mcp2210.h"
+
+// Summary of a set of latency samples (all times in microseconds)
+struct LatencySummary {
+    int samples;    // Number of samples
+    double min;     // Minimum latency
+    double median;  // Median latency
+    double p99;     // 99th percentile latency
+    double max;     // Maximum latency
+    double mean;    // Mean latency
+    double rate;    // Operations per second, over the total elapsed time
+
+    QJsonObject toJson() const;
+    QString toString() const;
+};
+
+bool openDevice(MCP2210 &mcp2210, quint16 vid, quint16 pid, const QString &serial, QString &errstr);
+quint16 parseHexID(const QString &text, bool &ok);
+LatencySummary summarizeLatencies(QVector<qint64> latencies, qint64 elapsed);
+
+#endif  // BENCHMARKCOMMON_H
@@ -0,0 +1,32 @@
+# Common project include file for the benchmark tools, which are console
+# applications linked against the same MCP2210 core library used by MCP2210
+# Configurator
+
+QT       += core
+QT       -= gui
+
+# Added to provide backwards compatibility (C++11 support)
+greaterThan(QT_MAJOR_VERSION, 4) {
+    CONFIG += c++11
+} else {
+    QMAKE_CXXFLAGS += -std=c++11
+}
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CORE_DIR = $$PWD/..
+
+include($$CORE_DIR/mcp2210corelib.pri)
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/benchmarkcommon.cpp
+
+HEADERS += \
+    $$PWD/benchmarkcommon.h
@@ -0,0 +1,14 @@
+# Project that builds all the benchmark tools, which link against the MCP2210
+# core library (see "benchmarks.pri")
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    mcp2210-codecbench \
+    mcp2210-lockstress \
+    mcp2210-ping \
+    mcp2210-spisweep
+
+# The coroutine benchmark requires C++20 coroutine support, which is only
+# available from GCC 10 onwards
+!lessThan(QMAKE_GCC_MAJOR_VERSION, 10): SUBDIRS += mcp2210-coroping
@@ -0,0 +1,321 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Host-side codec microbenchmark, which measures the time and the number of heap allocations taken to encode commands and decode responses
+// Responses are canned, having been captured beforehand from the software emulator, so that no hardware is involved and the transport overhead is minimal
+// Usage example: mcp2210-codecbench --iterations 100000 --json
+
+// Includes
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <QBuffer>
+#include <QByteArray>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include "configuration.h"
+#include "configurationreader.h"
+#include "configurationwriter.h"
+#include "mcp2210.h"
+#include "mcp2210emulator.h"
+#include "mcp2210transport.h"
+
+// Heap allocation counting, which is only available with glibc (the C library functions are wrapped, since Qt containers allocate via malloc() directly)
+#ifdef __GLIBC__
+static std::atomic<unsigned long> allocationCount(0);
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+
+static long allocations()
+{
+    return static_cast<long>(allocationCount.load(std::memory_order_relaxed));
+}
+#else
+static long allocations()
+{
+    return -1;  // Not available
+}
+#endif
+
+// Transport that serves canned responses, which are captured from the software emulator while learning
+// Responses are stored per command ID, except for "GET_NVRAM_SETTINGS", whose responses are stored per sub-command ID
+class CannedTransport : public MCP2210Transport
+{
+private:
+    MCP2210Emulator emulator_;
+    bool learning_;
+    quint8 command_, subcommand_;
+    unsigned char responses_[256][64];
+    unsigned char nvResponses_[256][64];
+
+public:
+    CannedTransport() :
+        learning_(true),
+        command_(0x00),
+        subcommand_(0x00)
+    {
+        std::memset(responses_, 0x00, sizeof(responses_));
+        std::memset(nvResponses_, 0x00, sizeof(nvResponses_));
+    }
+
+    bool isOpen() const
+    {
+        return emulator_.isOpen();
+    }
+
+    void close()
+    {
+        emulator_.close();
+    }
+
+    int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+    {
+        int result = 0;
+        if (endpointAddr < 0x80) {  // OUT direction
+            command_ = data[0];
+            subcommand_ = data[1];
+            if (learning_) {
+                result = emulator_.interruptTransfer(endpointAddr, data, length, transferred, timeout);
+            } else if (transferred != nullptr) {
+                *transferred = length;
+            }
+        } else {  // IN direction
+            unsigned char *response = command_ == MCP2210::GET_NVRAM_SETTINGS ? nvResponses_[subcommand_] : responses_[command_];
+            if (learning_) {
+                result = emulator_.interruptTransfer(endpointAddr, data, length, transferred, timeout);
+                std::memcpy(response, data, MCP2210::COMMAND_SIZE);
+            } else {
+                std::memcpy(data, response, MCP2210::COMMAND_SIZE);
+                if (transferred != nullptr) {
+                    *transferred = length;
+                }
+            }
+        }
+        return result;
+    }
+
+    QStringList listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr)
+    {
+        return emulator_.listDevices(vid, pid, errcnt, errstr);
+    }
+
+    int open(quint16 vid, quint16 pid, const QString &serial)
+    {
+        return emulator_.open(vid, pid, serial);
+    }
+
+    void setLearning(bool learning)
+    {
+        learning_ = learning;
+    }
+};
+
+// A single benchmark case
+struct BenchmarkCase {
+    QString name;
+    int iterations;
+    std::function<void()> function;
+};
+
+// Result of a benchmark case
+struct BenchmarkResult {
+    QString name;
+    int iterations;
+    double nsPerOperation;
+    double allocationsPerOperation;  // Negative if not available
+};
+
+// Runs the given case, after a short warm-up
+static BenchmarkResult runCase(const BenchmarkCase &benchmarkCase)
+{
+    for (int i = 0; i < benchmarkCase.iterations / 100 + 1; ++i) {
+        benchmarkCase.function();
+    }
+    long allocationsBefore = allocations();
+    QElapsedTimer clock;
+    clock.start();
+    for (int i = 0; i < benchmarkCase.iterations; ++i) {
+        benchmarkCase.function();
+    }
+    qint64 elapsed = clock.nsecsElapsed();
+    long allocationsAfter = allocations();
+    BenchmarkResult result;
+    result.name = benchmarkCase.name;
+    result.iterations = benchmarkCase.iterations;
+    result.nsPerOperation = static_cast<double>(elapsed) / benchmarkCase.iterations;
+    result.allocationsPerOperation = allocationsBefore < 0 ? -1 : static_cast<double>(allocationsAfter - allocationsBefore) / benchmarkCase.iterations;
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mcp2210-codecbench");
+    QCoreApplication::setApplicationVersion("1.0.0");
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("MCP2210 host-side codec microbenchmark."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption iterationsOption("iterations", QObject::tr("Number of iterations per command case (default 100000). XML cases use a tenth of this value."), "n", "100000");
+    QCommandLineOption filterOption("filter", QObject::tr("Only run cases whose name contains the given text."), "text");
+    QCommandLineOption jsonOption("json", QObject::tr("Print results in JSON format."));
+    parser.addOption(iterationsOption);
+    parser.addOption(filterOption);
+    parser.addOption(jsonOption);
+    parser.process(app);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    bool iterationsOk;
+    int iterations = parser.value(iterationsOption).toInt(&iterationsOk);
+    if (!iterationsOk || iterations < 10) {
+        err << QObject::tr("Invalid arguments.") << "\n";
+        return EXIT_FAILURE;
+    }
+    CannedTransport *transport = new CannedTransport;
+    MCP2210 mcp2210(transport);  // Takes ownership of the transport
+    mcp2210.open(MCP2210::VID, MCP2210::PID);
+    int errcnt = 0;
+    QString errstr;
+    Configuration configuration;  // Read once while learning, and also used as the input for the encoding and XML cases
+    configuration.manufacturer = mcp2210.getManufacturerDesc(errcnt, errstr);
+    configuration.product = mcp2210.getProductDesc(errcnt, errstr);
+    configuration.usbParameters = mcp2210.getUSBParameters(errcnt, errstr);
+    configuration.chipSettings = mcp2210.getNVChipSettings(errcnt, errstr);
+    configuration.spiSettings = mcp2210.getNVSPISettings(errcnt, errstr);
+    configuration.accessMode = mcp2210.getAccessControlMode(errcnt, errstr);
+    MCP2210::ChipSettings chipSettings = mcp2210.getChipSettings(errcnt, errstr);
+    MCP2210::SPISettings spiSettings = mcp2210.getSPISettings(errcnt, errstr);
+    mcp2210.getChipStatus(errcnt, errstr);
+    mcp2210.getGPIOs(errcnt, errstr);
+    mcp2210.readEEPROMByte(0x00, errcnt, errstr);
+    mcp2210.configureChipSettings(chipSettings, errcnt, errstr);
+    mcp2210.configureSPISettings(spiSettings, errcnt, errstr);
+    mcp2210.writeNVSPISettings(configuration.spiSettings, errcnt, errstr);  // All NVRAM writes share the same canned response
+    if (errcnt > 0) {
+        err << errstr;
+        return EXIT_FAILURE;
+    }
+    transport->setLearning(false);
+    QByteArray xml;
+    {
+        QBuffer buffer(&xml);
+        buffer.open(QIODevice::WriteOnly);
+        ConfigurationWriter writer(configuration);
+        writer.writeTo(&buffer);
+    }
+    QVector<quint8> rawCommand{MCP2210::GET_CHIP_STATUS};
+    QVector<BenchmarkCase> cases{
+        {"hidTransfer (GET_CHIP_STATUS)", iterations, [&]() { mcp2210.hidTransfer(rawCommand, errcnt, errstr); }},
+        {"getChipStatus", iterations, [&]() { mcp2210.getChipStatus(errcnt, errstr); }},
+        {"getGPIOs", iterations, [&]() { mcp2210.getGPIOs(errcnt, errstr); }},
+        {"getChipSettings", iterations, [&]() { mcp2210.getChipSettings(errcnt, errstr); }},
+        {"getNVChipSettings", iterations, [&]() { mcp2210.getNVChipSettings(errcnt, errstr); }},
+        {"getSPISettings", iterations, [&]() { mcp2210.getSPISettings(errcnt, errstr); }},
+        {"getNVSPISettings", iterations, [&]() { mcp2210.getNVSPISettings(errcnt, errstr); }},
+        {"getUSBParameters", iterations, [&]() { mcp2210.getUSBParameters(errcnt, errstr); }},
+        {"getManufacturerDesc", iterations, [&]() { mcp2210.getManufacturerDesc(errcnt, errstr); }},
+        {"getProductDesc", iterations, [&]() { mcp2210.getProductDesc(errcnt, errstr); }},
+        {"readEEPROMByte", iterations, [&]() { mcp2210.readEEPROMByte(0x00, errcnt, errstr); }},
+        {"configureChipSettings", iterations, [&]() { mcp2210.configureChipSettings(chipSettings, errcnt, errstr); }},
+        {"configureSPISettings", iterations, [&]() { mcp2210.configureSPISettings(spiSettings, errcnt, errstr); }},
+        {"writeNVSPISettings", iterations, [&]() { mcp2210.writeNVSPISettings(configuration.spiSettings, errcnt, errstr); }},
+        {"writeUSBParameters", iterations, [&]() { mcp2210.writeUSBParameters(configuration.usbParameters, errcnt, errstr); }},
+        {"writeManufacturerDesc", iterations, [&]() { mcp2210.writeManufacturerDesc(configuration.manufacturer, errcnt, errstr); }},
+        {"ConfigurationWriter::writeTo", iterations / 10, [&]() {
+            QByteArray output;
+            QBuffer buffer(&output);
+            buffer.open(QIODevice::WriteOnly);
+            ConfigurationWriter writer(configuration);
+            writer.writeTo(&buffer);
+        }},
+        {"ConfigurationReader::readFrom", iterations / 10, [&]() {
+            QBuffer buffer(&xml);
+            buffer.open(QIODevice::ReadOnly);
+            Configuration readConfiguration;
+            ConfigurationReader reader(readConfiguration);
+            reader.readFrom(&buffer);
+        }}
+    };
+    QVector<BenchmarkResult> results;
+    for (const BenchmarkCase &benchmarkCase : cases) {
+        if (!parser.isSet(filterOption) || benchmarkCase.name.contains(parser.value(filterOption))) {
+            results += runCase(benchmarkCase);
+        }
+    }
+    if (errcnt > 0) {  // Errors are not expected, since all responses are canned
+        err << errstr;
+        return EXIT_FAILURE;
+    }
+    if (parser.isSet(jsonOption)) {
+        QJsonArray array;
+        for (const BenchmarkResult &result : results) {
+            QJsonObject object;
+            object["name"] = result.name;
+            object["iterations"] = result.iterations;
+            object["ns_per_op"] = result.nsPerOperation;
+            object["allocs_per_op"] = result.allocationsPerOperation;
+            array.append(object);
+        }
+        QJsonObject report;
+        report["tool"] = QString("mcp2210-codecbench");
+        report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        report["results"] = array;
+        out << QJsonDocument(report).toJson();
+    } else {
+        for (const BenchmarkResult &result : results) {
+            out << QString("%1 %2 ns/op %3 allocs/op").arg(result.name, -32).arg(result.nsPerOperation, 10, 'f', 1).arg(result.allocationsPerOperation, 8, 'f', 2) << "\n";
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Coroutine latency benchmark, which runs many concurrent conversations over MCP2210Pool via "mcp2210coro.h", each one issuing "GET_CHIP_STATUS" repeatedly
+// Conversations are spread over all attached devices having the given VID and PID, and share the given number of pool workers
+// Usage example: MCP2210_TRANSPORT=emulator mcp2210-coroping --conversations 64 --workers 2 --iterations 1000
+
+// Includes
+#include <cstdlib>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include "benchmarkcommon.h"
+#include "mcp2210.h"
+#include "mcp2210coro.h"
+#include "mcp2210pool.h"
+
+// Results of a single conversation
+struct Conversation {
+    QVector<qint64> latencies;  // In nanoseconds
+    int errcnt;
+    QString errstr;
+};
+
+// Coroutine that opens the given device and issues the given number of commands, one at a time, signaling "done" when finished
+// The device is released before signaling, so that the pool can be destroyed right after the last conversation is done
+static MCP2210Coro::Task converse(MCP2210Pool *pool, quint16 vid, quint16 pid, QString serial, int iterations, const QElapsedTimer *clock, Conversation *conversation, QSemaphore *done)
+{
+    {
+        MCP2210Coro::Device device(pool->open(vid, pid, serial, conversation->errcnt, conversation->errstr));
+        for (int i = 0; i < iterations && device.isValid() && conversation->errcnt == 0; ++i) {
+            qint64 start = clock->nsecsElapsed();
+            co_await device.getChipStatus(conversation->errcnt, conversation->errstr);  // The coroutine is resumed on the pool worker assigned to the device
+            conversation->latencies += clock->nsecsElapsed() - start;
+        }
+    }
+    done->release();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mcp2210-coroping");
+    QCoreApplication::setApplicationVersion("1.0.0");
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("MCP2210 coroutine latency benchmark."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption vidOption("vid", QObject::tr("Vendor ID, in hexadecimal (default 04d8)."), "vid", "04d8");
+    QCommandLineOption pidOption("pid", QObject::tr("Product ID, in hexadecimal (default 00de)."), "pid", "00de");
+    QCommandLineOption conversationsOption("conversations", QObject::tr("Number of concurrent conversations (default 64)."), "n", "64");
+    QCommandLineOption workersOption("workers", QObject::tr("Number of pool workers (default 0, meaning one per processor core)."), "n", "0");
+    QCommandLineOption iterationsOption("iterations", QObject::tr("Number of commands issued by each conversation (default 1000)."), "n", "1000");
+    parser.addOption(vidOption);
+    parser.addOption(pidOption);
+    parser.addOption(conversationsOption);
+    parser.addOption(workersOption);
+    parser.addOption(iterationsOption);
+    parser.process(app);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    bool vidOk, pidOk, conversationsOk, workersOk, iterationsOk;
+    quint16 vid = parseHexID(parser.value(vidOption), vidOk);
+    quint16 pid = parseHexID(parser.value(pidOption), pidOk);
+    int conversationCount = parser.value(conversationsOption).toInt(&conversationsOk);
+    int workers = parser.value(workersOption).toInt(&workersOk);
+    int iterations = parser.value(iterationsOption).toInt(&iterationsOk);
+    if (!vidOk || !pidOk || !conversationsOk || conversationCount < 1 || !workersOk || workers < 0 || !iterationsOk || iterations < 1) {
+        err << QObject::tr("Invalid arguments.") << "\n";
+        return EXIT_FAILURE;
+    }
+    int errcnt = 0;
+    QString errstr;
+    QStringList serials = MCP2210::listDevices(vid, pid, errcnt, errstr);
+    if (errcnt > 0) {
+        err << errstr;
+        return EXIT_FAILURE;
+    }
+    if (serials.isEmpty()) {
+        err << QObject::tr("Could not find device.") << "\n";
+        return EXIT_FAILURE;
+    }
+    QVector<Conversation> conversations(conversationCount);
+    QElapsedTimer clock;
+    qint64 elapsed;
+    {
+        MCP2210Pool pool(workers);
+        QSemaphore done;
+        clock.start();
+        for (int i = 0; i < conversationCount; ++i) {
+            conversations[i].errcnt = 0;
+            converse(&pool, vid, pid, serials.at(i % serials.size()), iterations, &clock, &conversations[i], &done);
+        }
+        done.acquire(conversationCount);
+        elapsed = clock.nsecsElapsed();
+    }
+    QVector<qint64> latencies;
+    int failedConversations = 0;
+    for (const Conversation &conversation : conversations) {
+        latencies += conversation.latencies;
+        if (conversation.errcnt > 0) {
+            ++failedConversations;
+            errstr += conversation.errstr;
+        }
+    }
+    out << QObject::tr("%1 conversations on %2 devices: %3").arg(conversationCount).arg(serials.size()).arg(summarizeLatencies(latencies, elapsed).toString()) << "\n";
+    int retval = EXIT_SUCCESS;
+    if (failedConversations > 0) {
+        err << QObject::tr("%1 conversations failed.").arg(failedConversations) << "\n" << errstr;
+        retval = EXIT_FAILURE;
+    }
+    return retval;
+}
@@ -0,0 +1,9 @@
+include(../benchmarks.pri)
+
+# Coroutines require C++20, which takes precedence over the C++11 default set by benchmarks.pri
+CONFIG += c++2a
+
+TARGET = mcp2210-coroping
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,152 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Lock stress tool, which interleaves GPIO read-modify-write sequences (high priority class) with chip settings writes (normal priority class) on the software emulator
+// Every chip settings write is verified by reading back the pin it changed, so that any write lost to a stale read-modify-write is counted
+// Usage example: mcp2210-lockstress --iterations 2000 --latency 200
+
+// Includes
+#include <cstdlib>
+#include <QAtomicInt>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QString>
+#include <QTextStream>
+#include <QThread>
+#include "mcp2210.h"
+#include "mcp2210emulator.h"
+
+// Thread that keeps toggling GPIO0 until told to stop
+class TogglerThread : public QThread
+{
+private:
+    MCP2210 *mcp2210_;
+    QAtomicInt stop_;
+
+public:
+    int errcnt;
+    QString errstr;
+    int toggles;
+
+    explicit TogglerThread(MCP2210 *mcp2210);
+
+    void stop();
+
+protected:
+    void run();
+};
+
+TogglerThread::TogglerThread(MCP2210 *mcp2210) :
+    mcp2210_(mcp2210),
+    stop_(0),
+    errcnt(0),
+    toggles(0)
+{
+}
+
+// Tells the thread to stop after the ongoing toggle
+void TogglerThread::stop()
+{
+    stop_.store(1);
+}
+
+// Toggles GPIO0, which takes a "GET_GPIO_VALUES" and a "SET_GPIO_VALUES" command each time
+void TogglerThread::run()
+{
+    while (stop_.load() == 0 && errcnt == 0) {
+        mcp2210_->toggleGPIO(MCP2210::GPIO0, errcnt, errstr);
+        ++toggles;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mcp2210-lockstress");
+    QCoreApplication::setApplicationVersion("1.0.0");
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("MCP2210 priority class interleaving stress tool."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption iterationsOption("iterations", QObject::tr("Number of chip settings writes (default 2000)."), "n", "2000");
+    QCommandLineOption latencyOption("latency", QObject::tr("Emulated round-trip latency for each command, in microseconds (default 200)."), "us", "200");
+    parser.addOption(iterationsOption);
+    parser.addOption(latencyOption);
+    parser.process(app);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    bool iterationsOk, latencyOk;
+    int iterations = parser.value(iterationsOption).toInt(&iterationsOk);
+    int latency = parser.value(latencyOption).toInt(&latencyOk);
+    if (!iterationsOk || iterations < 1 || !latencyOk || latency < 0) {
+        err << QObject::tr("Invalid arguments.") << "\n";
+        return EXIT_FAILURE;
+    }
+    MCP2210Emulator *emulator = new MCP2210Emulator;
+    MCP2210Emulator::TimingModel timingModel;
+    timingModel.enabled = latency > 0;
+    timingModel.usbLatency = static_cast<unsigned int>(latency);
+    timingModel.spiTiming = false;
+    emulator->setTimingModel(timingModel);
+    MCP2210 mcp2210(emulator);  // Takes ownership of the transport
+    mcp2210.setThreadSafe(true);
+    mcp2210.open(MCP2210::VID, MCP2210::PID);
+    int errcnt = 0;
+    QString errstr;
+    MCP2210::ChipSettings settings = mcp2210.getChipSettings(errcnt, errstr);
+    settings.gp0 = MCP2210::PCGPIO;
+    settings.gp1 = MCP2210::PCGPIO;
+    settings.gpdir = 0xfc;  // GPIO0 and GPIO1 are outputs
+    settings.gpout = 0x00;
+    mcp2210.configureChipSettings(settings, errcnt, errstr);
+    if (errcnt > 0) {
+        err << errstr;
+        return EXIT_FAILURE;
+    }
+    TogglerThread toggler(&mcp2210);
+    toggler.start();
+    int lostWrites = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations && errcnt == 0; ++i) {
+        bool value = i % 2 == 0;
+        settings.gpout = value ? 0x02 : 0x00;  // Only GPIO1 is of interest, since GPIO0 is owned by the toggler thread
+        mcp2210.configureChipSettings(settings, errcnt, errstr);
+        if (mcp2210.getGPIO(MCP2210::GPIO1, errcnt, errstr) != value) {  // GPIO1 is never changed by the toggler thread, unless it writes back a stale value
+            ++lostWrites;
+        }
+    }
+    toggler.stop();
+    toggler.wait();
+    qint64 elapsed = timer.elapsed();
+    out << QObject::tr("Chip settings writes: %1, GPIO toggles: %2, lost writes: %3, elapsed: %4 ms").arg(iterations).arg(toggler.toggles).arg(lostWrites).arg(elapsed) << "\n";
+    int retval = EXIT_SUCCESS;
+    if (errcnt > 0 || toggler.errcnt > 0) {
+        err << errstr << toggler.errstr;
+        retval = EXIT_FAILURE;
+    }
+    if (lostWrites > 0) {
+        err << QObject::tr("Chip settings writes were interleaved with GPIO read-modify-write sequences.") << "\n";
+        retval = EXIT_FAILURE;
+    }
+    return retval;
+}
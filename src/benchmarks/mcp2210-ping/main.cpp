@@ -0,0 +1,358 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Round-trip latency benchmark ("ping mode"), which repeatedly issues a lightweight HID command to an MCP2210 and reports latency percentiles and command rate
+// Usage example: mcp2210-ping --serial 0000123456 --command chipstatus --iterations 10000 --in-flight 4 --json
+
+// Includes
+#include <sys/time.h>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQueue>
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+#include <libusb-1.0/libusb.h>
+#include "benchmarkcommon.h"
+#include "libusbtransport.h"
+#include "mcp2210.h"
+
+// Definitions
+const unsigned int ASYNC_TIMEOUT = 500;  // Timeout for each asynchronous transfer, in milliseconds
+const int WARMUP_DEFAULT = 10;           // Default number of warm-up commands, which are not measured
+
+// Parameters of a benchmark run, where "iterations" is ignored if "duration" is greater than zero
+struct RunParameters {
+    quint8 command;
+    int iterations;
+    qint64 duration;  // In nanoseconds
+    int warmup;
+};
+
+// Result of a benchmark run
+struct RunResult {
+    QVector<qint64> latencies;  // In nanoseconds
+    qint64 elapsed;             // In nanoseconds
+    int errors;
+    QString errstr;
+};
+
+// State shared by the asynchronous transfer callbacks
+struct AsyncState {
+    QElapsedTimer clock;
+    RunParameters parameters;
+    int inFlight;
+    int outSubmitted, inSubmitted, completed, active;
+    bool stopping;
+    QQueue<qint64> submitTimes;          // Submission times of the OUT transfers still awaiting a response, in order
+    QQueue<libusb_transfer *> freeOuts;  // OUT transfers available for reuse
+    RunResult *result;
+};
+
+// Issues the given command via the MCP2210 class, so that the host-side overhead is included in the measurement
+static void issueCommand(MCP2210 &mcp2210, quint8 command, int &errcnt, QString &errstr)
+{
+    if (command == MCP2210::GET_GPIO_VALUES) {
+        mcp2210.getGPIOs(errcnt, errstr);
+    } else {
+        mcp2210.getChipStatus(errcnt, errstr);
+    }
+}
+
+// Checks if another command should be issued
+static bool shouldContinue(const RunParameters &parameters, int issued, qint64 elapsed)
+{
+    return parameters.duration > 0 ? elapsed < parameters.duration : issued < parameters.iterations;
+}
+
+// Synchronous run, having one command in flight at a time
+static RunResult runSync(MCP2210 &mcp2210, const RunParameters &parameters)
+{
+    RunResult result;
+    result.errors = 0;
+    for (int i = 0; i < parameters.warmup; ++i) {
+        int errcnt = 0;
+        QString errstr;
+        issueCommand(mcp2210, parameters.command, errcnt, errstr);
+    }
+    if (parameters.duration <= 0) {
+        result.latencies.reserve(parameters.iterations);
+    }
+    QElapsedTimer clock;
+    clock.start();
+    int issued = 0;
+    while (shouldContinue(parameters, issued, clock.nsecsElapsed())) {
+        int errcnt = 0;
+        qint64 start = clock.nsecsElapsed();
+        issueCommand(mcp2210, parameters.command, errcnt, result.errstr);
+        qint64 end = clock.nsecsElapsed();
+        ++issued;
+        if (errcnt > 0) {
+            ++result.errors;
+            if (mcp2210.disconnected()) {
+                break;
+            }
+        } else {
+            result.latencies += end - start;
+        }
+    }
+    result.elapsed = clock.nsecsElapsed();
+    return result;
+}
+
+static void submitOut(AsyncState *state);
+
+// Callback for the asynchronous OUT transfers
+static void LIBUSB_CALL outCallback(libusb_transfer *transfer)
+{
+    AsyncState *state = static_cast<AsyncState *>(transfer->user_data);
+    --state->active;
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
+        if (!state->stopping) {
+            ++state->result->errors;
+            state->result->errstr += QObject::tr("Failed asynchronous OUT transfer (status %1).\n").arg(transfer->status);
+            state->stopping = true;
+        }
+    } else {
+        state->freeOuts.enqueue(transfer);
+        submitOut(state);
+    }
+}
+
+// Callback for the asynchronous IN transfers
+static void LIBUSB_CALL inCallback(libusb_transfer *transfer)
+{
+    AsyncState *state = static_cast<AsyncState *>(transfer->user_data);
+    --state->active;
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED || transfer->actual_length != static_cast<int>(MCP2210::COMMAND_SIZE) || transfer->buffer[0] != state->parameters.command) {
+        if (!state->stopping) {
+            ++state->result->errors;
+            state->result->errstr += QObject::tr("Failed asynchronous IN transfer or invalid response (status %1).\n").arg(transfer->status);
+            state->stopping = true;
+        }
+    } else {
+        qint64 now = state->clock.nsecsElapsed();
+        qint64 submitted = state->submitTimes.dequeue();  // Responses arrive in the same order as commands
+        ++state->completed;
+        if (state->completed > state->parameters.warmup) {
+            state->result->latencies += now - submitted;
+        }
+        if (!state->stopping && state->inSubmitted < state->outSubmitted + state->inFlight && shouldContinue(state->parameters, state->inSubmitted - state->parameters.warmup, now)) {
+            if (libusb_submit_transfer(transfer) == 0) {
+                ++state->inSubmitted;
+                ++state->active;
+            }
+        }
+        submitOut(state);
+    }
+}
+
+// Submits as many OUT transfers as allowed by the number of commands in flight
+static void submitOut(AsyncState *state)
+{
+    while (!state->stopping && !state->freeOuts.isEmpty() && state->outSubmitted - state->completed < state->inFlight &&
+           state->outSubmitted < state->inSubmitted && shouldContinue(state->parameters, state->outSubmitted - state->parameters.warmup, state->clock.nsecsElapsed())) {
+        libusb_transfer *transfer = state->freeOuts.dequeue();
+        state->submitTimes.enqueue(state->clock.nsecsElapsed());
+        if (libusb_submit_transfer(transfer) != 0) {
+            state->submitTimes.removeLast();
+            state->freeOuts.enqueue(transfer);
+            break;
+        }
+        ++state->outSubmitted;
+        ++state->active;
+    }
+}
+
+// Asynchronous run, having up to "inFlight" commands in flight, which requires the libusb transport
+static RunResult runAsync(LibusbTransport &transport, const RunParameters &parameters, int inFlight)
+{
+    RunResult result;
+    result.errors = 0;
+    AsyncState state;
+    state.parameters = parameters;
+    state.inFlight = inFlight;
+    state.outSubmitted = state.inSubmitted = state.completed = state.active = 0;
+    state.stopping = false;
+    state.result = &result;
+    QVector<libusb_transfer *> transfers;
+    QVector<QVector<unsigned char>> buffers(2 * inFlight, QVector<unsigned char>(static_cast<int>(MCP2210::COMMAND_SIZE), 0x00));
+    for (int i = 0; i < 2 * inFlight; ++i) {
+        libusb_transfer *transfer = libusb_alloc_transfer(0);
+        bool out = i < inFlight;
+        if (out) {
+            buffers[i][0] = parameters.command;
+        }
+        libusb_fill_interrupt_transfer(transfer, transport.handle(), out ? 0x01 : 0x81, buffers[i].data(), static_cast<int>(MCP2210::COMMAND_SIZE), out ? outCallback : inCallback, &state, ASYNC_TIMEOUT);
+        transfers += transfer;
+    }
+    state.clock.start();
+    for (int i = inFlight; i < 2 * inFlight; ++i) {  // IN transfers are submitted first, so that they are ready to receive any response
+        if (libusb_submit_transfer(transfers[i]) == 0) {
+            ++state.inSubmitted;
+            ++state.active;
+        }
+    }
+    for (int i = 0; i < inFlight; ++i) {
+        state.freeOuts.enqueue(transfers[i]);
+    }
+    submitOut(&state);
+    qint64 measureStart = -1;
+    while (state.active > 0) {
+        if (measureStart < 0 && state.completed >= parameters.warmup) {
+            measureStart = state.clock.nsecsElapsed();
+        }
+        if (!state.stopping && state.outSubmitted == state.completed && state.outSubmitted - parameters.warmup > 0 &&
+            !shouldContinue(parameters, state.outSubmitted - parameters.warmup, state.clock.nsecsElapsed())) {  // All commands answered, so the remaining IN transfers are no longer needed
+            state.stopping = true;
+        }
+        if (state.stopping) {
+            for (libusb_transfer *transfer : transfers) {
+                libusb_cancel_transfer(transfer);  // Harmless for transfers that are not pending
+            }
+        }
+        timeval tv = {1, 0};
+        libusb_handle_events_timeout_completed(transport.context(), &tv, nullptr);
+    }
+    result.elapsed = state.clock.nsecsElapsed() - (measureStart < 0 ? 0 : measureStart);
+    for (libusb_transfer *transfer : transfers) {
+        libusb_free_transfer(transfer);
+    }
+    return result;
+}
+
+// Returns the run result as a JSON object
+static QJsonObject resultToJson(const QString &mode, int inFlight, const RunResult &result)
+{
+    QJsonObject object = summarizeLatencies(result.latencies, result.elapsed).toJson();
+    object["mode"] = mode;
+    object["in_flight"] = inFlight;
+    object["errors"] = result.errors;
+    return object;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mcp2210-ping");
+    QCoreApplication::setApplicationVersion("1.0.0");
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("MCP2210 round-trip latency benchmark."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption vidOption("vid", QObject::tr("Vendor ID, in hexadecimal (default 04d8)."), "vid", "04d8");
+    QCommandLineOption pidOption("pid", QObject::tr("Product ID, in hexadecimal (default 00de)."), "pid", "00de");
+    QCommandLineOption serialOption("serial", QObject::tr("Serial number of the device to be used."), "serial");
+    QCommandLineOption commandOption("command", QObject::tr("Command to be issued: \"chipstatus\" (default) or \"gpio\"."), "command", "chipstatus");
+    QCommandLineOption iterationsOption("iterations", QObject::tr("Number of commands to be issued (default 1000)."), "n", "1000");
+    QCommandLineOption durationOption("duration", QObject::tr("Run for the given time in seconds, instead of a number of iterations."), "seconds");
+    QCommandLineOption inFlightOption("in-flight", QObject::tr("Also run with up to the given number of commands in flight, via the libusb asynchronous API (default 1, meaning synchronous only)."), "k", "1");
+    QCommandLineOption warmupOption("warmup", QObject::tr("Number of warm-up commands, which are not measured (default 10)."), "n", QString::number(WARMUP_DEFAULT));
+    QCommandLineOption jsonOption("json", QObject::tr("Print results in JSON format."));
+    parser.addOption(vidOption);
+    parser.addOption(pidOption);
+    parser.addOption(serialOption);
+    parser.addOption(commandOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(durationOption);
+    parser.addOption(inFlightOption);
+    parser.addOption(warmupOption);
+    parser.addOption(jsonOption);
+    parser.process(app);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    bool vidOk, pidOk, iterationsOk, inFlightOk, warmupOk;
+    quint16 vid = parseHexID(parser.value(vidOption), vidOk);
+    quint16 pid = parseHexID(parser.value(pidOption), pidOk);
+    RunParameters parameters;
+    parameters.iterations = parser.value(iterationsOption).toInt(&iterationsOk);
+    parameters.duration = static_cast<qint64>(1e9 * parser.value(durationOption).toDouble());
+    parameters.warmup = parser.value(warmupOption).toInt(&warmupOk);
+    int inFlight = parser.value(inFlightOption).toInt(&inFlightOk);
+    QString commandName = parser.value(commandOption);
+    if (commandName == "gpio") {
+        parameters.command = MCP2210::GET_GPIO_VALUES;
+    } else if (commandName == "chipstatus") {
+        parameters.command = MCP2210::GET_CHIP_STATUS;
+    } else {
+        parameters.command = 0x00;
+    }
+    if (!vidOk || !pidOk || !iterationsOk || parameters.iterations < 1 || !inFlightOk || inFlight < 1 || !warmupOk || parameters.warmup < 0 || parameters.command == 0x00) {
+        err << QObject::tr("Invalid arguments.") << "\n";
+        return EXIT_FAILURE;
+    }
+    QString serial = parser.isSet(serialOption) ? parser.value(serialOption) : QString();
+    QJsonArray runs;
+    int retval = EXIT_SUCCESS;
+    {
+        MCP2210 mcp2210;
+        QString errstr;
+        if (!openDevice(mcp2210, vid, pid, serial, errstr)) {
+            err << errstr;
+            return EXIT_FAILURE;
+        }
+        RunResult result = runSync(mcp2210, parameters);
+        runs.append(resultToJson("sync", 1, result));
+        if (!parser.isSet(jsonOption)) {
+            out << QObject::tr("Synchronous: %1").arg(summarizeLatencies(result.latencies, result.elapsed).toString()) << "\n";
+        }
+        if (result.errors > 0) {
+            err << QObject::tr("%1 commands failed.").arg(result.errors) << "\n" << result.errstr;
+            retval = EXIT_FAILURE;
+        }
+    }  // The device is closed here, so that it can be reopened below
+    if (inFlight > 1) {
+        LibusbTransport transport;  // The asynchronous mode always uses libusb directly
+        int errOpen = transport.open(vid, pid, serial);
+        if (errOpen != MCP2210::SUCCESS) {
+            err << QObject::tr("Could not open device for asynchronous transfers.") << "\n";
+            retval = EXIT_FAILURE;
+        } else {
+            RunResult result = runAsync(transport, parameters, inFlight);
+            runs.append(resultToJson("async", inFlight, result));
+            if (!parser.isSet(jsonOption)) {
+                out << QObject::tr("Asynchronous (%1 in flight): %2").arg(inFlight).arg(summarizeLatencies(result.latencies, result.elapsed).toString()) << "\n";
+            }
+            if (result.errors > 0) {
+                err << QObject::tr("%1 asynchronous transfers failed.").arg(result.errors) << "\n" << result.errstr;
+                retval = EXIT_FAILURE;
+            }
+        }
+    }
+    if (parser.isSet(jsonOption)) {
+        QJsonObject report;
+        report["tool"] = QString("mcp2210-ping");
+        report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        report["vid"] = QString("%1").arg(vid, 4, 16, QChar('0'));
+        report["pid"] = QString("%1").arg(pid, 4, 16, QChar('0'));
+        report["serial"] = serial;
+        report["command"] = QString("0x%1").arg(parameters.command, 2, 16, QChar('0'));
+        report["transport"] = QString(qgetenv("MCP2210_TRANSPORT"));
+        report["runs"] = runs;
+        out << QJsonDocument(report).toJson();
+    }
+    return retval;
+}
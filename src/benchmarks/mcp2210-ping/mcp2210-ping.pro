@@ -0,0 +1,6 @@
+include(../benchmarks.pri)
+
+TARGET = mcp2210-ping
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,332 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// SPI throughput benchmark, which sweeps the SPI settings (bit rate, number of bytes per transaction and delays) and measures the effective throughput
+// Usage example: mcp2210-spisweep --serial 0000123456 --cs 0 --bitrates 1000000,3000000,12000000 --nbytes 1,60,1024,65535 --delays 0:0:0,1:1:0 --format csv
+
+// Includes
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include "benchmarkcommon.h"
+#include "mcp2210.h"
+#include "mcp2210limits.h"
+
+// Definitions
+const quint32 SUPPORTED_BITRATES[] = {  // Bit rates swept when "--bitrates all" is specified
+    MCP2210::BRT1K464, MCP2210::BRT1K5, MCP2210::BRT1K875, MCP2210::BRT2K5, MCP2210::BRT3K, MCP2210::BRT3K125, MCP2210::BRT3K75, MCP2210::BRT5K,
+    MCP2210::BRT6K, MCP2210::BRT6K25, MCP2210::BRT7K5, MCP2210::BRT9K375, MCP2210::BRT10K, MCP2210::BRT12K, MCP2210::BRT12K5, MCP2210::BRT15K,
+    MCP2210::BRT15K625, MCP2210::BRT18K75, MCP2210::BRT20K, MCP2210::BRT24K, MCP2210::BRT25K, MCP2210::BRT30K, MCP2210::BRT31K25, MCP2210::BRT37K5,
+    MCP2210::BRT40K, MCP2210::BRT46K875, MCP2210::BRT48K, MCP2210::BRT50K, MCP2210::BRT60K, MCP2210::BRT62K5, MCP2210::BRT75K, MCP2210::BRT80K,
+    MCP2210::BRT93K75, MCP2210::BRT100K, MCP2210::BRT120K, MCP2210::BRT125K, MCP2210::BRT150K, MCP2210::BRT187K5, MCP2210::BRT200K, MCP2210::BRT240K,
+    MCP2210::BRT250K, MCP2210::BRT300K, MCP2210::BRT375K, MCP2210::BRT400K, MCP2210::BRT500K, MCP2210::BRT600K, MCP2210::BRT750K, MCP2210::BRT1M,
+    MCP2210::BRT1M2, MCP2210::BRT1M5, MCP2210::BRT2M, MCP2210::BRT3M, MCP2210::BRT12M
+};
+const int MAX_RETRIES = 1000;  // Maximum number of consecutive "IN_PROGRESS" responses tolerated while transferring a chunk
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+const Qt::SplitBehavior SKIP_EMPTY_PARTS = Qt::SkipEmptyParts;  // QString::SkipEmptyParts is deprecated since Qt 5.14
+#else
+const QString::SplitBehavior SKIP_EMPTY_PARTS = QString::SkipEmptyParts;
+#endif
+
+// A single point of the sweep, along with its results
+struct SweepPoint {
+    quint32 bitrate;        // Requested bit rate
+    quint32 actualBitrate;  // Bit rate effectively used by the device
+    quint16 nbytes;         // Bytes per transaction (in the "stream" mode) or total bytes per repetition (in the "per-call" mode)
+    quint16 csdtdly, dtcsdly, itbytdly;
+    QString mode;
+    quint64 bytes;          // Total bytes transferred
+    int calls;              // Total number of spiTransfer() calls
+    qint64 elapsed;         // In nanoseconds
+    int errors;
+};
+
+// Transfers a complete SPI transaction of the given size, which must match the configured number of bytes per transaction
+// Chunks of up to 60 bytes are sent back to back, and the loop carries on until the transfer engine reports that the transaction has finished
+static bool transferTransaction(MCP2210 &mcp2210, int nbytes, int &calls, int &errcnt, QString &errstr)
+{
+    QVector<quint8> chunk(static_cast<int>(MCP2210::SPIDATA_MAXSIZE), 0xa5);
+    int sent = 0, retries = 0;
+    bool finished = false;
+    while (!finished && errcnt == 0) {
+        int bytesToSend = nbytes - sent < static_cast<int>(MCP2210::SPIDATA_MAXSIZE) ? nbytes - sent : static_cast<int>(MCP2210::SPIDATA_MAXSIZE);
+        chunk.resize(bytesToSend);
+        quint8 status;
+        mcp2210.spiTransfer(chunk, status, errcnt, errstr);
+        ++calls;
+        if (errcnt > 0) {
+            break;
+        } else if (status == MCP2210::IN_PROGRESS) {  // The chunk was not accepted, so it must be resent
+            if (++retries > MAX_RETRIES) {
+                ++errcnt;
+                errstr += QObject::tr("SPI transfer engine did not accept data.\n");
+            }
+        } else if (status == MCP2210::BUSY) {
+            ++errcnt;
+            errstr += QObject::tr("SPI bus is not available.\n");
+        } else {
+            retries = 0;
+            sent += bytesToSend;
+            finished = status == MCP2210::TRANSFER_FINISHED;
+        }
+    }
+    return errcnt == 0;
+}
+
+// Measures a single point of the sweep
+// In the "per-call" mode, each transaction is limited to one chunk (60 bytes at most), so that "nbytes" bytes are transferred via several short transactions
+// In the "stream" mode, "nbytes" bytes are transferred in one transaction, via a back-to-back multi-chunk loop
+static void measurePoint(MCP2210 &mcp2210, const MCP2210::SPISettings &baseSettings, SweepPoint &point, int repeat)
+{
+    int errcnt = 0;
+    QString errstr;
+    bool perCall = point.mode == "per-call";
+    int transactionSize = perCall && point.nbytes > MCP2210::SPIDATA_MAXSIZE ? static_cast<int>(MCP2210::SPIDATA_MAXSIZE) : point.nbytes;
+    MCP2210::SPISettings settings = baseSettings;
+    settings.bitrate = point.bitrate;
+    settings.nbytes = static_cast<quint16>(transactionSize);
+    settings.csdtdly = point.csdtdly;
+    settings.dtcsdly = point.dtcsdly;
+    settings.itbytdly = point.itbytdly;
+    mcp2210.configureSPISettings(settings, errcnt, errstr);
+    point.actualBitrate = mcp2210.getSPISettings(errcnt, errstr).bitrate;  // The device may adjust the requested bit rate
+    point.bytes = 0;
+    point.calls = 0;
+    point.errors = 0;
+    QElapsedTimer clock;
+    clock.start();
+    for (int i = 0; i < repeat && errcnt == 0; ++i) {
+        for (int remaining = point.nbytes; remaining > 0 && errcnt == 0; remaining -= transactionSize) {
+            if (transferTransaction(mcp2210, transactionSize, point.calls, errcnt, errstr)) {
+                point.bytes += static_cast<quint64>(transactionSize);
+            }
+        }
+    }
+    point.elapsed = clock.nsecsElapsed();
+    if (errcnt > 0) {
+        point.errors = errcnt;
+        QTextStream(stderr) << QObject::tr("Error at %1 bit/s, %2 bytes (%3): %4").arg(point.bitrate).arg(point.nbytes).arg(point.mode).arg(errstr);
+        int errcntCancel = 0;
+        mcp2210.cancelSPITransfer(errcntCancel, errstr);  // Leave the transfer engine in a clean state for the next point
+    }
+}
+
+// Returns the theoretical throughput in bytes per second for the given point, taking into account the wire time and the configured delays (100us units)
+static double theoreticalRate(const SweepPoint &point, bool includeDelays)
+{
+    int transactionSize = point.mode == "per-call" && point.nbytes > MCP2210::SPIDATA_MAXSIZE ? static_cast<int>(MCP2210::SPIDATA_MAXSIZE) : point.nbytes;
+    double time = 8.0 * transactionSize / point.actualBitrate;
+    if (includeDelays) {
+        time += 100e-6 * (point.csdtdly + point.dtcsdly + static_cast<double>(point.itbytdly) * (transactionSize - 1));
+    }
+    return time > 0 ? transactionSize / time : 0;
+}
+
+// Parses a comma separated list of unsigned integers
+static QVector<quint32> parseList(const QString &text, bool &ok)
+{
+    QVector<quint32> values;
+    ok = true;
+    QStringList items = text.split(',', SKIP_EMPTY_PARTS);
+    for (const QString &item : items) {
+        bool itemOk;
+        values += item.trimmed().toUInt(&itemOk);
+        ok = ok && itemOk;
+    }
+    ok = ok && !values.isEmpty();
+    return values;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mcp2210-spisweep");
+    QCoreApplication::setApplicationVersion("1.0.0");
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("MCP2210 SPI throughput benchmark."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption vidOption("vid", QObject::tr("Vendor ID, in hexadecimal (default 04d8)."), "vid", "04d8");
+    QCommandLineOption pidOption("pid", QObject::tr("Product ID, in hexadecimal (default 00de)."), "pid", "00de");
+    QCommandLineOption serialOption("serial", QObject::tr("Serial number of the device to be used."), "serial");
+    QCommandLineOption csOption("cs", QObject::tr("Chip select pin to be asserted during transfers (default 0). The pin must be configured as chip select."), "pin", "0");
+    QCommandLineOption spiModeOption("mode", QObject::tr("SPI mode (default 0)."), "mode", "0");
+    QCommandLineOption bitratesOption("bitrates", QObject::tr("Comma separated list of bit rates, or \"all\" for all supported bit rates (default 1000000,3000000,12000000)."), "list", "1000000,3000000,12000000");
+    QCommandLineOption nbytesOption("nbytes", QObject::tr("Comma separated list of transaction sizes, from 1 to 65535 (default 1,4,16,60,256,1024,4096,65535)."), "list", "1,4,16,60,256,1024,4096,65535");
+    QCommandLineOption delaysOption("delays", QObject::tr("Comma separated list of delay triplets csdtdly:dtcsdly:itbytdly, in 100us units (default 0:0:0)."), "list", "0:0:0");
+    QCommandLineOption repeatOption("repeat", QObject::tr("Number of repetitions per point (default 3)."), "n", "3");
+    QCommandLineOption formatOption("format", QObject::tr("Output format: \"csv\" (default) or \"json\"."), "format", "csv");
+    parser.addOption(vidOption);
+    parser.addOption(pidOption);
+    parser.addOption(serialOption);
+    parser.addOption(csOption);
+    parser.addOption(spiModeOption);
+    parser.addOption(bitratesOption);
+    parser.addOption(nbytesOption);
+    parser.addOption(delaysOption);
+    parser.addOption(repeatOption);
+    parser.addOption(formatOption);
+    parser.process(app);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    bool vidOk, pidOk, csOk, spiModeOk, bitratesOk = true, nbytesOk, repeatOk, delaysOk = true;
+    quint16 vid = parseHexID(parser.value(vidOption), vidOk);
+    quint16 pid = parseHexID(parser.value(pidOption), pidOk);
+    int cs = parser.value(csOption).toInt(&csOk);
+    int spiMode = parser.value(spiModeOption).toInt(&spiModeOk);
+    int repeat = parser.value(repeatOption).toInt(&repeatOk);
+    QVector<quint32> bitrates;
+    if (parser.value(bitratesOption) == "all") {
+        for (quint32 bitrate : SUPPORTED_BITRATES) {
+            bitrates += bitrate;
+        }
+    } else {
+        bitrates = parseList(parser.value(bitratesOption), bitratesOk);
+        for (quint32 bitrate : bitrates) {
+            bitratesOk = bitratesOk && bitrate >= MCP2210Limits::BITRATE_MIN && bitrate <= MCP2210Limits::BITRATE_MAX;
+        }
+    }
+    QVector<quint32> nbytesList = parseList(parser.value(nbytesOption), nbytesOk);
+    for (quint32 nbytes : nbytesList) {
+        nbytesOk = nbytesOk && nbytes >= 1 && nbytes <= MCP2210Limits::NBYTES_MAX;
+    }
+    QVector<QVector<quint32>> delays;
+    QStringList triplets = parser.value(delaysOption).split(',', SKIP_EMPTY_PARTS);
+    for (const QString &triplet : triplets) {
+        QStringList fields = triplet.split(':');
+        QVector<quint32> delay;
+        for (const QString &field : fields) {
+            bool fieldOk;
+            quint32 value = field.toUInt(&fieldOk);
+            delaysOk = delaysOk && fieldOk && value <= MCP2210Limits::CSDTDLY_MAX;  // All three delays share the same limit
+            delay += value;
+        }
+        delaysOk = delaysOk && delay.size() == 3;
+        delays += delay;
+    }
+    QString format = parser.value(formatOption);
+    if (!vidOk || !pidOk || !csOk || cs < MCP2210::GPIO0 || cs > MCP2210::GPIO7 || !spiModeOk || spiMode < MCP2210::SPIMODE0 || spiMode > MCP2210::SPIMODE3 ||
+        !bitratesOk || !nbytesOk || !delaysOk || delays.isEmpty() || !repeatOk || repeat < 1 || (format != "csv" && format != "json")) {
+        err << QObject::tr("Invalid arguments.") << "\n";
+        return EXIT_FAILURE;
+    }
+    MCP2210 mcp2210;
+    QString errstr;
+    QString serial = parser.isSet(serialOption) ? parser.value(serialOption) : QString();
+    if (!openDevice(mcp2210, vid, pid, serial, errstr)) {
+        err << errstr;
+        return EXIT_FAILURE;
+    }
+    int errcnt = 0;
+    MCP2210::SPISettings initialSettings = mcp2210.getSPISettings(errcnt, errstr);  // The volatile SPI settings are restored at the end
+    if (errcnt > 0) {
+        err << errstr;
+        return EXIT_FAILURE;
+    }
+    MCP2210::SPISettings baseSettings = initialSettings;
+    baseSettings.mode = static_cast<quint8>(spiMode);
+    baseSettings.idlcs = 0xff;  // All chip selects idle high
+    baseSettings.actcs = static_cast<quint8>(~(0x01 << cs));  // Only the given chip select is asserted (low)
+    QVector<SweepPoint> points;
+    int totalErrors = 0;
+    for (quint32 bitrate : bitrates) {
+        for (quint32 nbytes : nbytesList) {
+            for (const QVector<quint32> &delay : delays) {
+                QStringList modes{"stream"};
+                if (nbytes > MCP2210::SPIDATA_MAXSIZE) {
+                    modes += "per-call";  // Both modes are equivalent otherwise
+                }
+                for (const QString &mode : modes) {
+                    SweepPoint point;
+                    point.bitrate = bitrate;
+                    point.nbytes = static_cast<quint16>(nbytes);
+                    point.csdtdly = static_cast<quint16>(delay[0]);
+                    point.dtcsdly = static_cast<quint16>(delay[1]);
+                    point.itbytdly = static_cast<quint16>(delay[2]);
+                    point.mode = mode;
+                    measurePoint(mcp2210, baseSettings, point, repeat);
+                    totalErrors += point.errors;
+                    points += point;
+                    if (mcp2210.disconnected()) {
+                        err << QObject::tr("Device disconnected.") << "\n";
+                        return EXIT_FAILURE;
+                    }
+                }
+            }
+        }
+    }
+    errcnt = 0;
+    mcp2210.configureSPISettings(initialSettings, errcnt, errstr);
+    if (format == "csv") {
+        out << "bitrate,actual_bitrate,nbytes,csdtdly,dtcsdly,itbytdly,mode,bytes,calls,elapsed_s,bytes_per_s,wire_bytes_per_s,theoretical_bytes_per_s,efficiency,errors" << "\n";
+        for (const SweepPoint &point : points) {
+            double elapsed = point.elapsed / 1e9;
+            double rate = elapsed > 0 ? point.bytes / elapsed : 0;
+            double theoretical = theoreticalRate(point, true);
+            out << point.bitrate << ',' << point.actualBitrate << ',' << point.nbytes << ',' << point.csdtdly << ',' << point.dtcsdly << ',' << point.itbytdly << ','
+                << point.mode << ',' << point.bytes << ',' << point.calls << ',' << QString::number(elapsed, 'f', 6) << ',' << QString::number(rate, 'f', 1) << ','
+                << QString::number(theoreticalRate(point, false), 'f', 1) << ',' << QString::number(theoretical, 'f', 1) << ','
+                << QString::number(theoretical > 0 ? rate / theoretical : 0, 'f', 4) << ',' << point.errors << "\n";
+        }
+    } else {
+        QJsonArray matrix;
+        for (const SweepPoint &point : points) {
+            double elapsed = point.elapsed / 1e9;
+            double rate = elapsed > 0 ? point.bytes / elapsed : 0;
+            double theoretical = theoreticalRate(point, true);
+            QJsonObject object;
+            object["bitrate"] = static_cast<qint64>(point.bitrate);
+            object["actual_bitrate"] = static_cast<qint64>(point.actualBitrate);
+            object["nbytes"] = point.nbytes;
+            object["csdtdly"] = point.csdtdly;
+            object["dtcsdly"] = point.dtcsdly;
+            object["itbytdly"] = point.itbytdly;
+            object["mode"] = point.mode;
+            object["bytes"] = static_cast<qint64>(point.bytes);
+            object["calls"] = point.calls;
+            object["elapsed_s"] = elapsed;
+            object["bytes_per_s"] = rate;
+            object["wire_bytes_per_s"] = theoreticalRate(point, false);
+            object["theoretical_bytes_per_s"] = theoretical;
+            object["efficiency"] = theoretical > 0 ? rate / theoretical : 0;
+            object["errors"] = point.errors;
+            matrix.append(object);
+        }
+        QJsonObject report;
+        report["tool"] = QString("mcp2210-spisweep");
+        report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        report["serial"] = serial;
+        report["spi_mode"] = spiMode;
+        report["repeat"] = repeat;
+        report["points"] = matrix;
+        out << QJsonDocument(report).toJson();
+    }
+    return totalErrors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
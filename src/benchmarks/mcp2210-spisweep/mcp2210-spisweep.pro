@@ -0,0 +1,6 @@
+include(../benchmarks.pri)
+
+TARGET = mcp2210-spisweep
+
+SOURCES += \
+    main.cpp
@@ -29,7 +29,9 @@
 #include "common.h"
 #include "configurationreader.h"
 #include "configurationwriter.h"
+#include "mcp2210devicelock.h"
 #include "mcp2210limits.h"
+#include "mcp2210tracer.h"
 #include "passworddialog.h"
 #include "configuratorwindow.h"
 #include "ui_configuratorwindow.h"
@@ -62,9 +64,10 @@ bool ConfiguratorWindow::isViewEnabled()
 }
 
 // Opens the device and prepares the corresponding window
-void ConfiguratorWindow::openDevice(quint16 vid, quint16 pid, const QString &serialString)
+// If the device is in use by another tool, it waits up to the given timeout, in milliseconds, for the device to be released
+void ConfiguratorWindow::openDevice(quint16 vid, quint16 pid, const QString &serialString, int timeout)
 {
-    int err = mcp2210_.open(vid, pid, serialString);
+    int err = mcp2210_.open(vid, pid, serialString, timeout);  // Tools that hand the device over to each other are waited for
     if (err == MCP2210::SUCCESS) {  // Device was successfully opened
         err_ = false;
         readDeviceConfiguration();
@@ -83,8 +86,15 @@ void ConfiguratorWindow::openDevice(quint16 vid, quint16 pid, const QString &ser
     } else {
         if (err == MCP2210::ERROR_NOT_FOUND) {  // Failed to find device
             QMessageBox::critical(this, tr("Error"), tr("Could not find device."));
+        } else if (err == MCP2210::ERROR_ACCESS) {  // Insufficient permissions to access the device
+            QMessageBox::critical(this, tr("Error"), tr("Access to the device was denied.\n\nPlease confirm that you have read and write permissions to the device."));
         } else if (err == MCP2210::ERROR_BUSY) {  // Failed to claim interface
-            QMessageBox::critical(this, tr("Error"), tr("Device is currently unavailable.\n\nPlease confirm that the device is not in use."));
+            MCP2210DeviceLock::Holder holder = MCP2210DeviceLock(vid, pid, serialString).holder();
+            if (holder.isValid()) {
+                QMessageBox::critical(this, tr("Error"), tr("Device is currently in use by %1.").arg(holder.toString()));
+            } else {
+                QMessageBox::critical(this, tr("Error"), tr("Device is currently unavailable.\n\nPlease confirm that the device is not in use."));
+            }
         }
         this->deleteLater();  // Close window after the subsequent show() call
     }
@@ -562,11 +572,15 @@ void ConfiguratorWindow::writeUSBParameters()
 // This is the main configuration routine, used to configure the MCP2210 NVRAM according to the tasks in the task list
 void ConfiguratorWindow::configureDevice()
 {
+    MCP2210TraceSpan span("configureDevice", "config");
     err_ = false;
     QStringList tasks = prepareTaskList();  // Create a new task list
     int nTasks = tasks.size();
     for (int i = 0; i < nTasks; ++i) {  // Iterate through the newly created task list
-        QMetaObject::invokeMethod(this, tasks[i].toStdString().c_str());  // The task list entry is converted to a C string
+        std::string task = tasks[i].toStdString();
+        qint64 taskStart = MCP2210Tracer::now();
+        QMetaObject::invokeMethod(this, task.c_str());  // The task list entry is converted to a C string
+        MCP2210Tracer::record(task.c_str(), "task", taskStart);
         if (err_) {  // If an error has occured
             handleError();
             QMessageBox::critical(this, tr("Error"), tr("The device configuration could not be completed."));
@@ -872,6 +886,7 @@ QStringList ConfiguratorWindow::prepareTaskList()
 // This is the routine that reads the configuration from the MCP2210 NVRAM
 void ConfiguratorWindow::readDeviceConfiguration()
 {
+    MCP2210TraceSpan span("readDeviceConfiguration", "config");
     int errcnt = 0;
     QString errstr;
     deviceConfiguration_.manufacturer = mcp2210_.getManufacturerDesc(errcnt, errstr);
@@ -889,6 +904,7 @@ void ConfiguratorWindow::readDeviceConfiguration()
 // Reads the contents from the MCP2210 EEPROM
 MCP2210EEPROM ConfiguratorWindow::readEEPROM()
 {
+    MCP2210TraceSpan span("readEEPROM", "eeprom");
     MCP2210EEPROM eeprom;
     this->setCursor(Qt::WaitCursor);  // This task takes quite a few tenths of a second, so it is a good idea to change the cursor to reflect that
     for (size_t i = 0; i < MCP2210::EEPROM_SIZE; ++i) {
@@ -1064,6 +1080,7 @@ bool ConfiguratorWindow::validatePassword()
 // Overwrites the contents of the MCP2210 EEPROM
 void ConfiguratorWindow::writeEEPROM(MCP2210EEPROM eeprom)
 {
+    MCP2210TraceSpan span("writeEEPROM", "eeprom");
     this->setCursor(Qt::WaitCursor);  // This task takes several tenths of a second, so it is a good idea to change the cursor to reflect that
     for (size_t i = 0; i < MCP2210::EEPROM_SIZE; ++i) {
         int errcnt = 0;
@@ -46,7 +46,7 @@ public:
     ~ConfiguratorWindow();
 
     bool isViewEnabled();
-    void openDevice(quint16 vid, quint16 pid, const QString &serialString);
+    void openDevice(quint16 vid, quint16 pid, const QString &serialString, int timeout);
 
 protected:
     void resizeEvent(QResizeEvent *event);
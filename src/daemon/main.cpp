@@ -0,0 +1,72 @@
+/* MCP2210 daemon for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// MCP2210 daemon, which owns MCP2210 devices and shares them among several client processes, via a local socket
+// Clients access the daemon by setting the environment variable "MCP2210_TRANSPORT" to "socket" (see SocketTransport)
+// Usage example: mcp2210d --socket /run/mcp2210d.socket
+
+// Includes
+#include <cstdlib>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QTextStream>
+#include "mcp2210protocol.h"
+#include "mcp2210server.h"
+#include "mcp2210transport.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mcp2210d");
+    QCoreApplication::setApplicationVersion("1.0.0");
+    QString defaultName = QFile::decodeName(qgetenv("MCP2210_SOCKET"));
+    if (defaultName.isEmpty()) {
+        defaultName = MCP2210Protocol::DEFAULT_SERVER;
+    }
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("MCP2210 daemon, which allows several processes to share the same MCP2210 devices."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption socketOption("socket", QObject::tr("Local server name or socket file path (default \"%1\").").arg(defaultName), "name", defaultName);
+    parser.addOption(socketOption);
+    parser.process(app);
+    QTextStream err(stderr);
+    int retval;
+    if (MCP2210Transport::defaultType() == MCP2210Transport::SOCKET) {  // The daemon would otherwise connect to itself
+        err << QObject::tr("The daemon cannot use the socket transport. Please set \"MCP2210_TRANSPORT\" to a different value.") << "\n";
+        retval = EXIT_FAILURE;
+    } else {
+        MCP2210Server server;
+        int errcnt = 0;
+        QString errstr;
+        server.listen(parser.value(socketOption), errcnt, errstr);
+        if (errcnt > 0) {
+            err << errstr;
+            retval = EXIT_FAILURE;
+        } else {
+            QTextStream(stdout) << QObject::tr("Listening on \"%1\".").arg(parser.value(socketOption)) << "\n";
+            retval = app.exec();
+        }
+    }
+    return retval;
+}
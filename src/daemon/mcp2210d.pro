@@ -0,0 +1,39 @@
+# MCP2210 daemon, which shares MCP2210 devices among several processes via a
+# local socket (console application, requiring QtCore and QtNetwork only)
+
+QT       += core
+QT       -= gui
+
+# Added to provide backwards compatibility (C++11 support)
+greaterThan(QT_MAJOR_VERSION, 4) {
+    CONFIG += c++11
+} else {
+    QMAKE_CXXFLAGS += -std=c++11
+}
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = mcp2210d
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../mcp2210corelib.pri)
+
+SOURCES += \
+    main.cpp \
+    mcp2210server.cpp
+
+HEADERS += \
+    mcp2210server.h
+
+# Added installation option
+unix {
+    isEmpty(PREFIX) {
+        PREFIX = /usr/local
+    }
+    target.path = $$PREFIX/bin
+}
+
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,338 @@
+/* MCP2210 daemon for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cstring>
+#include <QTextStream>
+#include <libusb-1.0/libusb.h>
+#include "mcp2210.h"
+#include "mcp2210coalescer.h"
+#include "mcp2210protocol.h"
+#include "mcp2210server.h"
+
+// Definitions
+const int CONNECT_TIMEOUT = 1000;     // Timeout for checking if another instance is listening, in milliseconds
+const quint8 EPIN = 0x81;             // Address of endpoint assuming the IN direction
+const quint8 EPOUT = 0x01;            // Address of endpoint assuming the OUT direction
+const unsigned int TR_TIMEOUT = 500;  // Transfer timeout in milliseconds
+
+// Private function that is used to detach a client from its device, closing the latter if it is no longer used by any client
+void MCP2210Server::closeDevice(Client *client)
+{
+    Device *device = client->device;
+    if (device != nullptr) {
+        client->requests.clear();
+        client->device = nullptr;
+        device->clients.removeOne(client);
+        if (device->owner == client) {  // The SPI transfer left ongoing by the client is cancelled, so that other clients can use the SPI bus
+            QByteArray cancel(MCP2210Protocol::PACKET_SIZE, 0x00);
+            cancel[0] = static_cast<char>(MCP2210::CANCEL_SPI_TRANSFER);
+            execute(device, cancel);
+            device->owner = nullptr;
+        }
+        if (device->clients.isEmpty()) {
+            QTextStream(stdout) << QObject::tr("Closed device %1:%2 (%3 commands sent, %4 commands coalesced).").arg(device->vid, 4, 16, QChar('0')).arg(device->pid, 4, 16, QChar('0')).arg(device->commands).arg(device->coalesced) << "\n";
+            device->transport->close();
+            delete device->transport;
+            devices_.removeOne(device);
+            delete device;
+        } else {
+            device->next %= device->clients.size();
+        }
+    }
+}
+
+// Private function that is used to send a batch of HID commands to the given device, returning the corresponding "TRANSFER" answer
+// If a command fails, the remaining commands of the batch are not sent, and they get the same result
+QByteArray MCP2210Server::execute(Device *device, const QByteArray &request)
+{
+    int count = request.size() / MCP2210Protocol::PACKET_SIZE;
+    QByteArray answer;
+    answer.reserve(count * (MCP2210Protocol::RESULT_SIZE + MCP2210Protocol::PACKET_SIZE));
+    int result = 0;
+    for (int i = 0; i < count; ++i) {
+        unsigned char command[MCP2210Protocol::PACKET_SIZE];
+        std::memcpy(command, request.constData() + i * MCP2210Protocol::PACKET_SIZE, sizeof(command));
+        unsigned char response[MCP2210Protocol::PACKET_SIZE] = {0x00};
+        if (result == 0) {
+            int transferred = 0;
+            result = device->transport->interruptTransfer(EPOUT, command, MCP2210Protocol::PACKET_SIZE, &transferred, TR_TIMEOUT);
+            if (result == 0 && transferred == MCP2210Protocol::PACKET_SIZE) {
+                result = device->transport->interruptTransfer(EPIN, response, MCP2210Protocol::PACKET_SIZE, &transferred, TR_TIMEOUT);
+            }
+            if (result == 0 && transferred != MCP2210Protocol::PACKET_SIZE) {  // Incomplete transfers are also reported as failures, since the client cannot detect them otherwise
+                result = LIBUSB_ERROR_OTHER;
+            }
+            ++device->commands;
+        }
+        MCP2210Protocol::appendUInt32(answer, static_cast<quint32>(result));
+        answer.append(reinterpret_cast<const char *>(response), MCP2210Protocol::PACKET_SIZE);
+    }
+    return answer;
+}
+
+// Private function that is used to handle a complete frame received from the given client
+// Returns false if the frame violates the protocol, in which case the client should be dropped
+bool MCP2210Server::handleFrame(Client *client, quint8 type, const QByteArray &payload)
+{
+    bool valid = true;
+    if (type == MCP2210Protocol::LIST && payload.size() == 4) {
+        MCP2210Transport *transport = MCP2210Transport::create();
+        int errcnt = 0;
+        QString errstr;
+        QStringList devices = transport->listDevices(MCP2210Protocol::readUInt16(payload, 0), MCP2210Protocol::readUInt16(payload, 2), errcnt, errstr);
+        delete transport;
+        QByteArray answer;
+        if (errcnt > 0) {
+            answer += static_cast<char>(MCP2210Protocol::STFAILED);
+            answer += errstr.toUtf8();
+        } else {
+            answer += static_cast<char>(MCP2210Protocol::STOK);
+            answer += devices.join("\n").toUtf8();
+        }
+        client->socket->write(MCP2210Protocol::buildFrame(MCP2210Protocol::LIST, answer));
+    } else if (type == MCP2210Protocol::OPEN && payload.size() >= 4) {
+        closeDevice(client);  // Just in case the client already has a device open
+        quint16 vid = MCP2210Protocol::readUInt16(payload, 0);
+        quint16 pid = MCP2210Protocol::readUInt16(payload, 2);
+        QString serial = QString::fromUtf8(payload.mid(4));
+        Device *device = nullptr;
+        for (Device *candidate : devices_) {
+            if (candidate->vid == vid && candidate->pid == pid && (serial.isEmpty() || candidate->serial == serial)) {  // A device that is already open is shared
+                device = candidate;
+                break;
+            }
+        }
+        int result = MCP2210::SUCCESS;
+        if (device == nullptr) {
+            MCP2210Transport *transport = MCP2210Transport::create();
+            result = transport->open(vid, pid, serial);
+            if (result == MCP2210::SUCCESS) {
+                device = new Device;
+                device->vid = vid;
+                device->pid = pid;
+                device->serial = serial;
+                device->transport = transport;
+                device->owner = nullptr;
+                device->next = 0;
+                device->commands = 0;
+                device->coalesced = 0;
+                devices_ += device;
+                QTextStream(stdout) << QObject::tr("Opened device %1:%2.").arg(vid, 4, 16, QChar('0')).arg(pid, 4, 16, QChar('0')) << "\n";
+            } else {
+                delete transport;
+            }
+        }
+        if (device != nullptr) {
+            device->clients += client;
+            client->device = device;
+        }
+        QByteArray answer;
+        MCP2210Protocol::appendUInt32(answer, static_cast<quint32>(result));
+        client->socket->write(MCP2210Protocol::buildFrame(MCP2210Protocol::OPEN, answer));
+    } else if (type == MCP2210Protocol::CLOSE) {
+        closeDevice(client);
+    } else if (type == MCP2210Protocol::TRANSFER && payload.size() > 0 && payload.size() % MCP2210Protocol::PACKET_SIZE == 0 && payload.size() <= MCP2210Protocol::BATCH_MAXSIZE * MCP2210Protocol::PACKET_SIZE) {
+        if (client->device == nullptr) {  // The device is not open, so every command fails immediately (the client has no pending requests, so the order of answers is kept)
+            QByteArray answer;
+            for (int i = 0; i < payload.size() / MCP2210Protocol::PACKET_SIZE; ++i) {
+                MCP2210Protocol::appendUInt32(answer, static_cast<quint32>(LIBUSB_ERROR_NO_DEVICE));
+                answer += QByteArray(MCP2210Protocol::PACKET_SIZE, 0x00);
+            }
+            client->socket->write(MCP2210Protocol::buildFrame(MCP2210Protocol::TRANSFER, answer));
+        } else {
+            client->requests.enqueue(payload);
+            scheduleDispatch();
+        }
+    } else {
+        valid = false;
+    }
+    return valid;
+}
+
+// Private function that is used to parse the data received from the given client
+// Note that the client is dropped (and deleted) on a protocol violation, so it should not be accessed after calling this function
+void MCP2210Server::readRequests(Client *client)
+{
+    client->buffer += client->socket->readAll();
+    bool valid = true;
+    int result;
+    do {
+        quint8 type;
+        QByteArray payload;
+        result = MCP2210Protocol::takeFrame(client->buffer, type, payload);
+        if (result == MCP2210Protocol::FRINVALID || (result == MCP2210Protocol::FRTAKEN && !handleFrame(client, type, payload))) {
+            valid = false;
+        }
+    } while (valid && result == MCP2210Protocol::FRTAKEN);
+    if (!valid) {
+        QTextStream(stdout) << QObject::tr("Dropped client due to a protocol violation.") << "\n";
+        client->socket->abort();  // This leads to the removal of the client
+    }
+}
+
+// Private function that is used to remove a client that has disconnected
+void MCP2210Server::removeClient(Client *client)
+{
+    closeDevice(client);
+    clients_.removeOne(client);
+    client->socket->deleteLater();
+    delete client;
+}
+
+// Private function that is used to schedule the dispatching of pending requests, if not yet scheduled
+// Dispatching is deferred to the event loop, so that requests arriving meanwhile from other clients can join the next round
+void MCP2210Server::scheduleDispatch()
+{
+    if (!dispatchScheduled_) {
+        dispatchScheduled_ = true;
+        QMetaObject::invokeMethod(this, "dispatch", Qt::QueuedConnection);
+    }
+}
+
+// Private function that is used to serve one round of requests for the given device
+void MCP2210Server::serveRound(Device *device)
+{
+    QList<Client *> round;
+    if (device->owner != nullptr) {  // The device is reserved to the client that has an SPI transfer ongoing
+        if (!device->owner->requests.isEmpty()) {
+            round += device->owner;
+        }
+    } else {
+        int count = device->clients.size();
+        for (int i = 0; i < count; ++i) {
+            Client *client = device->clients.at((device->next + i) % count);
+            if (!client->requests.isEmpty()) {
+                round += client;
+            }
+        }
+        device->next = count == 0 ? 0 : (device->next + 1) % count;  // The first client to be served rotates every round
+    }
+    QList<QByteArray> coalescable;  // Coalescable requests already sent to the device within this round
+    QList<QByteArray> answers;      // Answers to the above requests
+    for (Client *client : round) {
+        if (device->owner != nullptr && device->owner != client) {  // A client served earlier within this round started an SPI transfer
+            break;
+        }
+        QByteArray request = client->requests.dequeue();
+        bool coalesce = request.size() == MCP2210Protocol::PACKET_SIZE && MCP2210Coalescer::isCoalescable(reinterpret_cast<const unsigned char *>(request.constData()));  // Only requests consisting of a single HID command are coalesced
+        int index = coalesce ? coalescable.indexOf(request) : -1;
+        QByteArray answer;
+        if (index >= 0) {
+            answer = answers.at(index);
+            ++device->coalesced;
+        } else {
+            answer = execute(device, request);
+            updateOwner(device, client, request, answer);
+            if (coalesce) {
+                coalescable += request;
+                answers += answer;
+            }
+        }
+        client->socket->write(MCP2210Protocol::buildFrame(MCP2210Protocol::TRANSFER, answer));
+    }
+}
+
+// Private function that is used to reserve the device to the given client while an SPI transfer is ongoing, or to release it once that transfer finishes or is cancelled
+void MCP2210Server::updateOwner(Device *device, Client *client, const QByteArray &request, const QByteArray &answer)
+{
+    int count = request.size() / MCP2210Protocol::PACKET_SIZE;
+    for (int i = 0; i < count; ++i) {
+        quint8 command = static_cast<quint8>(request.at(i * MCP2210Protocol::PACKET_SIZE));
+        int offset = i * (MCP2210Protocol::RESULT_SIZE + MCP2210Protocol::PACKET_SIZE);
+        bool succeeded = MCP2210Protocol::readUInt32(answer, offset) == 0;
+        if (command == MCP2210::CANCEL_SPI_TRANSFER) {
+            device->owner = nullptr;
+        } else if (command == MCP2210::TRANSFER_SPI_DATA && succeeded && static_cast<quint8>(answer.at(offset + MCP2210Protocol::RESULT_SIZE + 1)) == MCP2210::COMPLETED) {
+            device->owner = static_cast<quint8>(answer.at(offset + MCP2210Protocol::RESULT_SIZE + 3)) == MCP2210::TRANSFER_FINISHED ? nullptr : client;  // SPI transfer engine status corresponds to byte 3
+        }
+    }
+}
+
+MCP2210Server::MCP2210Server(QObject *parent) :
+    QObject(parent),
+    dispatchScheduled_(false)
+{
+    connect(&server_, &QLocalServer::newConnection, this, &MCP2210Server::acceptConnections);
+}
+
+MCP2210Server::~MCP2210Server()
+{
+    while (!clients_.isEmpty()) {
+        Client *client = clients_.first();
+        client->socket->disconnect(this);  // The disconnection handler must not be called for a client that is already being removed
+        removeClient(client);
+    }
+}
+
+// Starts listening for clients on the given local server name (either a name or the path of a socket file)
+// Clients must have the same user or group of the daemon in order to connect
+// A socket file that is left behind is only removed if no other instance answers on it
+void MCP2210Server::listen(const QString &name, int &errcnt, QString &errstr)
+{
+    QLocalSocket socket;
+    socket.connectToServer(name);
+    if (socket.waitForConnected(CONNECT_TIMEOUT)) {  // Another instance is serving clients on the same name, and must not be disrupted
+        socket.disconnectFromServer();
+        ++errcnt;
+        errstr += QObject::tr("Could not listen on \"%1\": another instance is already listening.\n").arg(name);
+    } else {
+        QLocalServer::removeServer(name);  // Removes a stale socket file, left behind by a previous instance that has crashed
+        server_.setSocketOptions(QLocalServer::GroupAccessOption);
+        if (!server_.listen(name)) {
+            ++errcnt;
+            errstr += QObject::tr("Could not listen on \"%1\": %2\n").arg(name, server_.errorString());
+        }
+    }
+}
+
+// Accepts any pending connections from new clients
+void MCP2210Server::acceptConnections()
+{
+    QLocalSocket *socket;
+    while ((socket = server_.nextPendingConnection()) != nullptr) {
+        Client *client = new Client;
+        client->socket = socket;
+        client->device = nullptr;
+        clients_ += client;
+        connect(socket, &QLocalSocket::readyRead, this, [this, client]() {
+            readRequests(client);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, client]() {
+            removeClient(client);
+        });
+    }
+}
+
+// Serves one round of pending requests for each device, scheduling another round if requests are still pending
+void MCP2210Server::dispatch()
+{
+    dispatchScheduled_ = false;
+    bool pending = false;
+    for (Device *device : devices_) {
+        serveRound(device);
+        for (Client *client : device->clients) {
+            pending = pending || !client->requests.isEmpty();
+        }
+    }
+    if (pending) {
+        scheduleDispatch();
+    }
+}
@@ -0,0 +1,92 @@
+/* MCP2210 daemon for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210SERVER_H
+#define MCP2210SERVER_H
+
+// Includes
+#include <QByteArray>
+#include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include "mcp2210transport.h"
+
+// Server that owns MCP2210 devices on behalf of its clients, which connect via a local socket (see "mcp2210protocol.h")
+// Clients that open the same device share it, and their requests are served in rounds, taking at most one request per client (round-robin)
+// Identical read-only commands issued concurrently by different clients within the same round are sent to the device only once
+// While a client has an SPI transfer ongoing, the device is reserved to that client, so that the transfer is not disrupted
+class MCP2210Server : public QObject
+{
+    Q_OBJECT
+
+private:
+    struct Device;
+
+    struct Client {
+        QLocalSocket *socket;
+        QByteArray buffer;            // Received data not yet parsed
+        Device *device;               // Device opened by the client (null if none)
+        QQueue<QByteArray> requests;  // Pending "TRANSFER" requests
+    };
+
+    struct Device {
+        quint16 vid;
+        quint16 pid;
+        QString serial;                // Serial number, as requested by the first client (may be empty)
+        MCP2210Transport *transport;
+        QList<Client *> clients;       // Clients that have the device open
+        Client *owner;                 // Client that has an SPI transfer ongoing (null if none)
+        int next;                      // Index of the client to be served first in the next round
+        quint64 commands;              // Number of HID commands sent to the device
+        quint64 coalesced;             // Number of HID commands answered without being sent to the device
+    };
+
+    QLocalServer server_;
+    QList<Client *> clients_;
+    QList<Device *> devices_;
+    bool dispatchScheduled_;
+
+    void closeDevice(Client *client);
+    QByteArray execute(Device *device, const QByteArray &request);
+    bool handleFrame(Client *client, quint8 type, const QByteArray &payload);
+    void readRequests(Client *client);
+    void removeClient(Client *client);
+    void scheduleDispatch();
+    void serveRound(Device *device);
+    void updateOwner(Device *device, Client *client, const QByteArray &request, const QByteArray &answer);
+
+public:
+    explicit MCP2210Server(QObject *parent = nullptr);
+    MCP2210Server(const MCP2210Server &) = delete;
+    ~MCP2210Server();
+
+    MCP2210Server &operator =(const MCP2210Server &) = delete;
+
+    void listen(const QString &name, int &errcnt, QString &errstr);
+
+private slots:
+    void acceptConnections();
+    void dispatch();
+};
+
+#endif  // MCP2210SERVER_H
@@ -0,0 +1,140 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QElapsedTimer>
+#include "deviceinventoryworker.h"
+#include "mcp2210.h"
+#include "mcp2210devicecache.h"
+#include "mcp2210devicelock.h"
+
+// Creates a worker that stays idle until a target VID and PID are given via setTarget()
+DeviceInventoryWorker::DeviceInventoryWorker(QObject *parent) :
+    QObject(parent),
+    enumerationTimer_(this),  // Both timers are children of the worker, so that they follow it when moved to another thread
+    fetchTimer_(this),
+    vid_(0),
+    pid_(0)
+{
+    enumerationTimer_.setInterval(ENUMERATION_INTERVAL);
+    fetchTimer_.setSingleShot(true);  // Fetching one device per timer event lets enumerations and new requests interleave with long fetches
+    connect(&enumerationTimer_, &QTimer::timeout, this, &DeviceInventoryWorker::enumerate);
+    connect(&fetchTimer_, &QTimer::timeout, this, &DeviceInventoryWorker::fetchNext);
+}
+
+// Enumerates the devices having the target VID and PID, without reading their NVRAM descriptors
+// Only devices that are new or attached again are opened, in order to read their USB strings (see MCP2210DeviceCache::enumerate())
+void DeviceInventoryWorker::enumerate()
+{
+    int errcnt = 0;
+    QString errstr;
+    QVector<MCP2210DeviceCache::Entry> entries = MCP2210DeviceCache::instance().enumerate(vid_, pid_, false, errcnt, errstr);
+    if (errcnt > 0) {  // Enumeration keeps being retried on every timer event, since the failure may be transient
+        emit errorOccurred(errstr);
+    } else {
+        QVector<MCP2210Transport::DeviceInfo> devices;
+        devices.reserve(entries.size());
+        for (const MCP2210DeviceCache::Entry &entry : entries) {
+            devices += entry.device;
+        }
+        emit devicesEnumerated(vid_, pid_, devices);
+    }
+}
+
+// Queues a request for the details of the given device, unless it is already queued
+// Requests are served in reverse order, since the most recent ones usually refer to the rows that are visible
+void DeviceInventoryWorker::requestDetails(const QString &key, const QString &serial)
+{
+    QPair<QString, QString> request(key, serial);
+    pending_.removeOne(request);
+    pending_ += request;
+    if (!fetchTimer_.isActive()) {
+        fetchTimer_.start(0);
+    }
+}
+
+// Sets the VID and PID of the devices to be listed, and starts enumerating them immediately
+// Pending detail requests refer to the previous target, and are therefore dropped
+void DeviceInventoryWorker::setTarget(quint16 vid, quint16 pid)
+{
+    vid_ = vid;
+    pid_ = pid;
+    pending_.clear();
+    enumerate();
+    enumerationTimer_.start();
+}
+
+// Stops enumerating and drops any pending requests
+void DeviceInventoryWorker::stop()
+{
+    enumerationTimer_.stop();
+    fetchTimer_.stop();
+    pending_.clear();
+}
+
+// Fetches the details of the most recently requested device
+// The device is opened only briefly, and with a zero timeout, so that a window waiting to open it is served right after (see MCP2210::open())
+// The NVRAM descriptors are only read if they are not cached yet, and are then stored in the cache for subsequent fetches
+void DeviceInventoryWorker::fetchNext()
+{
+    if (!pending_.isEmpty()) {
+        QPair<QString, QString> request = pending_.takeLast();
+        Details details = Details();
+        details.key = request.first;
+        details.serial = request.second;
+        MCP2210DeviceCache &cache = MCP2210DeviceCache::instance();
+        details.descriptorsValid = cache.descriptors(vid_, pid_, details.serial, details.manufacturer, details.product);  // Cached descriptors are also shown for devices that are busy
+        MCP2210 mcp2210;
+        int result = mcp2210.open(vid_, pid_, details.serial, 0);
+        if (result == MCP2210::SUCCESS) {
+            details.access = ACAVAILABLE;
+            int errcnt = 0;
+            QString errstr;
+            QElapsedTimer timer;
+            timer.start();
+            mcp2210.getChipStatus(errcnt, errstr);
+            details.latency = timer.nsecsElapsed() / 1000;
+            details.health = errcnt == 0 ? HSHEALTHY : HSFAILED;
+            if (errcnt == 0 && !details.descriptorsValid) {
+                details.manufacturer = mcp2210.getManufacturerDesc(errcnt, errstr);
+                details.product = mcp2210.getProductDesc(errcnt, errstr);
+                details.descriptorsValid = errcnt == 0;
+                if (details.descriptorsValid) {
+                    cache.setDescriptors(vid_, pid_, details.serial, details.manufacturer, details.product);
+                }
+            }
+            mcp2210.close();
+        } else if (result == MCP2210::ERROR_BUSY) {
+            details.access = ACBUSY;
+            MCP2210DeviceLock::Holder holder = MCP2210DeviceLock(vid_, pid_, details.serial).holder();
+            if (holder.isValid()) {
+                details.holder = holder.toString();
+            }
+        } else if (result == MCP2210::ERROR_ACCESS) {
+            details.access = ACDENIED;
+        } else {
+            details.access = result == MCP2210::ERROR_NOT_FOUND ? ACNOTFOUND : ACUNKNOWN;
+        }
+        emit detailsFetched(details);
+    }
+    if (!pending_.isEmpty()) {
+        fetchTimer_.start(0);
+    }
+}
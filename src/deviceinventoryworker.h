@@ -0,0 +1,97 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef DEVICEINVENTORYWORKER_H
+#define DEVICEINVENTORYWORKER_H
+
+// Includes
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+#include "mcp2210transport.h"
+
+// Background worker that feeds the device dashboard, meant to live in its own thread
+// Devices are enumerated periodically via MCP2210DeviceCache, which is cheap, so that attached and removed devices are detected without blocking the GUI
+// Details that require opening a device (access mode and health) are only fetched on request, one device at a time, so that requests for visible rows are served first
+// NVRAM descriptors are taken from MCP2210DeviceCache, and are only read while the device is open for the first time, so that refreshing the details costs a single round trip per device
+class DeviceInventoryWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Class definitions
+    static const int ENUMERATION_INTERVAL = 1000;  // Interval between enumerations, in milliseconds
+
+    // The following values are applicable to Details::access
+    static const int ACUNKNOWN = 0;    // Access mode not yet known
+    static const int ACAVAILABLE = 1;  // Device can be opened
+    static const int ACBUSY = 2;       // Device is in use by another process (or by another window)
+    static const int ACNOTFOUND = 3;   // Device was removed meanwhile
+    static const int ACDENIED = 4;     // Access to the device was denied (insufficient permissions)
+
+    // The following values are applicable to Details::health
+    static const int HSUNKNOWN = 0;  // Health not yet known (e.g. the device is busy)
+    static const int HSHEALTHY = 1;  // Device responded to "GET_CHIP_STATUS"
+    static const int HSFAILED = 2;   // Device did not respond properly
+
+    struct Details {
+        QString key;              // Row key, as given to requestDetails()
+        QString serial;           // Serial number
+        int access;               // Access mode (see "AC" values)
+        QString holder;           // Description of the process that holds the device, if known (ACBUSY only)
+        int health;               // Health (see "HS" values)
+        qint64 latency;           // Round-trip latency of "GET_CHIP_STATUS", in microseconds (HSHEALTHY only)
+        bool descriptorsValid;    // The NVRAM descriptors below were read
+        QString manufacturer;     // Manufacturer descriptor
+        QString product;          // Product descriptor
+    };
+
+private:
+    QTimer enumerationTimer_;
+    QTimer fetchTimer_;
+    QList<QPair<QString, QString>> pending_;  // Pending detail requests, as pairs of row keys and serial numbers
+    quint16 vid_, pid_;
+
+public:
+    explicit DeviceInventoryWorker(QObject *parent = nullptr);
+
+public slots:
+    void enumerate();
+    void requestDetails(const QString &key, const QString &serial);
+    void setTarget(quint16 vid, quint16 pid);
+    void stop();
+
+signals:
+    void detailsFetched(const DeviceInventoryWorker::Details &details);
+    void devicesEnumerated(quint16 vid, quint16 pid, const QVector<MCP2210Transport::DeviceInfo> &devices);
+    void errorOccurred(const QString &errstr);
+
+private slots:
+    void fetchNext();
+};
+
+Q_DECLARE_METATYPE(DeviceInventoryWorker::Details)
+Q_DECLARE_METATYPE(QVector<MCP2210Transport::DeviceInfo>)
+
+#endif  // DEVICEINVENTORYWORKER_H
@@ -0,0 +1,240 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include "devicetablemodel.h"
+
+// Private function that returns the text of the access mode column for the given row
+QString DeviceTableModel::accessText(const Row &row) const
+{
+    QString text;
+    if (openSerials_.contains(row.device.serial)) {
+        text = tr("Open");
+    } else if (row.details.access == DeviceInventoryWorker::ACAVAILABLE) {
+        text = tr("Available");
+    } else if (row.details.access == DeviceInventoryWorker::ACBUSY) {
+        text = row.details.holder.isEmpty() ? tr("In use") : tr("In use by %1").arg(row.details.holder);
+    } else if (row.details.access == DeviceInventoryWorker::ACNOTFOUND) {
+        text = tr("Removed");
+    } else if (row.details.access == DeviceInventoryWorker::ACDENIED) {
+        text = tr("Access denied");
+    } else {
+        text = tr("...");
+    }
+    return text;
+}
+
+// Private function that returns the text of the health column for the given row
+QString DeviceTableModel::healthText(const Row &row) const
+{
+    QString text;
+    if (row.details.health == DeviceInventoryWorker::HSHEALTHY) {
+        text = tr("OK (%1 us)").arg(row.details.latency);
+    } else if (row.details.health == DeviceInventoryWorker::HSFAILED) {
+        text = tr("Not responding");
+    } else if (row.details.access == DeviceInventoryWorker::ACUNKNOWN) {
+        text = tr("...");
+    } else {
+        text = tr("Unknown");
+    }
+    return text;
+}
+
+// Private function that requests the details of the given row, unless they were already requested
+void DeviceTableModel::requestRowDetails(int row)
+{
+    if (!rows_[row].requested) {
+        rows_[row].requested = true;
+        emit detailsRequested(rows_[row].key, rows_[row].device.serial);
+    }
+}
+
+// Private function that rebuilds the map of row indexes, which is required after rows are removed
+void DeviceTableModel::updateRowIndexes()
+{
+    rowIndexes_.clear();
+    for (int i = 0; i < rows_.size(); ++i) {
+        rowIndexes_.insert(rows_[i].key, i);
+    }
+}
+
+// Private function that returns the key that identifies a row, which changes whenever the device is attached again
+QString DeviceTableModel::rowKey(const MCP2210Transport::DeviceInfo &device)
+{
+    return QString("%1@%2/%3").arg(device.path).arg(device.address).arg(device.serial);
+}
+
+DeviceTableModel::DeviceTableModel(QObject *parent) :
+    QAbstractTableModel(parent),
+    vid_(0),
+    pid_(0)
+{
+}
+
+int DeviceTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : COLUMNS;
+}
+
+// Returns the data of the given cell, requesting the details of its row on first use
+QVariant DeviceTableModel::data(const QModelIndex &index, int role) const
+{
+    QVariant retval;
+    if (index.isValid() && index.row() < rows_.size() && role == Qt::DisplayRole) {
+        const Row &row = rows_[index.row()];
+        if (!row.requested) {
+            const_cast<DeviceTableModel *>(this)->requestRowDetails(index.row());  // The view only asks for visible rows, so this is where details are fetched lazily
+        }
+        int column = index.column();
+        if (column == COLSERIAL) {
+            retval = row.device.serial;
+        } else if (column == COLMANUFACTURER) {
+            retval = row.details.descriptorsValid ? row.details.manufacturer : row.device.manufacturer;  // The USB string is shown until the NVRAM descriptor is read
+        } else if (column == COLPRODUCT) {
+            retval = row.details.descriptorsValid ? row.details.product : row.device.product;
+        } else if (column == COLVIDPID) {
+            retval = QString("%1:%2").arg(vid_, 4, 16, QChar('0')).arg(pid_, 4, 16, QChar('0'));
+        } else if (column == COLLOCATION) {
+            retval = row.device.path;
+        } else if (column == COLACCESS) {
+            retval = accessText(row);
+        } else if (column == COLHEALTH) {
+            retval = healthText(row);
+        }
+    }
+    return retval;
+}
+
+QVariant DeviceTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    QVariant retval;
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        if (section == COLSERIAL) {
+            retval = tr("Serial number");
+        } else if (section == COLMANUFACTURER) {
+            retval = tr("Manufacturer");
+        } else if (section == COLPRODUCT) {
+            retval = tr("Product");
+        } else if (section == COLVIDPID) {
+            retval = tr("VID:PID");
+        } else if (section == COLLOCATION) {
+            retval = tr("Location");
+        } else if (section == COLACCESS) {
+            retval = tr("Access");
+        } else if (section == COLHEALTH) {
+            retval = tr("Health");
+        }
+    }
+    return retval;
+}
+
+int DeviceTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows_.size();
+}
+
+// Returns the serial number of the device at the given row, or a null string if the row is not valid
+QString DeviceTableModel::serial(int row) const
+{
+    return row < 0 || row >= rows_.size() ? QString() : rows_[row].device.serial;
+}
+
+// Discards the details of the given row, so that they are fetched again as soon as the row is visible
+void DeviceTableModel::invalidateDetails(int row)
+{
+    if (row >= 0 && row < rows_.size()) {
+        rows_[row].requested = false;
+        emit dataChanged(index(row, 0), index(row, COLUMNS - 1));  // Makes the view ask for the row again, if it is visible
+    }
+}
+
+// Marks the device having the given serial number as open (or not) in this application
+void DeviceTableModel::setDeviceOpen(const QString &serial, bool open)
+{
+    if (open) {
+        openSerials_.insert(serial);
+    } else {
+        openSerials_.remove(serial);
+    }
+    for (int i = 0; i < rows_.size(); ++i) {
+        if (rows_[i].device.serial == serial) {
+            invalidateDetails(i);  // Access and health are fetched again, since they change with the state of the window
+        }
+    }
+}
+
+// Updates the rows according to the given enumeration, by removing the rows of devices that are gone and appending rows for new devices
+// Existing rows keep their details, so that devices are not opened again on every enumeration
+void DeviceTableModel::setDevices(quint16 vid, quint16 pid, const QVector<MCP2210Transport::DeviceInfo> &devices)
+{
+    if (vid != vid_ || pid != pid_) {  // A different target invalidates every row
+        beginResetModel();
+        vid_ = vid;
+        pid_ = pid;
+        rows_.clear();
+        rowIndexes_.clear();
+        endResetModel();
+    }
+    QSet<QString> keys;
+    for (const MCP2210Transport::DeviceInfo &device : devices) {
+        keys.insert(rowKey(device));
+    }
+    bool removed = false;
+    for (int i = rows_.size() - 1; i >= 0; --i) {  // Removing from the end keeps the indexes of the remaining candidates valid
+        if (!keys.contains(rows_[i].key)) {
+            beginRemoveRows(QModelIndex(), i, i);
+            rows_.remove(i);
+            endRemoveRows();
+            removed = true;
+        }
+    }
+    if (removed) {
+        updateRowIndexes();
+    }
+    QVector<Row> added;
+    for (const MCP2210Transport::DeviceInfo &device : devices) {
+        QString key = rowKey(device);
+        if (!rowIndexes_.contains(key)) {
+            Row row = Row();
+            row.key = key;
+            row.device = device;
+            added += row;
+            rowIndexes_.insert(key, rows_.size() + added.size() - 1);
+        }
+    }
+    if (!added.isEmpty()) {  // New rows are inserted at once, so that the view only lays them out once
+        beginInsertRows(QModelIndex(), rows_.size(), rows_.size() + added.size() - 1);
+        rows_ += added;
+        endInsertRows();
+    }
+}
+
+// Applies the details fetched for a given row, if it still exists
+void DeviceTableModel::setDetails(const DeviceInventoryWorker::Details &details)
+{
+    QHash<QString, int>::const_iterator found = rowIndexes_.constFind(details.key);
+    if (found != rowIndexes_.constEnd()) {
+        int row = found.value();
+        if (rows_[row].requested) {  // Otherwise, the details were invalidated meanwhile, and are fetched again
+            rows_[row].details = details;
+            emit dataChanged(index(row, 0), index(row, COLUMNS - 1));
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/* MCP2210 Configurator - Version 1.0.1 for Debian Linux
+   Copyright (c) 2023-2024 Samuel Lourenço
+
+   This program is free software: you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the Free
+   Software Foundation, either version 3 of the License, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+   more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef DEVICETABLEMODEL_H
+#define DEVICETABLEMODEL_H
+
+// Includes
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QModelIndex>
+#include <QSet>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include "deviceinventoryworker.h"
+#include "mcp2210transport.h"
+
+// Table model behind the device dashboard, having one row per attached device
+// Rows are updated incrementally from the enumerations done by DeviceInventoryWorker, so that the selection and scroll position survive refreshes
+// Details are fetched lazily: requestDetails() is only emitted once the view asks for a row, which a QTableView does for the visible rows only
+class DeviceTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    // The following values are applicable to columns
+    static const int COLSERIAL = 0;
+    static const int COLMANUFACTURER = 1;
+    static const int COLPRODUCT = 2;
+    static const int COLVIDPID = 3;
+    static const int COLLOCATION = 4;
+    static const int COLACCESS = 5;
+    static const int COLHEALTH = 6;
+    static const int COLUMNS = 7;
+
+private:
+    struct Row {
+        QString key;
+        MCP2210Transport::DeviceInfo device;
+        bool requested;                           // Details were requested
+        DeviceInventoryWorker::Details details;   // Details, which are only valid if "access" is not ACUNKNOWN
+    };
+
+    QVector<Row> rows_;
+    QHash<QString, int> rowIndexes_;  // Row index for each key
+    QSet<QString> openSerials_;       // Serial numbers of the devices open in this application
+    quint16 vid_, pid_;
+
+    QString accessText(const Row &row) const;
+    QString healthText(const Row &row) const;
+    void requestRowDetails(int row);
+    void updateRowIndexes();
+
+    static QString rowKey(const MCP2210Transport::DeviceInfo &device);
+
+public:
+    explicit DeviceTableModel(QObject *parent = nullptr);
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QString serial(int row) const;
+
+    void invalidateDetails(int row);
+    void setDeviceOpen(const QString &serial, bool open);
+    void setDevices(quint16 vid, quint16 pid, const QVector<MCP2210Transport::DeviceInfo> &devices);
+    void setDetails(const DeviceInventoryWorker::Details &details);
+
+signals:
+    void detailsRequested(const QString &key, const QString &serial);
+};
+
+#endif  // DEVICETABLEMODEL_H
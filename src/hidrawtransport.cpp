@@ -0,0 +1,211 @@
+/* Hidraw transport for the MCP2210 class for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cerrno>
+#include <cstring>
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <libusb-1.0/libusb.h>
+#include "hidrawtransport.h"
+#include "mcp2210.h"
+
+// Definitions
+const char SYSFS_HIDRAW_PATH[] = "/sys/class/hidraw";  // Path to the hidraw class directory in sysfs
+const int REPORT_MAXSIZE = 64;                          // Maximum size of a HID report, excluding the report ID
+
+// Private function that looks for the hidraw device node having the given VID, PID and, optionally, the given serial number (returns an empty string if the device is not found)
+QString HidrawTransport::findDevice(quint16 vid, quint16 pid, const QString &serial)
+{
+    QString devicePath;
+    const QStringList nodes = QDir(SYSFS_HIDRAW_PATH).entryList(QDir::Dirs | QDir::System | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString &node : nodes) {
+        QString uniq;
+        if (readNodeInfo(node, vid, pid, uniq) && (serial.isNull() || uniq == serial)) {  // Note that serial, by omission, is a null QString
+            devicePath = "/dev/" + node;
+            break;
+        }
+    }
+    return devicePath;
+}
+
+// Private function that reads the "uevent" file of a given hidraw node, returning true if the VID and PID match the given ones
+// The serial number, which is reported by the kernel via the "HID_UNIQ" key, is returned via "serial"
+bool HidrawTransport::readNodeInfo(const QString &node, quint16 vid, quint16 pid, QString &serial)
+{
+    bool idMatches = false;
+    QFile uevent(QString("%1/%2/device/uevent").arg(SYSFS_HIDRAW_PATH, node));
+    if (uevent.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QString hidId = QString("HID_ID=0003:%1:%2").arg(vid, 8, 16, QChar('0')).arg(pid, 8, 16, QChar('0')).toUpper();  // The bus type is always 0003 (USB)
+        const QStringList lines = QString::fromLatin1(uevent.readAll()).split('\n');
+        for (const QString &line : lines) {
+            if (line.toUpper() == hidId) {
+                idMatches = true;
+            } else if (line.startsWith("HID_UNIQ=")) {
+                serial = line.mid(9);
+            }
+        }
+        uevent.close();
+    }
+    return idMatches;
+}
+
+HidrawTransport::HidrawTransport() :
+    fd_(-1)
+{
+}
+
+HidrawTransport::~HidrawTransport()
+{
+    close();  // Required so the device can be freed when the transport is destroyed
+}
+
+// Checks if the device is open
+bool HidrawTransport::isOpen() const
+{
+    return fd_ >= 0;  // Returns true if the device is open, or false otherwise
+}
+
+// Closes the device safely, if open
+void HidrawTransport::close()
+{
+    if (isOpen()) {
+        ::close(fd_);  // This also releases the advisory lock
+        fd_ = -1;  // Required to mark the device as closed
+    }
+}
+
+// Performs an interrupt transfer, returning the equivalent libusb result
+// OUT transfers are written as output reports (preceded by a zero report ID, since the MCP2210 does not use numbered reports), while IN transfers wait for an input report for up to the given timeout
+int HidrawTransport::interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    int result = LIBUSB_SUCCESS;
+    ssize_t bytes = 0;
+    if (length > REPORT_MAXSIZE) {
+        result = LIBUSB_ERROR_INVALID_PARAM;
+    } else if (endpointAddr < 0x80) {  // OUT direction
+        unsigned char report[REPORT_MAXSIZE + 1];
+        report[0] = 0x00;  // Report ID
+        std::memcpy(report + 1, data, static_cast<size_t>(length));
+        do {
+            bytes = write(fd_, report, static_cast<size_t>(length + 1));
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes < 0) {
+            result = errno == ENODEV ? LIBUSB_ERROR_NO_DEVICE : LIBUSB_ERROR_IO;
+            bytes = 0;
+        } else {
+            bytes = bytes > 0 ? bytes - 1 : 0;  // The report ID does not count as transferred data
+        }
+    } else {  // IN direction
+        pollfd pfd;
+        pfd.fd = fd_;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ready;
+        do {
+            ready = poll(&pfd, 1, static_cast<int>(timeout));
+        } while (ready < 0 && errno == EINTR);
+        if (ready < 0) {
+            result = LIBUSB_ERROR_IO;
+        } else if (ready == 0) {
+            result = LIBUSB_ERROR_TIMEOUT;
+        } else if ((pfd.revents & POLLIN) == 0) {  // POLLERR or POLLHUP without data, which happens when the device is unplugged
+            result = LIBUSB_ERROR_NO_DEVICE;
+        } else {
+            do {
+                bytes = read(fd_, data, static_cast<size_t>(length));
+            } while (bytes < 0 && errno == EINTR);
+            if (bytes < 0) {
+                result = errno == ENODEV ? LIBUSB_ERROR_NO_DEVICE : LIBUSB_ERROR_IO;
+                bytes = 0;
+            }
+        }
+    }
+    if (transferred != nullptr) {
+        *transferred = static_cast<int>(bytes);
+    }
+    return result;
+}
+
+// Lists the serial numbers of all devices having the given VID and PID, as reported by sysfs (no access to the device nodes is required)
+QStringList HidrawTransport::listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr)
+{
+    QStringList devices;
+    QDir sysfsDir(SYSFS_HIDRAW_PATH);
+    if (!sysfsDir.exists()) {
+        ++errcnt;
+        errstr += QObject::tr("Failed to retrieve a list of devices.\n");
+    } else {
+        const QStringList nodes = sysfsDir.entryList(QDir::Dirs | QDir::System | QDir::NoDotAndDotDot, QDir::Name);
+        for (const QString &node : nodes) {
+            QString uniq;
+            if (readNodeInfo(node, vid, pid, uniq)) {
+                devices += uniq;  // Append the serial number string to the list
+            }
+        }
+    }
+    return devices;
+}
+
+// Opens the device having the given VID, PID and, optionally, the given serial number
+// An exclusive advisory lock is taken on the device node, so that the device cannot be used concurrently by another process that also uses this transport
+int HidrawTransport::open(quint16 vid, quint16 pid, const QString &serial)
+{
+    int retval;
+    if (isOpen()) {  // Just in case the calling algorithm tries to open a device that was already sucessfully open
+        retval = MCP2210::SUCCESS;
+    } else {
+        QString devicePath = findDevice(vid, pid, serial);
+        if (devicePath.isEmpty()) {
+            retval = MCP2210::ERROR_NOT_FOUND;
+        } else {
+            fd_ = ::open(QFile::encodeName(devicePath).constData(), O_RDWR | O_CLOEXEC);
+            if (fd_ < 0) {  // Typically, this fails due to insufficient permissions
+                if (errno == EACCES || errno == EPERM) {
+                    retval = MCP2210::ERROR_ACCESS;
+                } else if (errno == ENOENT || errno == ENODEV) {  // The device was removed meanwhile
+                    retval = MCP2210::ERROR_NOT_FOUND;
+                } else {
+                    retval = MCP2210::ERROR_BUSY;
+                }
+            } else if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {  // Failed to lock the device node, since it is in use
+                ::close(fd_);
+                fd_ = -1;  // Required to mark the device as closed
+                retval = MCP2210::ERROR_BUSY;
+            } else {
+                unsigned char stale[REPORT_MAXSIZE];
+                pollfd pfd;
+                pfd.fd = fd_;
+                pfd.events = POLLIN;
+                pfd.revents = 0;
+                while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) != 0 && read(fd_, stale, sizeof(stale)) > 0) {  // Discard any input reports that might have been queued before opening (e.g., a late response to a previous session)
+                    pfd.revents = 0;
+                }
+                retval = MCP2210::SUCCESS;
+            }
+        }
+    }
+    return retval;
+}
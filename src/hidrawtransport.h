@@ -0,0 +1,51 @@
+/* Hidraw transport for the MCP2210 class for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef HIDRAWTRANSPORT_H
+#define HIDRAWTRANSPORT_H
+
+// Includes
+#include <QString>
+#include <QStringList>
+#include "mcp2210transport.h"
+
+// Transport that uses the Linux "/dev/hidraw*" character devices, by means of plain read(), write() and poll() calls
+// Unlike the libusb transport, this one does not require the kernel HID driver to be detached, and only needs access to the hidraw device node
+class HidrawTransport : public MCP2210Transport
+{
+private:
+    int fd_;
+
+    QString findDevice(quint16 vid, quint16 pid, const QString &serial);
+    bool readNodeInfo(const QString &node, quint16 vid, quint16 pid, QString &serial);
+
+public:
+    HidrawTransport();
+    ~HidrawTransport();
+
+    bool isOpen() const;
+
+    void close();
+    int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout);
+    QStringList listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr);
+    int open(quint16 vid, quint16 pid, const QString &serial);
+};
+
+#endif  // HIDRAWTRANSPORT_H
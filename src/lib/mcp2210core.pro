@@ -0,0 +1,42 @@
+# Standalone MCP2210 core library, intended for headless applications and
+# daemons that need to access MCP2210 devices without linking to Qt GUI
+# modules (only QtCore, QtNetwork and libusb are required)
+
+QT       += core
+QT       -= gui
+
+# Added to provide backwards compatibility (C++11 support)
+greaterThan(QT_MAJOR_VERSION, 4) {
+    CONFIG += c++11
+} else {
+    QMAKE_CXXFLAGS += -std=c++11
+}
+
+TARGET = mcp2210core
+TEMPLATE = lib
+VERSION = 1.0.0
+
+# A static library is built by default, which is what the application, the
+# daemon and the benchmark tools link against (see "mcp2210corelib.pri")
+# Invoke "qmake CONFIG+=mcp2210core_shared" in order to build a shared library
+# instead (this option must also be given when building the applications that
+# link against it, which is the case if given to the top-level project)
+!mcp2210core_shared: CONFIG += staticlib
+CONFIG += create_prl
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../mcp2210core.pri)
+
+# Added installation option
+unix {
+    isEmpty(PREFIX) {
+        PREFIX = /usr/local
+    }
+    target.path = $$PREFIX/lib
+    headers.files = $$CORE_HEADERS
+    headers.path = $$PREFIX/include/mcp2210
+    INSTALLS += headers
+}
+
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,351 @@
+/* MCP2210 libusb event thread for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cerrno>
+#include <cstring>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include "libusbeventthread.h"
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+// Definitions
+const long EVENT_TIMEOUT = 100000;  // Timeout for each iteration of the event loop, in microseconds
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+const Qt::SplitBehavior SKIP_EMPTY_PARTS = Qt::SkipEmptyParts;  // QString::SkipEmptyParts is deprecated since Qt 5.14
+#else
+const QString::SplitBehavior SKIP_EMPTY_PARTS = QString::SkipEmptyParts;
+#endif
+
+// Latency histogram, in microseconds, using the same buckets as MCP2210Stats
+struct LatencyHistogram {
+    QAtomicInteger<quint64> buckets[MCP2210Stats::HISTOGRAM_BUCKETS];
+    QAtomicInteger<quint64> count, sum;
+};
+
+// Completion state of a transfer, shared between the calling thread and the event thread
+struct Completion {
+    QSemaphore done;
+    qint64 timestamp;  // Time at which the transfer callback was invoked, in nanoseconds (see "monotonicClock")
+};
+
+// Static variables
+static QElapsedTimer monotonicClock;       // Clock shared by all threads, started once the event thread is first configured
+static LatencyHistogram handoffHistogram;  // Time taken by callers to resume after their transfers complete
+static LatencyHistogram wakeupHistogram;   // Time taken by the event thread to resume after its event loop times out, beyond the timeout itself
+
+QMutex LibusbEventThread::mutex_;
+LibusbEventThread *LibusbEventThread::instance_ = nullptr;
+int LibusbEventThread::users_ = 0;
+bool LibusbEventThread::configured_ = false;
+bool LibusbEventThread::enabled_ = false;
+LibusbEventThread::Options LibusbEventThread::configuredOptions_ = {0, -1, false};
+
+// Copies the given latency histogram into a plain histogram
+static MCP2210Stats::Histogram copyLatencies(const LatencyHistogram &source)
+{
+    MCP2210Stats::Histogram histogram;
+    for (int i = 0; i < MCP2210Stats::HISTOGRAM_BUCKETS; ++i) {
+        histogram.buckets[i] = source.buckets[i].load();
+    }
+    histogram.count = source.count.load();
+    histogram.sum = source.sum.load();
+    return histogram;
+}
+
+// Records the given latency, in nanoseconds, into the given histogram
+static void recordLatency(LatencyHistogram &histogram, qint64 latency)
+{
+    quint64 value = latency < 0 ? 0 : static_cast<quint64>(latency / 1000);  // Conversion to microseconds
+    histogram.buckets[MCP2210Stats::bucketIndex(value)].fetchAndAddRelaxed(1);
+    histogram.count.fetchAndAddRelaxed(1);
+    histogram.sum.fetchAndAddRelaxed(value);
+}
+
+// Clears the given latency histogram
+static void resetLatencies(LatencyHistogram &histogram)
+{
+    for (int i = 0; i < MCP2210Stats::HISTOGRAM_BUCKETS; ++i) {
+        histogram.buckets[i].store(0);
+    }
+    histogram.count.store(0);
+    histogram.sum.store(0);
+}
+
+// Callback invoked by the event thread once a transfer completes, fails or times out
+static void LIBUSB_CALL transferCallback(libusb_transfer *transfer)
+{
+    Completion *completion = static_cast<Completion *>(transfer->user_data);
+    completion->timestamp = monotonicClock.nsecsElapsed();
+    completion->done.release();  // Wakes up the calling thread
+}
+
+// "Equal to" operator for Options
+bool LibusbEventThread::Options::operator ==(const LibusbEventThread::Options &other) const
+{
+    return priority == other.priority && cpu == other.cpu && lockMemory == other.lockMemory;
+}
+
+// "Not equal to" operator for Options
+bool LibusbEventThread::Options::operator !=(const LibusbEventThread::Options &other) const
+{
+    return !(operator ==(other));
+}
+
+// Private constructor, used by acquire() (the event thread takes ownership of the given libusb context)
+LibusbEventThread::LibusbEventThread(libusb_context *context, const Options &options) :
+    context_(context),
+    options_(options),
+    stopping_(0)
+{
+}
+
+// Private function that is used to read the configuration given by the environment variable "MCP2210_EVENT_THREAD", only once
+// The variable holds a comma-separated list of options, such as "on", "fifo=<priority>", "cpu=<number>" and "mlock" (e.g. "fifo=50,cpu=3,mlock")
+// Any value other than empty, "0" or "off" enables the event thread
+void LibusbEventThread::configure()
+{
+    if (!configured_) {
+        configured_ = true;
+        monotonicClock.start();
+        QString value = QString::fromLatin1(qgetenv("MCP2210_EVENT_THREAD")).trimmed().toLower();
+        enabled_ = !value.isEmpty() && value != "0" && value != "off";
+        const QStringList tokens = value.split(',', SKIP_EMPTY_PARTS);
+        for (const QString &token : tokens) {
+            QString option = token.trimmed();
+            if (option.startsWith("fifo=")) {
+                configuredOptions_.priority = qBound(0, option.mid(5).toInt(), 99);
+            } else if (option.startsWith("cpu=")) {
+                bool ok;
+                int cpu = option.mid(4).toInt(&ok);
+                configuredOptions_.cpu = ok ? cpu : -1;
+            } else if (option == "mlock") {
+                configuredOptions_.lockMemory = true;
+            }
+        }
+    }
+}
+
+// Runs the libusb event loop until the event thread is stopped, after applying the scheduling options
+void LibusbEventThread::run()
+{
+#ifdef Q_OS_LINUX
+    if (options_.priority > 0) {
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = options_.priority;
+        int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (result != 0) {  // Typically, this fails due to the lack of the "CAP_SYS_NICE" capability or of an adequate "RLIMIT_RTPRIO" limit
+            setupError_ += QObject::tr("Could not set SCHED_FIFO priority %1 for the libusb event thread: %2.\n").arg(options_.priority).arg(QString::fromLocal8Bit(std::strerror(result)));
+        }
+    }
+    if (options_.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options_.cpu, &cpus);
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (result != 0) {
+            setupError_ += QObject::tr("Could not pin the libusb event thread to CPU %1: %2.\n").arg(options_.cpu).arg(QString::fromLocal8Bit(std::strerror(result)));
+        }
+    }
+#endif
+    ready_.release();  // Setup is complete, so acquire() can return
+    while (stopping_.loadAcquire() == 0) {
+        timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = EVENT_TIMEOUT;
+        qint64 start = monotonicClock.nsecsElapsed();
+        libusb_handle_events_timeout_completed(context_, &tv, nullptr);
+        qint64 elapsed = monotonicClock.nsecsElapsed() - start;
+        if (elapsed >= 1000 * EVENT_TIMEOUT) {  // The loop timed out, so any excess time corresponds to the wakeup latency of the event thread
+            recordLatency(wakeupHistogram, elapsed - 1000 * EVENT_TIMEOUT);
+        }
+    }
+}
+
+// Stops the event thread and deinitializes libusb (all devices using the shared context must have been closed by then)
+LibusbEventThread::~LibusbEventThread()
+{
+    stopping_.storeRelease(1);
+#if LIBUSB_API_VERSION >= 0x01000105
+    libusb_interrupt_event_handler(context_);  // Wakes up the event loop immediately
+#endif
+    wait();  // Otherwise, the event loop stops after the current iteration times out
+    libusb_exit(context_);
+}
+
+// Returns the shared libusb context
+libusb_context *LibusbEventThread::context() const
+{
+    return context_;
+}
+
+// Returns a description of any scheduling options that could not be applied (empty if all were applied)
+QString LibusbEventThread::setupError() const
+{
+    return setupError_;
+}
+
+// Performs an interrupt transfer asynchronously, and sleeps until the event thread completes it, returning the libusb result
+// The results are equivalent to those of libusb_interrupt_transfer()
+int LibusbEventThread::interruptTransfer(libusb_device_handle *handle, quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    int result;
+    if (transferred != nullptr) {
+        *transferred = 0;
+    }
+    libusb_transfer *transfer = libusb_alloc_transfer(0);
+    if (transfer == nullptr) {
+        result = LIBUSB_ERROR_NO_MEM;
+    } else {
+        Completion completion;
+        libusb_fill_interrupt_transfer(transfer, handle, endpointAddr, data, length, transferCallback, &completion, timeout);
+        result = libusb_submit_transfer(transfer);
+        if (result == 0) {
+            completion.done.acquire();
+            recordLatency(handoffHistogram, monotonicClock.nsecsElapsed() - completion.timestamp);
+            switch (transfer->status) {
+                case LIBUSB_TRANSFER_COMPLETED:
+                    result = 0;
+                    break;
+                case LIBUSB_TRANSFER_TIMED_OUT:
+                    result = LIBUSB_ERROR_TIMEOUT;
+                    break;
+                case LIBUSB_TRANSFER_STALL:
+                    result = LIBUSB_ERROR_PIPE;
+                    break;
+                case LIBUSB_TRANSFER_NO_DEVICE:
+                    result = LIBUSB_ERROR_NO_DEVICE;
+                    break;
+                case LIBUSB_TRANSFER_OVERFLOW:
+                    result = LIBUSB_ERROR_OVERFLOW;
+                    break;
+                default:  // "LIBUSB_TRANSFER_ERROR" or "LIBUSB_TRANSFER_CANCELLED"
+                    result = LIBUSB_ERROR_IO;
+            }
+            if (transferred != nullptr) {
+                *transferred = transfer->actual_length;
+            }
+        }
+        libusb_free_transfer(transfer);
+    }
+    return result;
+}
+
+// Returns a reference to the event thread, starting it if not running, or a null pointer if libusb could not be initialized
+// Each successful call must be balanced by a call to release()
+LibusbEventThread *LibusbEventThread::acquire()
+{
+    QMutexLocker locker(&mutex_);
+    configure();
+    if (instance_ == nullptr) {
+        libusb_context *context;
+        if (libusb_init(&context) == 0) {
+            instance_ = new LibusbEventThread(context, configuredOptions_);
+#ifdef Q_OS_LINUX
+            if (configuredOptions_.lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {  // Applies to the whole process
+                instance_->setupError_ += QObject::tr("Could not lock the process memory: %1.\n").arg(QString::fromLocal8Bit(std::strerror(errno)));
+            }
+#endif
+            instance_->start();
+            instance_->ready_.acquire();
+        }
+    }
+    if (instance_ != nullptr) {
+        ++users_;
+    }
+    return instance_;
+}
+
+// Returns the distribution of the time taken by callers to resume after their transfers are completed by the event thread, in microseconds
+MCP2210Stats::Histogram LibusbEventThread::handoffLatency()
+{
+    return copyLatencies(handoffHistogram);
+}
+
+// Checks if the event thread is enabled, in which case LibusbTransport uses it for newly opened devices
+bool LibusbEventThread::isEnabled()
+{
+    QMutexLocker locker(&mutex_);
+    configure();
+    return enabled_;
+}
+
+// Returns the options applied whenever the event thread starts
+LibusbEventThread::Options LibusbEventThread::options()
+{
+    QMutexLocker locker(&mutex_);
+    configure();
+    return configuredOptions_;
+}
+
+// Releases a reference obtained via acquire(), stopping the event thread once no references are left
+void LibusbEventThread::release()
+{
+    QMutexLocker locker(&mutex_);
+    if (users_ > 0) {
+        --users_;
+        if (users_ == 0) {
+            delete instance_;
+            instance_ = nullptr;
+        }
+    }
+}
+
+// Clears the latency statistics
+void LibusbEventThread::resetLatencies()
+{
+    ::resetLatencies(handoffHistogram);
+    ::resetLatencies(wakeupHistogram);
+}
+
+// Enables or disables the event thread, overriding the environment variable "MCP2210_EVENT_THREAD"
+// This only affects devices opened afterwards
+void LibusbEventThread::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&mutex_);
+    configure();
+    enabled_ = enabled;
+}
+
+// Sets the options to be applied whenever the event thread starts, overriding the environment variable "MCP2210_EVENT_THREAD"
+// This has no effect on an event thread that is already running
+void LibusbEventThread::setOptions(const Options &options)
+{
+    QMutexLocker locker(&mutex_);
+    configure();
+    configuredOptions_ = options;
+}
+
+// Returns the distribution of the time taken by the event thread to wake up, beyond the timeout of its event loop, in microseconds
+// This reflects the scheduling jitter experienced by the event thread
+MCP2210Stats::Histogram LibusbEventThread::wakeupLatency()
+{
+    return copyLatencies(wakeupHistogram);
+}
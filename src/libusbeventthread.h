@@ -0,0 +1,92 @@
+/* MCP2210 libusb event thread for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef LIBUSBEVENTTHREAD_H
+#define LIBUSBEVENTTHREAD_H
+
+// Includes
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+#include <libusb-1.0/libusb.h>
+#include "mcp2210stats.h"
+
+// Dedicated I/O thread that runs the libusb event loop for all devices opened via LibusbTransport, using a shared libusb context
+// Transfers are submitted asynchronously, and the calling thread sleeps until the event thread completes them, so that event handling is never subject to the scheduling of the callers
+// For latency-critical deployments, the event thread can run with "SCHED_FIFO" priority and be pinned to a given CPU, and the process memory can be locked
+// The event thread is used only if enabled (see setEnabled()), either programmatically or via the environment variable "MCP2210_EVENT_THREAD"
+class LibusbEventThread : public QThread
+{
+public:
+    struct Options {
+        int priority;     // "SCHED_FIFO" priority, between 1 and 99 (zero for the default scheduling policy)
+        int cpu;          // CPU to which the event thread is pinned (-1 for no pinning)
+        bool lockMemory;  // Lock all current and future process memory, via mlockall()
+
+        bool operator ==(const Options &other) const;
+        bool operator !=(const Options &other) const;
+    };
+
+private:
+    libusb_context *context_;
+    Options options_;
+    QAtomicInteger<int> stopping_;
+    QSemaphore ready_;
+    QString setupError_;
+
+    LibusbEventThread(libusb_context *context, const Options &options);
+
+    static QMutex mutex_;
+    static LibusbEventThread *instance_;
+    static int users_;
+    static bool configured_;
+    static bool enabled_;
+    static Options configuredOptions_;
+
+    static void configure();
+
+protected:
+    void run();
+
+public:
+    LibusbEventThread(const LibusbEventThread &) = delete;
+    ~LibusbEventThread();
+
+    LibusbEventThread &operator =(const LibusbEventThread &) = delete;
+
+    libusb_context *context() const;
+    QString setupError() const;
+
+    int interruptTransfer(libusb_device_handle *handle, quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout);
+
+    static LibusbEventThread *acquire();
+    static MCP2210Stats::Histogram handoffLatency();
+    static bool isEnabled();
+    static Options options();
+    static void release();
+    static void resetLatencies();
+    static void setEnabled(bool enabled);
+    static void setOptions(const Options &options);
+    static MCP2210Stats::Histogram wakeupLatency();
+};
+
+#endif  // LIBUSBEVENTTHREAD_H
@@ -0,0 +1,245 @@
+/* Libusb transport for the MCP2210 class for Qt - Version 1.0.0
+   Copyright (c) 2022-2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QObject>
+#include "libusbeventthread.h"
+#include "libusbtransport.h"
+#include "mcp2210.h"
+extern "C" {
+#include "libusb-extra.h"
+}
+
+LibusbTransport::LibusbTransport() :
+    context_(nullptr),
+    handle_(nullptr),
+    eventThread_(nullptr),
+    kernelWasAttached_(false)
+{
+}
+
+LibusbTransport::~LibusbTransport()
+{
+    close();  // Required so the device can be freed when the transport is destroyed
+}
+
+// Private function that deinitializes libusb, or releases the shared event thread if it was used
+void LibusbTransport::exitContext()
+{
+    if (eventThread_ == nullptr) {
+        libusb_exit(context_);  // Deinitialize libusb
+    } else {
+        LibusbEventThread::release();  // The shared context is only deinitialized when the last device using it is closed
+        eventThread_ = nullptr;
+    }
+    context_ = nullptr;
+}
+
+// Private function that initializes libusb, or obtains the context of the shared event thread if it is enabled (see LibusbEventThread for details)
+bool LibusbTransport::initContext()
+{
+    bool retval;
+    if (LibusbEventThread::isEnabled()) {
+        eventThread_ = LibusbEventThread::acquire();
+        context_ = eventThread_ == nullptr ? nullptr : eventThread_->context();
+        retval = eventThread_ != nullptr;
+    } else {
+        retval = libusb_init(&context_) == 0;
+    }
+    return retval;
+}
+
+// Returns the libusb context, which is only valid while the device is open (useful for asynchronous I/O)
+libusb_context *LibusbTransport::context() const
+{
+    return context_;
+}
+
+// Returns the libusb device handle, or a null pointer if the device is not open (useful for asynchronous I/O)
+libusb_device_handle *LibusbTransport::handle() const
+{
+    return handle_;
+}
+
+// Checks if the device is open
+bool LibusbTransport::isOpen() const
+{
+    return handle_ != nullptr;  // Returns true if the device is open, or false otherwise
+}
+
+// Closes the device safely, if open
+void LibusbTransport::close()
+{
+    if (isOpen()) {  // This condition avoids a segmentation fault if the calling algorithm tries, for some reason, to close the same device twice (e.g., if the device is already closed when the destructor is called)
+        libusb_release_interface(handle_, 0);  // Release the interface
+        if (kernelWasAttached_) {  // If a kernel driver was attached to the interface before
+            libusb_attach_kernel_driver(handle_, 0);  // Reattach the kernel driver
+        }
+        libusb_close(handle_);  // Close the device
+        exitContext();  // Deinitialize libusb
+        handle_ = nullptr;  // Required to mark the device as closed
+    }
+}
+
+// Enumerates the devices having the given VID and PID, obtaining their locations, addresses and USB strings
+// Only devices that are not known (i.e. new or attached again) are opened to read their strings, so that periodic enumerations do not open every device each time
+QVector<MCP2210Transport::DeviceInfo> LibusbTransport::enumerateDevices(quint16 vid, quint16 pid, const QVector<DeviceInfo> &known, int &errcnt, QString &errstr)
+{
+    QVector<DeviceInfo> devices;
+    libusb_context *context;
+    if (libusb_init(&context) != 0) {  // Initialize libusb. In case of failure
+        ++errcnt;
+        errstr += QObject::tr("Could not initialize libusb.\n");
+    } else {  // If libusb is initialized
+        libusb_device **devs;
+        ssize_t devlist = libusb_get_device_list(context, &devs);  // Get a device list
+        if (devlist < 0) {  // If the previous operation fails to get a device list
+            ++errcnt;
+            errstr += QObject::tr("Failed to retrieve a list of devices.\n");
+        } else {
+            for (ssize_t i = 0; i < devlist; ++i) {  // Run through all listed devices
+                libusb_device_descriptor desc;
+                if (libusb_get_device_descriptor(devs[i], &desc) == 0 && desc.idVendor == vid && desc.idProduct == pid) {  // If the device descriptor is retrieved, and both VID and PID correspond to the respective given values
+                    DeviceInfo device;
+                    device.path = QString::number(libusb_get_bus_number(devs[i]));
+                    uint8_t ports[7];  // As per the USB 3.0 specification, the maximum hub depth is 7
+                    int portCount = libusb_get_port_numbers(devs[i], ports, static_cast<int>(sizeof(ports)));
+                    for (int j = 0; j < portCount; ++j) {
+                        device.path += QString(j == 0 ? "-%1" : ".%1").arg(ports[j]);
+                    }
+                    device.address = libusb_get_device_address(devs[i]);
+                    bool found = false;
+                    for (const DeviceInfo &knownDevice : known) {
+                        if (knownDevice.path == device.path && knownDevice.address == device.address) {  // The device was not attached again since, so its strings are still the same
+                            device = knownDevice;
+                            found = true;
+                            break;
+                        }
+                    }
+                    libusb_device_handle *handle;
+                    if (found) {
+                        devices += device;
+                    } else if (libusb_open(devs[i], &handle) == 0) {  // Open the listed device, in order to read its strings. If successfull
+                        unsigned char str_desc[256];
+                        uint8_t indexes[3] = {desc.iSerialNumber, desc.iManufacturer, desc.iProduct};
+                        QString *strings[3] = {&device.serial, &device.manufacturer, &device.product};
+                        for (int j = 0; j < 3; ++j) {
+                            if (indexes[j] != 0 && libusb_get_string_descriptor_ascii(handle, indexes[j], str_desc, static_cast<int>(sizeof(str_desc))) >= 0) {  // Get each string in ASCII format
+                                *strings[j] = reinterpret_cast<char *>(str_desc);
+                            }
+                        }
+                        devices += device;
+                        libusb_close(handle);  // Close the device
+                    }
+                }
+            }
+            libusb_free_device_list(devs, 1);  // Free device list
+        }
+        libusb_exit(context);  // Deinitialize libusb
+    }
+    return devices;
+}
+
+// Performs an interrupt transfer, returning the libusb result
+// If the event thread is in use, the transfer is completed by that thread, while the calling thread sleeps
+int LibusbTransport::interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    int retval;
+    if (eventThread_ == nullptr) {
+        retval = libusb_interrupt_transfer(handle_, endpointAddr, data, length, transferred, timeout);
+    } else {
+        retval = eventThread_->interruptTransfer(handle_, endpointAddr, data, length, transferred, timeout);
+    }
+    return retval;
+}
+
+// Lists the serial numbers of all devices having the given VID and PID
+QStringList LibusbTransport::listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr)
+{
+    QStringList devices;
+    libusb_context *context;
+    if (libusb_init(&context) != 0) {  // Initialize libusb. In case of failure
+        ++errcnt;
+        errstr += QObject::tr("Could not initialize libusb.\n");
+    } else {  // If libusb is initialized
+        libusb_device **devs;
+        ssize_t devlist = libusb_get_device_list(context, &devs);  // Get a device list
+        if (devlist < 0) {  // If the previous operation fails to get a device list
+            ++errcnt;
+            errstr += QObject::tr("Failed to retrieve a list of devices.\n");
+        } else {
+            for (ssize_t i = 0; i < devlist; ++i) {  // Run through all listed devices
+                libusb_device_descriptor desc;
+                if (libusb_get_device_descriptor(devs[i], &desc) == 0 && desc.idVendor == vid && desc.idProduct == pid) {  // If the device descriptor is retrieved, and both VID and PID correspond to the respective given values
+                    libusb_device_handle *handle;
+                    if (libusb_open(devs[i], &handle) == 0) {  // Open the listed device. If successfull
+                        unsigned char str_desc[256];
+                        libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, str_desc, static_cast<int>(sizeof(str_desc)));  // Get the serial number string in ASCII format
+                        devices += reinterpret_cast<char *>(str_desc);  // Append the serial number string to the list
+                        libusb_close(handle);  // Close the device
+                    }
+                }
+            }
+            libusb_free_device_list(devs, 1);  // Free device list
+        }
+        libusb_exit(context);  // Deinitialize libusb
+    }
+    return devices;
+}
+
+// Opens the device having the given VID, PID and, optionally, the given serial number, and assigns its handle
+int LibusbTransport::open(quint16 vid, quint16 pid, const QString &serial)
+{
+    int retval;
+    if (isOpen()) {  // Just in case the calling algorithm tries to open a device that was already sucessfully open, or tries to open different devices concurrently, all while using (or referencing to) the same object
+        retval = MCP2210::SUCCESS;
+    } else if (!initContext()) {  // Initialize libusb. In case of failure
+        retval = MCP2210::ERROR_INIT;
+    } else {  // If libusb is initialized
+        if (serial.isNull()) {  // Note that serial, by omission, is a null QString
+            handle_ = libusb_open_device_with_vid_pid(context_, vid, pid);  // If no serial number is specified, this will open the first device found with matching VID and PID
+        } else {
+            handle_ = libusb_open_device_with_vid_pid_serial(context_, vid, pid, reinterpret_cast<unsigned char *>(serial.toLatin1().data()));
+        }
+        if (handle_ == nullptr) {  // If the previous operation fails to get a device handle
+            exitContext();  // Deinitialize libusb
+            retval = MCP2210::ERROR_NOT_FOUND;
+        } else {  // If the device is successfully opened and a handle obtained
+            if (libusb_kernel_driver_active(handle_, 0) == 1) {  // If a kernel driver is active on the interface
+                libusb_detach_kernel_driver(handle_, 0);  // Detach the kernel driver
+                kernelWasAttached_ = true;  // Flag that the kernel driver was attached
+            } else {
+                kernelWasAttached_ = false;  // The kernel driver was not attached
+            }
+            if (libusb_claim_interface(handle_, 0) != 0) {  // Claim the interface. In case of failure
+                if (kernelWasAttached_) {  // If a kernel driver was attached to the interface before
+                    libusb_attach_kernel_driver(handle_, 0);  // Reattach the kernel driver
+                }
+                libusb_close(handle_);  // Close the device
+                exitContext();  // Deinitialize libusb
+                handle_ = nullptr;  // Required to mark the device as closed
+                retval = MCP2210::ERROR_BUSY;
+            } else {
+                retval = MCP2210::SUCCESS;
+            }
+        }
+    }
+    return retval;
+}
@@ -0,0 +1,60 @@
+/* Libusb transport for the MCP2210 class for Qt - Version 1.0.0
+   Copyright (c) 2022-2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef LIBUSBTRANSPORT_H
+#define LIBUSBTRANSPORT_H
+
+// Includes
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <libusb-1.0/libusb.h>
+#include "mcp2210transport.h"
+
+// Forward declarations
+class LibusbEventThread;
+
+class LibusbTransport : public MCP2210Transport
+{
+private:
+    libusb_context *context_;
+    libusb_device_handle *handle_;
+    LibusbEventThread *eventThread_;
+    bool kernelWasAttached_;
+
+    void exitContext();
+    bool initContext();
+
+public:
+    LibusbTransport();
+    ~LibusbTransport();
+
+    libusb_context *context() const;
+    libusb_device_handle *handle() const;
+    bool isOpen() const;
+
+    void close();
+    QVector<DeviceInfo> enumerateDevices(quint16 vid, quint16 pid, const QVector<DeviceInfo> &known, int &errcnt, QString &errstr);
+    int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout);
+    QStringList listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr);
+    int open(quint16 vid, quint16 pid, const QString &serial);
+};
+
+#endif  // LIBUSBTRANSPORT_H
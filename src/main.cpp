@@ -20,9 +20,11 @@
 
 // Includes
 #include <QApplication>
+#include <QFile>
 #include <QLocale>
 #include <QTranslator>
 #include "mainwindow.h"
+#include "mcp2210tracer.h"
 
 int main(int argc, char *argv[])
 {
@@ -32,7 +34,16 @@ int main(int argc, char *argv[])
         translator.load("mcp2210-conf_en_US", ":/translations/translations");  // Fall back to the en-US translation
     }
     a.installTranslator(&translator);
-    MainWindow w;
-    w.show();
-    return a.exec();
+    QString traceFile = QFile::decodeName(qgetenv("MCP2210_TRACE"));
+    if (!traceFile.isEmpty()) {  // Device operations are traced to the given file, if the environment variable "MCP2210_TRACE" is set
+        MCP2210Tracer::start(traceFile);
+    }
+    int retval;
+    {
+        MainWindow w;
+        w.show();
+        retval = a.exec();
+    }
+    MCP2210Tracer::stop();  // The main window, along with any open device windows, must be destroyed first
+    return retval;
 }
@@ -19,30 +19,62 @@
 
 
 // Includes
+#include <QHeaderView>
+#include <QItemSelectionModel>
 #include <QMessageBox>
+#include <QModelIndexList>
 #include <QRegExp>
 #include <QRegExpValidator>
-#include <QStringList>
 #include "common.h"
-#include "mcp2210.h"
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
 // Definitions
-const int CENTRAL_HEIGHT = 171;
+const int BUTTONS_OFFSET = 41;  // Distance from the top of the buttons to the bottom of the central widget
+const int OPEN_TIMEOUT = 2000;  // Time to wait for a device in use by another tool to be released, in milliseconds
+const int ROW_HEIGHT = 24;
+const int TABLE_OFFSET = 50;  // Distance from the bottom of the device table to the bottom of the central widget
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    deviceTableModel_(new DeviceTableModel(this)),
+    deviceInventoryWorker_(new DeviceInventoryWorker),  // The worker has no parent, since it lives in its own thread
+    enumerationFailing_(false)
 {
     ui->setupUi(this);
     ui->lineEditVID->setValidator(new QRegExpValidator(QRegExp("[A-Fa-f\\d]+"), this));
     ui->lineEditPID->setValidator(new QRegExpValidator(QRegExp("[A-Fa-f\\d]+"), this));
+    ui->tableViewDevices->setModel(deviceTableModel_);
+    ui->tableViewDevices->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);  // Uniform row heights spare the view from measuring each row, which keeps scrolling smooth with hundreds of devices
+    ui->tableViewDevices->verticalHeader()->setDefaultSectionSize(ROW_HEIGHT);
+    ui->tableViewDevices->verticalHeader()->hide();
+    ui->tableViewDevices->horizontalHeader()->setStretchLastSection(true);
     ui->lineEditVID->setFocus();
+    qRegisterMetaType<DeviceInventoryWorker::Details>("DeviceInventoryWorker::Details");
+    qRegisterMetaType<QVector<MCP2210Transport::DeviceInfo>>("QVector<MCP2210Transport::DeviceInfo>");
+    deviceInventoryWorker_->moveToThread(&workerThread_);
+    connect(&workerThread_, &QThread::finished, deviceInventoryWorker_, &QObject::deleteLater);
+    connect(this, &MainWindow::targetChanged, deviceInventoryWorker_, &DeviceInventoryWorker::setTarget);
+    connect(this, &MainWindow::refreshRequested, deviceInventoryWorker_, &DeviceInventoryWorker::enumerate);
+    connect(this, &MainWindow::stopRequested, deviceInventoryWorker_, &DeviceInventoryWorker::stop);
+    connect(deviceTableModel_, &DeviceTableModel::detailsRequested, deviceInventoryWorker_, &DeviceInventoryWorker::requestDetails);
+    connect(deviceInventoryWorker_, &DeviceInventoryWorker::devicesEnumerated, this, [this](quint16 vid, quint16 pid, const QVector<MCP2210Transport::DeviceInfo> &devices) {
+        enumerationFailing_ = false;  // A later failure is reported again
+        if (ui->tableViewDevices->isEnabled() && vid == vid_ && pid == pid_) {  // Enumerations that were queued before the target changed are discarded
+            deviceTableModel_->setDevices(vid, pid, devices);
+        }
+    });
+    connect(deviceInventoryWorker_, &DeviceInventoryWorker::detailsFetched, deviceTableModel_, &DeviceTableModel::setDetails);
+    connect(deviceInventoryWorker_, &DeviceInventoryWorker::errorOccurred, this, &MainWindow::handleEnumerationError);
+    connect(ui->tableViewDevices->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::updateButtons);
+    workerThread_.start();
 }
 
 MainWindow::~MainWindow()
 {
+    workerThread_.quit();  // Any detail fetch that is ongoing is completed first
+    workerThread_.wait();
     delete ui;
 }
 
@@ -52,20 +84,30 @@ void MainWindow::closeEvent(QCloseEvent *event)
     closeAboutDialog();  // See "common.h" and "common.cpp"
 }
 
+// The window can be resized vertically, so that the device table shows as many rows as the screen allows
+// The table stretches to the available height, and the buttons follow its bottom edge
 void MainWindow::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
-    this->setFixedHeight(ui->menuBar->height() + CENTRAL_HEIGHT);
+    int centralHeight = ui->centralWidget->height();
+    ui->tableViewDevices->resize(ui->tableViewDevices->width(), centralHeight - TABLE_OFFSET - ui->tableViewDevices->y());
+    ui->pushButtonRefresh->move(ui->pushButtonRefresh->x(), centralHeight - BUTTONS_OFFSET);
+    ui->pushButtonOpen->move(ui->pushButtonOpen->x(), centralHeight - BUTTONS_OFFSET);
 }
 
-void MainWindow::on_actionAbout_triggered()
+// Handles an enumeration failure, which happens if libusb failed to initialize or could not retrieve a list of devices
+// Since the worker keeps retrying, the failure is reported only once, until an enumeration succeeds again
+void MainWindow::handleEnumerationError(const QString &errstr)
 {
-    showAboutDialog();  // See "common.h" and "common.cpp"
+    if (!enumerationFailing_) {
+        enumerationFailing_ = true;  // Set before showing the message, because further failures are delivered while it is shown
+        QMessageBox::warning(this, tr("Error"), tr("%1\nThe list of devices will be updated as soon as devices can be enumerated again.").arg(errstr));
+    }
 }
 
-void MainWindow::on_comboBoxDevices_currentIndexChanged(int index)
+void MainWindow::on_actionAbout_triggered()
 {
-    ui->pushButtonOpen->setEnabled(index != 0);
+    showAboutDialog();  // See "common.h" and "common.cpp"
 }
 
 void MainWindow::on_lineEditPID_textEdited(const QString &text)
@@ -84,9 +126,48 @@ void MainWindow::on_lineEditVID_textEdited(const QString &text)
     validateInput();
 }
 
+// Opens a window for each of the selected devices
+// When several devices are selected, devices that are in use are not waited for, since each wait would block the user interface
 void MainWindow::on_pushButtonOpen_clicked()
 {
-    QString serialString = ui->comboBoxDevices->currentText();  // Extract the serial number from the chosen item in the combo box
+    QModelIndexList selectedRows = ui->tableViewDevices->selectionModel()->selectedRows();
+    int timeout = selectedRows.size() > 1 ? 0 : OPEN_TIMEOUT;
+    for (const QModelIndex &index : selectedRows) {
+        openDevice(deviceTableModel_->serial(index.row()), timeout);
+    }
+}
+
+// Refreshes the list of devices, and fetches the details of the selected devices again (or of all devices, if none is selected)
+void MainWindow::on_pushButtonRefresh_clicked()
+{
+    QModelIndexList selectedRows = ui->tableViewDevices->selectionModel()->selectedRows();
+    if (selectedRows.isEmpty()) {
+        for (int i = 0; i < deviceTableModel_->rowCount(); ++i) {
+            deviceTableModel_->invalidateDetails(i);
+        }
+    } else {
+        for (const QModelIndex &index : selectedRows) {
+            deviceTableModel_->invalidateDetails(index.row());
+        }
+    }
+    emit refreshRequested();
+}
+
+void MainWindow::on_tableViewDevices_doubleClicked(const QModelIndex &index)
+{
+    openDevice(deviceTableModel_->serial(index.row()), OPEN_TIMEOUT);
+}
+
+// Enables the "Open" button if at least one device is selected
+void MainWindow::updateButtons()
+{
+    ui->pushButtonOpen->setEnabled(ui->tableViewDevices->selectionModel()->hasSelection());
+}
+
+// Opens the device having the given serial number in its own window, or activates the window if the device is already open
+// If the device is in use by another tool, it is waited for up to the given timeout, in milliseconds
+void MainWindow::openDevice(const QString &serialString, int timeout)
+{
     QString usbIdString = QString("%1%2%3").arg(vid_, 4, 16, QChar('0')).arg(pid_, 4, 16, QChar('0')).arg(serialString);  // Unique identifier string for the USB device
     ConfiguratorWindow *configuratorWindow;
     if (configuratorWindowMap_.contains(usbIdString) && !configuratorWindowMap_[usbIdString].isNull() && (configuratorWindow = configuratorWindowMap_[usbIdString].data())->isViewEnabled()) {  // If the device is already mapped, and its window is open but not disabled
@@ -95,34 +176,17 @@ void MainWindow::on_pushButtonOpen_clicked()
     } else {
         configuratorWindow = new ConfiguratorWindow(this);  // Create a new window that will close when its parent window closes
         configuratorWindow->setAttribute(Qt::WA_DeleteOnClose);  // This will not only free the allocated memory once the window is closed, but will also automatically call the destructor of the respective device, which in turn closes it
-        configuratorWindow->openDevice(vid_, pid_, serialString);  // Access the selected device and prepare its view
+        configuratorWindow->openDevice(vid_, pid_, serialString, timeout);  // Access the selected device and prepare its view
         configuratorWindow->show();  // Then open the corresponding window
         configuratorWindowMap_[usbIdString] = configuratorWindow;  // Map the device window, via a QPointer, to the unique identifier string of the device
+        deviceTableModel_->setDeviceOpen(serialString, true);
+        connect(configuratorWindow, &QObject::destroyed, deviceTableModel_, [this, serialString]() {
+            deviceTableModel_->setDeviceOpen(serialString, false);
+        });
     }
 }
 
-void MainWindow::on_pushButtonRefresh_clicked()
-{
-    refresh();
-}
-
-// Refreshes the combo box list
-void MainWindow::refresh()
-{
-    int errcnt = 0;
-    QString errstr;
-    QStringList comboBoxList = {tr("Select device...")};
-    comboBoxList += MCP2210::listDevices(vid_, pid_, errcnt, errstr);
-    if (errcnt > 0) {
-        QMessageBox::critical(this, tr("Critical Error"), tr("%1\nThis is a critical error and execution will be aborted.").arg(errstr));
-        exit(EXIT_FAILURE);  // This error is critical because either libusb failed to initialize, or could not retrieve a list of devices
-    } else {
-        ui->comboBoxDevices->clear();
-        ui->comboBoxDevices->addItems(comboBoxList);
-    }
-}
-
-// Checks for valid user input, enabling or disabling the combo box and the "Refresh" button, accordingly
+// Checks for valid user input, enabling or disabling the device table and the "Refresh" button, accordingly
 void MainWindow::validateInput()
 {
     QString vidstr = ui->lineEditVID->text();
@@ -130,12 +194,15 @@ void MainWindow::validateInput()
     if (vidstr.size() == 4 && pidstr.size() == 4) {
         vid_ = static_cast<quint16>(vidstr.toUInt(nullptr, 16));
         pid_ = static_cast<quint16>(pidstr.toUInt(nullptr, 16));
-        refresh();  // This has the "side effect" of disabling the "Open" button - Note that this is the intended behavior!
-        ui->comboBoxDevices->setEnabled(true);
+        ui->tableViewDevices->clearSelection();  // This has the "side effect" of disabling the "Open" button - Note that this is the intended behavior!
+        emit targetChanged(vid_, pid_);  // The table is filled incrementally, as the worker finds devices
+        ui->tableViewDevices->setEnabled(true);
         ui->pushButtonRefresh->setEnabled(true);
     } else {
-        ui->comboBoxDevices->setCurrentIndex(0);  // This also disables the "Open" button
-        ui->comboBoxDevices->setEnabled(false);
+        emit stopRequested();
+        deviceTableModel_->setDevices(0x0000, 0x0000, QVector<MCP2210Transport::DeviceInfo>());  // Empties the table
+        ui->tableViewDevices->clearSelection();  // This also disables the "Open" button
+        ui->tableViewDevices->setEnabled(false);
         ui->pushButtonRefresh->setEnabled(false);
     }
 }
@@ -25,10 +25,14 @@
 #include <QCloseEvent>
 #include <QMainWindow>
 #include <QMap>
+#include <QModelIndex>
 #include <QPointer>
 #include <QResizeEvent>
 #include <QString>
+#include <QThread>
 #include "configuratorwindow.h"
+#include "deviceinventoryworker.h"
+#include "devicetablemodel.h"
 
 namespace Ui {
 class MainWindow;
@@ -47,19 +51,30 @@ protected:
     void resizeEvent(QResizeEvent *event);
 
 private slots:
+    void handleEnumerationError(const QString &errstr);
     void on_actionAbout_triggered();
-    void on_comboBoxDevices_currentIndexChanged(int index);
     void on_lineEditPID_textEdited(const QString &text);
     void on_lineEditVID_textEdited(const QString &text);
     void on_pushButtonOpen_clicked();
     void on_pushButtonRefresh_clicked();
+    void on_tableViewDevices_doubleClicked(const QModelIndex &index);
+    void updateButtons();
+
+signals:
+    void refreshRequested();
+    void stopRequested();
+    void targetChanged(quint16 vid, quint16 pid);
 
 private:
     Ui::MainWindow *ui;
     QMap<QString, QPointer<ConfiguratorWindow>> configuratorWindowMap_;
+    DeviceTableModel *deviceTableModel_;
+    DeviceInventoryWorker *deviceInventoryWorker_;
+    QThread workerThread_;
+    bool enumerationFailing_;
     quint16 pid_, vid_;
 
-    void refresh();
+    void openDevice(const QString &serialString, int timeout);
     void validateInput();
 };
 
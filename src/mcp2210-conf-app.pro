@@ -0,0 +1,82 @@
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+# Added to provide backwards compatibility (C++11 support)
+greaterThan(QT_MAJOR_VERSION, 4) {
+    CONFIG += c++11
+} else {
+    QMAKE_CXXFLAGS += -std=c++11
+}
+
+TARGET = mcp2210-conf
+TEMPLATE = app
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+include(mcp2210corelib.pri)
+
+SOURCES += \
+    aboutdialog.cpp \
+    common.cpp \
+    configuratorwindow.cpp \
+    deviceinventoryworker.cpp \
+    devicetablemodel.cpp \
+    main.cpp \
+    mainwindow.cpp \
+    passworddialog.cpp \
+    statusdialog.cpp
+
+HEADERS += \
+    aboutdialog.h \
+    common.h \
+    configuratorwindow.h \
+    deviceinventoryworker.h \
+    devicetablemodel.h \
+    mainwindow.h \
+    passworddialog.h \
+    statusdialog.h
+
+FORMS += \
+    aboutdialog.ui \
+    configuratorwindow.ui \
+    mainwindow.ui \
+    passworddialog.ui \
+    statusdialog.ui
+
+TRANSLATIONS += \
+    translations/mcp2210-conf_en.ts \
+    translations/mcp2210-conf_en_US.ts \
+    translations/mcp2210-conf_pt.ts \
+    translations/mcp2210-conf_pt_PT.ts
+
+RESOURCES += \
+    resources.qrc
+
+# Added installation option
+unix {
+    isEmpty(PREFIX) {
+        PREFIX = /usr/local
+    }
+    target.path = $$PREFIX/bin
+    icon.files += icons/mcp2210-conf.png
+    icon.path = $$PREFIX/share/icons/hicolor/128x128/apps
+    shortcut.files = misc/mcp2210-conf.desktop
+    shortcut.path = $$PREFIX/share/applications
+    INSTALLS += icon
+    INSTALLS += shortcut
+}
+
+!isEmpty(target.path): INSTALLS += target
+
+DISTFILES += \
+    icons/mcp2210-conf.png \
+    misc/mcp2210-conf.desktop
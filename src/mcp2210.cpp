@@ -19,17 +19,155 @@
 
 
 // Includes
+#include <cstring>
 #include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutexLocker>
 #include <QObject>
+#include <QThread>
+#include <libusb-1.0/libusb.h>
 #include "mcp2210.h"
-extern "C" {
-#include "libusb-extra.h"
-}
+#include "mcp2210coalescer.h"
+#include "mcp2210codec.h"
+#include "mcp2210devicecache.h"
+#include "mcp2210devicelock.h"
+#include "mcp2210tracer.h"
 
 // Definitions
 const quint8 EPIN = 0x81;             // Address of endpoint assuming the IN direction
 const quint8 EPOUT = 0x01;            // Address of endpoint assuming the OUT direction
 const unsigned int TR_TIMEOUT = 500;  // Transfer timeout in milliseconds
+const unsigned long RECONNECT_INTERVAL = 100;  // Interval between reconnection attempts, in milliseconds
+const unsigned long BUSY_RETRY_INTERVAL = 100;  // Interval between attempts to claim a device held by a process that does not use lock files, in milliseconds
+const int RESTORE_SLOTS = 4;                   // Number of commands that change the volatile state (see restoreSlot())
+
+// Returns the name used to trace the given HID command
+static const char *commandName(quint8 command)
+{
+    const char *name;
+    switch (command) {
+    case MCP2210::GET_CHIP_STATUS:
+        name = "GET_CHIP_STATUS";
+        break;
+    case MCP2210::CANCEL_SPI_TRANSFER:
+        name = "CANCEL_SPI_TRANSFER";
+        break;
+    case MCP2210::GET_EVENT_COUNT:
+        name = "GET_EVENT_COUNT";
+        break;
+    case MCP2210::GET_CHIP_SETTINGS:
+        name = "GET_CHIP_SETTINGS";
+        break;
+    case MCP2210::SET_CHIP_SETTINGS:
+        name = "SET_CHIP_SETTINGS";
+        break;
+    case MCP2210::SET_GPIO_VALUES:
+        name = "SET_GPIO_VALUES";
+        break;
+    case MCP2210::GET_GPIO_VALUES:
+        name = "GET_GPIO_VALUES";
+        break;
+    case MCP2210::SET_GPIO_DIRECTIONS:
+        name = "SET_GPIO_DIRECTIONS";
+        break;
+    case MCP2210::GET_GPIO_DIRECTIONS:
+        name = "GET_GPIO_DIRECTIONS";
+        break;
+    case MCP2210::SET_SPI_SETTINGS:
+        name = "SET_SPI_SETTINGS";
+        break;
+    case MCP2210::GET_SPI_SETTINGS:
+        name = "GET_SPI_SETTINGS";
+        break;
+    case MCP2210::TRANSFER_SPI_DATA:
+        name = "TRANSFER_SPI_DATA";
+        break;
+    case MCP2210::READ_EEPROM:
+        name = "READ_EEPROM";
+        break;
+    case MCP2210::WRITE_EEPROM:
+        name = "WRITE_EEPROM";
+        break;
+    case MCP2210::SET_NVRAM_SETTINGS:
+        name = "SET_NVRAM_SETTINGS";
+        break;
+    case MCP2210::GET_NVRAM_SETTINGS:
+        name = "GET_NVRAM_SETTINGS";
+        break;
+    case MCP2210::SEND_PASSWORD:
+        name = "SEND_PASSWORD";
+        break;
+    default:
+        name = "UNKNOWN_COMMAND";
+    }
+    return name;
+}
+
+// Returns the slot in which the given command is kept for replaying after reconnecting, or -1 if the command does not change the volatile state
+static int restoreSlot(quint8 command)
+{
+    int slot;
+    if (command == MCP2210::SET_CHIP_SETTINGS) {
+        slot = 0;
+    } else if (command == MCP2210::SET_GPIO_VALUES) {
+        slot = 1;
+    } else if (command == MCP2210::SET_GPIO_DIRECTIONS) {
+        slot = 2;
+    } else if (command == MCP2210::SET_SPI_SETTINGS) {
+        slot = 3;
+    } else {
+        slot = -1;
+    }
+    return slot;
+}
+
+// Private function that is used to exchange a single packet with the device, without any locking or coalescing (see transferPacket())
+// If fewer than 64 bytes are received, the remaining bytes of the response are zeroed
+void MCP2210::exchangePacket(const unsigned char *command, unsigned char *response, int &errcnt, QString &errstr)
+{
+    MCP2210TraceSpan span(commandName(command[0]), "hid", command[0]);
+    int preverrcnt = errcnt;
+    bool measure = stats_ != nullptr && stats_->isEnabled();  // When statistics are disabled, the overhead is limited to this check
+    QElapsedTimer timer;
+    if (measure) {
+        timer.start();
+    }
+#if LIBUSB_API_VERSION >= 0x01000105
+    int outResult = interruptTransfer(EPOUT, const_cast<unsigned char *>(command), static_cast<int>(COMMAND_SIZE), nullptr, errcnt, errstr);
+#else
+    int bytesWritten;
+    int outResult = interruptTransfer(EPOUT, const_cast<unsigned char *>(command), static_cast<int>(COMMAND_SIZE), &bytesWritten, errcnt, errstr);
+#endif
+    qint64 outTime = measure ? timer.nsecsElapsed() : 0;
+    int bytesRead = 0;  // Important!
+    int inResult = interruptTransfer(EPIN, response, static_cast<int>(COMMAND_SIZE), &bytesRead, errcnt, errstr);
+    qint64 inTime = measure ? timer.nsecsElapsed() - outTime : 0;
+    for (int i = bytesRead < 0 ? 0 : bytesRead; i < static_cast<int>(COMMAND_SIZE); ++i) {
+        response[i] = 0x00;  // Any bytes that were not received are zeroed
+    }
+    bool invalid = errcnt == preverrcnt && (bytesRead < static_cast<int>(COMMAND_SIZE) || response[0] != command[0]);  // This additional verification only makes sense if the error count does not increase
+    if (invalid) {
+        ++errcnt;
+        errstr += QObject::tr("Received invalid response to HID command.\n");
+    } else if (errcnt == preverrcnt) {
+        completedExchanges_.fetchAndAddRelaxed(1);
+    }
+    if (measure) {
+        int outcome;
+        if (outResult == LIBUSB_ERROR_TIMEOUT || inResult == LIBUSB_ERROR_TIMEOUT) {
+            outcome = MCP2210Stats::OCTIMEOUT;
+        } else if (outResult == LIBUSB_ERROR_NO_DEVICE || outResult == LIBUSB_ERROR_IO || inResult == LIBUSB_ERROR_NO_DEVICE || inResult == LIBUSB_ERROR_IO) {  // Same criteria used by interruptTransfer() to flag a disconnection
+            outcome = MCP2210Stats::OCDISCONNECTED;
+        } else if (invalid) {
+            outcome = MCP2210Stats::OCINVALID;
+        } else if (errcnt != preverrcnt) {
+            outcome = MCP2210Stats::OCERROR;
+        } else {
+            outcome = MCP2210Stats::OCCOMPLETED;
+        }
+        stats_->record(command[0], outTime, inTime, outcome);
+    }
+}
 
 // Private generic function that is used to get any descriptor
 QString MCP2210::getDescGeneric(quint8 subcomid, int &errcnt, QString &errstr)
@@ -48,14 +186,16 @@ QString MCP2210::getDescGeneric(quint8 subcomid, int &errcnt, QString &errstr)
     return descriptor;
 }
 
-// Private function that is used to perform interrupt transfers
-void MCP2210::interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, int &errcnt, QString &errstr)
+// Private function that is used to perform interrupt transfers, returning the libusb result (reported to hidTransfer() for statistics purposes)
+int MCP2210::interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, int &errcnt, QString &errstr)
 {
-    if (!isOpen()) {
+    int result;
+    if (!transport_->isOpen()) {  // isOpen() is not used here, since it would take the lock of the normal priority class
         ++errcnt;
         errstr += QObject::tr("In interruptTransfer(): device is not open.\n");  // Program logic error
+        result = LIBUSB_ERROR_NO_DEVICE;
     } else {
-        int result = libusb_interrupt_transfer(handle_, endpointAddr, data, length, transferred, TR_TIMEOUT);
+        result = transport_->interruptTransfer(endpointAddr, data, length, transferred, TR_TIMEOUT);
         if (result != 0 || (transferred != nullptr && *transferred != length)) {  // The number of transferred bytes is also verified, as long as a valid (non-null) pointer is passed via "transferred"
             ++errcnt;
             if (endpointAddr < 0x80) {
@@ -63,11 +203,134 @@ void MCP2210::interruptTransfer(quint8 endpointAddr, unsigned char *data, int le
             } else {
                 errstr += QObject::tr("Failed interrupt IN transfer from endpoint %1 (address 0x%2).\n").arg(0x0f & endpointAddr).arg(endpointAddr, 2, 16, QChar('0'));
             }
-            if (result == LIBUSB_ERROR_NO_DEVICE || result == LIBUSB_ERROR_IO) {  // Note that libusb_interrupt_transfer() may return "LIBUSB_ERROR_IO" [-1] on device disconnect
+            if (result == LIBUSB_ERROR_NO_DEVICE || result == LIBUSB_ERROR_IO) {  // Note that libusb_interrupt_transfer() may return "LIBUSB_ERROR_IO" [-1] on device disconnect (transports report errors using libusb codes)
                 disconnected_ = true;  // This reports that the device has been disconnected
             }
         }
     }
+    return result;
+}
+
+// Private function that returns the priority class of the given HID command
+// GPIO commands and "CANCEL_SPI_TRANSFER" are latency-critical (e.g. for cutting power to a device under test), so they belong to the high priority class
+int MCP2210::priorityClass(quint8 command)
+{
+    int retval;
+    if (command == CANCEL_SPI_TRANSFER || command == SET_GPIO_VALUES || command == GET_GPIO_VALUES || command == SET_GPIO_DIRECTIONS || command == GET_GPIO_DIRECTIONS) {
+        retval = MCP2210Stats::PCHIGH;
+    } else {
+        retval = MCP2210Stats::PCNORMAL;
+    }
+    return retval;
+}
+
+// Private function that is used to reopen the device after a disconnection, and to restore its volatile state, returning true if successful
+// Reopening is retried until the reconnection timeout expires, and the volatile state is restored by replaying the last commands that changed it, in their original order
+// Since the caller holds exclusive access to the USB interface, the transport is used directly (close() and open() would take locks), and reconnections are serialized
+// The timeout counts from the start of the outage, not of each call, so that packets queued behind a failed reconnection try only once instead of waiting again
+// Likewise, an outage is counted as a single disconnection, and as a single failed reconnection, regardless of how many packets try to reconnect
+bool MCP2210::reconnect(int &errcnt, QString &errstr)
+{
+    MCP2210TraceSpan span("reconnect", "usb");
+    QElapsedTimer timer;
+    timer.start();
+    bool outageStarted = !outageTimer_.isValid();
+    if (outageStarted) {
+        outageTimer_.start();
+    }
+    transport_->close();
+    bool reopened = transport_->open(vid_, pid_, serial_) == SUCCESS;
+    while (!reopened && outageTimer_.elapsed() < reconnectTimeout_) {
+        QThread::msleep(RECONNECT_INTERVAL);
+        reopened = transport_->open(vid_, pid_, serial_) == SUCCESS;
+    }
+    bool restored = reopened;
+    if (!reopened) {
+        ++errcnt;
+        errstr += QObject::tr("Could not reconnect to the device within %1 ms.\n").arg(reconnectTimeout_);
+    } else {
+        disconnected_ = false;
+        outageTimer_.invalidate();
+        quint64 sequence = 0;
+        for (int i = 0; i < RESTORE_SLOTS && restored; ++i) {
+            int next = -1;
+            for (int j = 0; j < RESTORE_SLOTS; ++j) {
+                if (restorePackets_[j].sequence > sequence && (next < 0 || restorePackets_[j].sequence < restorePackets_[next].sequence)) {
+                    next = j;
+                }
+            }
+            if (next >= 0) {
+                sequence = restorePackets_[next].sequence;
+                int preverrcnt = errcnt;
+                unsigned char response[COMMAND_SIZE];
+                exchangePacket(restorePackets_[next].command, response, errcnt, errstr);
+                if (errcnt == preverrcnt && response[1] != COMPLETED) {
+                    ++errcnt;
+                    errstr += QObject::tr("Failed to restore the volatile state of the device (response 0x%1).\n").arg(response[1], 2, 16, QChar('0'));
+                }
+                restored = errcnt == preverrcnt;
+            }
+        }
+        if (coalescer_ != nullptr) {
+            coalescer_->invalidate();  // Any responses obtained before the disconnection are stale
+        }
+    }
+    qint64 downtime = timer.elapsed();
+    QMutexLocker locker(&reconnectMutex_);
+    if (outageStarted) {
+        ++reconnectStats_.disconnects;
+    }
+    if (outageStarted || reopened) {  // Further attempts within an outage that already failed are only counted if they end it
+        if (restored) {
+            ++reconnectStats_.reconnects;
+        } else {
+            ++reconnectStats_.failedReconnects;
+        }
+        reconnectStats_.lastDowntime = downtime;
+        reconnectStats_.maxDowntime = qMax(reconnectStats_.maxDowntime, downtime);
+        reconnectStats_.totalDowntime += downtime;
+    }
+    return restored;
+}
+
+// Private function that is used to send a single 64-byte HID command and to receive the 64-byte response, both being raw packets
+// If read coalescing is enabled, status queries may be answered with the response to an identical query, without a USB round trip
+void MCP2210::transferPacket(const unsigned char *command, unsigned char *response, int &errcnt, QString &errstr)
+{
+    bool coalesce = coalescer_ != nullptr && coalescer_->isEnabled();  // When coalescing is disabled, the overhead is limited to this check
+    qint64 arrival = coalesce ? coalescer_->now() : 0;
+    if (!coalesce || !coalescer_->take(command, response, arrival, true, errcnt, errstr)) {  // Joins an identical query in flight, if any
+        int packetClass = priorityClass(command[0]);
+        Lock guard(this, packetClass);
+        Lock gpioGuard(this, command[0] == SET_CHIP_SETTINGS ? MCP2210Stats::PCHIGH : packetClass);  // "SET_CHIP_SETTINGS" also sets the GPIO values and directions, so it must not fall between the two packets of a read-modify-write such as toggleGPIO()
+        BusGrant grant(this, packetClass);
+        if (!coalesce || !coalescer_->take(command, response, arrival, false, errcnt, errstr)) {  // An identical query may have completed while waiting for the USB interface
+            if (coalesce) {
+                coalescer_->begin(command);
+            }
+            int preverrcnt = errcnt;
+            int preverrsize = errstr.size();
+            exchangePacket(command, response, errcnt, errstr);
+            if (disconnected_ && reconnectTimeout_ >= 0) {
+                if (reconnect(errcnt, errstr) && command[0] != TRANSFER_SPI_DATA) {  // SPI transfers are not resumed, since the state of the SPI transfer engine is lost
+                    errcnt = preverrcnt;  // The interrupted command is resent, as if the disconnection never happened
+                    errstr.truncate(preverrsize);
+                    exchangePacket(command, response, errcnt, errstr);
+                    reconnectMutex_.lock();
+                    ++reconnectStats_.resumedOperations;
+                    reconnectMutex_.unlock();
+                }
+            }
+            int slot = reconnectTimeout_ < 0 ? -1 : restoreSlot(command[0]);
+            if (slot >= 0 && errcnt == preverrcnt && response[1] == COMPLETED) {
+                restorePackets_[slot].sequence = ++restoreSequence_;
+                std::memcpy(restorePackets_[slot].command, command, COMMAND_SIZE);
+            }
+            if (coalesce) {
+                coalescer_->finish(command, response, errcnt - preverrcnt, errstr.mid(preverrsize));
+            }
+        }
+    }
 }
 
 // Private generic function that is used to write any descriptor
@@ -85,10 +348,81 @@ quint8 MCP2210::writeDescGeneric(const QString &descriptor, quint8 subcomid, int
         command[2 * i + PREAMBLE_SIZE + 2] = static_cast<quint8>(descriptor[i].unicode());
         command[2 * i + PREAMBLE_SIZE + 3] = static_cast<quint8>(descriptor[i].unicode() >> 8);
     }
+    int preverrcnt = errcnt;
     QVector<quint8> response = hidTransfer(command, errcnt, errstr);
+    if (errcnt == preverrcnt && response.at(1) == COMPLETED) {
+        MCP2210DeviceCache::instance().invalidate(vid_, pid_, serial_);  // The cached descriptors of this device are now stale
+    }
     return response.at(1);
 }
 
+// Locks the given object for operations of the given priority class, if the thread-safe mode is enabled
+MCP2210::Lock::Lock(const MCP2210 *mcp2210, int priorityClass) :
+    mcp2210_(mcp2210),
+    priorityClass_(priorityClass),
+    locked_(mcp2210->threadSafe_)
+{
+    if (locked_) {
+        if (priorityClass_ == MCP2210Stats::PCHIGH) {
+            mcp2210_->priorityMutex_.lock();
+        } else {
+            mcp2210_->mutex_.lock();
+        }
+    }
+}
+
+MCP2210::Lock::~Lock()
+{
+    if (locked_) {
+        if (priorityClass_ == MCP2210Stats::PCHIGH) {
+            mcp2210_->priorityMutex_.unlock();
+        } else {
+            mcp2210_->mutex_.unlock();
+        }
+    }
+}
+
+// Waits until the USB interface of the given object is free, if the thread-safe mode is enabled
+// Packets of the normal priority class also wait while any packets of the high priority class are waiting, so the latter are served first
+MCP2210::BusGrant::BusGrant(MCP2210 *mcp2210, int priorityClass) :
+    mcp2210_(mcp2210),
+    granted_(mcp2210->threadSafe_)
+{
+    if (granted_) {
+        bool measure = mcp2210_->stats_ != nullptr && mcp2210_->stats_->isEnabled();
+        QElapsedTimer timer;
+        if (measure) {
+            timer.start();
+        }
+        QMutexLocker locker(&mcp2210_->busMutex_);
+        if (priorityClass == MCP2210Stats::PCHIGH) {
+            ++mcp2210_->busHighWaiters_;
+            while (mcp2210_->busBusy_) {
+                mcp2210_->busCondition_.wait(&mcp2210_->busMutex_);
+            }
+            --mcp2210_->busHighWaiters_;
+        } else {
+            while (mcp2210_->busBusy_ || mcp2210_->busHighWaiters_ > 0) {
+                mcp2210_->busCondition_.wait(&mcp2210_->busMutex_);
+            }
+        }
+        mcp2210_->busBusy_ = true;
+        if (measure) {
+            mcp2210_->stats_->recordQueueDelay(priorityClass, timer.nsecsElapsed());
+        }
+    }
+}
+
+// Frees the USB interface, waking up all waiting packets so that the one with the highest priority can proceed
+MCP2210::BusGrant::~BusGrant()
+{
+    if (granted_) {
+        QMutexLocker locker(&mcp2210_->busMutex_);
+        mcp2210_->busBusy_ = false;
+        mcp2210_->busCondition_.wakeAll();
+    }
+}
+
 // "Equal to" operator for ChipSettings
 bool MCP2210::ChipSettings::operator ==(const MCP2210::ChipSettings &other) const
 {
@@ -137,29 +471,117 @@ bool MCP2210::USBParameters::operator !=(const MCP2210::USBParameters &other) co
     return !(operator ==(other));
 }
 
+// Note that the default transport can be chosen per deployment via the "MCP2210_TRANSPORT" environment variable (see "mcp2210transport.cpp")
 MCP2210::MCP2210() :
-    context_(nullptr),
-    handle_(nullptr),
+    transport_(MCP2210Transport::create()),
+    stats_(nullptr),
+    coalescer_(nullptr),
+    deviceLock_(nullptr),
+    reconnectStats_(),
+    completedExchanges_(0),
     disconnected_(false),
-    kernelWasAttached_(false)
+    threadSafe_(false),
+    busBusy_(false),
+    busHighWaiters_(0),
+    vid_(0),
+    pid_(0),
+    reconnectTimeout_(-1),
+    restorePackets_(),
+    restoreSequence_(0)
+{
+}
+
+// Uses the given transport, taking ownership of it
+MCP2210::MCP2210(MCP2210Transport *transport) :
+    transport_(transport),
+    stats_(nullptr),
+    coalescer_(nullptr),
+    deviceLock_(nullptr),
+    reconnectStats_(),
+    completedExchanges_(0),
+    disconnected_(false),
+    threadSafe_(false),
+    busBusy_(false),
+    busHighWaiters_(0),
+    vid_(0),
+    pid_(0),
+    reconnectTimeout_(-1),
+    restorePackets_(),
+    restoreSequence_(0)
 {
 }
 
 MCP2210::~MCP2210()
 {
     close();  // The destructor is used to close the device, and this is essential so the device can be freed when the parent object is destroyed
+    delete transport_;
+    delete stats_;
+    delete coalescer_;
+    delete deviceLock_;
+}
+
+// Returns the number of status queries that were answered without a USB round trip, due to read coalescing
+quint64 MCP2210::coalescedReads() const
+{
+    return coalescer_ == nullptr ? 0 : coalescer_->coalesced();
+}
+
+// Returns the number of HID commands that got a valid response so far, which proves that the device is alive whenever it increases
+// This function is lock-free, so that it can be polled without contending for the device
+quint64 MCP2210::completedExchanges() const
+{
+    return completedExchanges_.loadAcquire();
+}
+
+// Returns the freshness window used for read coalescing, in milliseconds, or -1 if read coalescing is disabled
+int MCP2210::coalescingWindow() const
+{
+    return coalescer_ == nullptr ? -1 : coalescer_->window();
 }
 
 // Diagnostic function used to verify if the device has been disconnected
 bool MCP2210::disconnected() const
 {
+    Lock guard(this);
     return disconnected_;  // Returns true if the device has been disconnected, or false otherwise
 }
 
 // Checks if the device is open
 bool MCP2210::isOpen() const
 {
-    return handle_ != nullptr;  // Returns true if the device is open, or false otherwise
+    Lock guard(this);
+    return transport_->isOpen();  // Returns true if the device is open, or false otherwise
+}
+
+// Checks if the thread-safe mode is enabled
+bool MCP2210::isThreadSafe() const
+{
+    return threadSafe_;
+}
+
+// Returns the reconnection timeout, in milliseconds, or -1 if automatic reconnection is disabled
+int MCP2210::reconnectTimeout() const
+{
+    return reconnectTimeout_;
+}
+
+// Returns the reconnection statistics, which measure the downtime caused by disconnections
+MCP2210Stats::ReconnectStats MCP2210::reconnectStats() const
+{
+    QMutexLocker locker(&reconnectMutex_);  // The statistics can be read while a reconnection is ongoing
+    return reconnectStats_;
+}
+
+// Returns a snapshot of the HID transfer statistics, which is empty if statistics were never enabled
+MCP2210Stats::Snapshot MCP2210::statsSnapshot() const
+{
+    MCP2210Stats::Snapshot snapshot = MCP2210Stats::Snapshot();  // Value-initialized, so that all histograms are zeroed
+    if (stats_ == nullptr) {
+        snapshot.elapsed = 0;
+    } else {
+        snapshot = stats_->snapshot();
+    }
+    return snapshot;
 }
 
 // Cancels the ongoing SPI transfer
@@ -175,56 +597,35 @@ quint8 MCP2210::cancelSPITransfer(int &errcnt, QString &errstr)
 // Closes the device safely, if open
 void MCP2210::close()
 {
-    if (isOpen()) {  // This condition avoids a segmentation fault if the calling algorithm tries, for some reason, to close the same device twice (e.g., if the device is already closed when the destructor is called)
-        libusb_release_interface(handle_, 0);  // Release the interface
-        if (kernelWasAttached_) {  // If a kernel driver was attached to the interface before
-            libusb_attach_kernel_driver(handle_, 0);  // Reattach the kernel driver
-        }
-        libusb_close(handle_);  // Close the device
-        libusb_exit(context_);  // Deinitialize libusb
-        handle_ = nullptr;  // Required to mark the device as closed
-    }
+    Lock guard(this);
+    Lock priorityGuard(this, MCP2210Stats::PCHIGH);  // Operations of the high priority class must not be ongoing either
+    transport_->close();  // If the device is already closed, this will have no effect
+    delete deviceLock_;  // Hands the device over to any process waiting for it (see open())
+    deviceLock_ = nullptr;
 }
 
 // Configures volatile chip settings
 quint8 MCP2210::configureChipSettings(const ChipSettings &settings, int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        SET_CHIP_SETTINGS, 0x00, 0x00, 0x00,                                                             // Header
-        settings.gp0,                                                                                    // GP0 pin configuration
-        settings.gp1,                                                                                    // GP1 pin configuration
-        settings.gp2,                                                                                    // GP2 pin configuration
-        settings.gp3,                                                                                    // GP3 pin configuration
-        settings.gp4,                                                                                    // GP4 pin configuration
-        settings.gp5,                                                                                    // GP5 pin configuration
-        settings.gp6,                                                                                    // GP6 pin configuration
-        settings.gp7,                                                                                    // GP7 pin configuration
-        settings.gp8,                                                                                    // GP8 pin configuration
-        settings.gpout, 0x00,                                                                            // Default GPIO outputs (GPIO7 to GPIO0)
-        settings.gpdir, 0x01,                                                                            // Default GPIO directions (GPIO7 to GPIO0)
-        static_cast<quint8>(settings.rmwakeup << 4 | (0x07 & settings.intmode) << 1 | settings.nrelspi)  // Other chip settings
+    unsigned char command[COMMAND_SIZE] = {
+        SET_CHIP_SETTINGS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
-    return response.at(1);
+    MCP2210Codec::ChipSettingsLayout::encode(settings, command);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
+    return response[1];
 }
 
 // Configures volatile SPI transfer settings
 quint8 MCP2210::configureSPISettings(const SPISettings &settings, int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        SET_SPI_SETTINGS, 0x00, 0x00, 0x00,                                                        // Header
-        static_cast<quint8>(settings.bitrate), static_cast<quint8>(settings.bitrate >> 8),         // Bit rate
-        static_cast<quint8>(settings.bitrate >> 16), static_cast<quint8>(settings.bitrate >> 24),
-        settings.idlcs, 0x00,                                                                      // Idle chip select (CS7 to CS0)
-        settings.actcs, 0x00,                                                                      // Active chip select (CS7 to CS0)
-        static_cast<quint8>(settings.csdtdly), static_cast<quint8>(settings.csdtdly >> 8),         // Chip select to data delay
-        static_cast<quint8>(settings.dtcsdly), static_cast<quint8>(settings.dtcsdly >> 8),         // Data to chip select delay
-        static_cast<quint8>(settings.itbytdly), static_cast<quint8>(settings.itbytdly >> 8),       // Inter-byte delay
-        static_cast<quint8>(settings.nbytes), static_cast<quint8>(settings.nbytes >> 8),           // Number of bytes per SPI transaction
-        settings.mode                                                                              // SPI mode
+    unsigned char command[COMMAND_SIZE] = {
+        SET_SPI_SETTINGS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
-    return response.at(1);
+    MCP2210Codec::SPISettingsLayout::encode(settings, command);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
+    return response[1];
 }
 
 // Retrieves the access control mode from the MCP2210 NVRAM
@@ -240,25 +641,13 @@ quint8 MCP2210::getAccessControlMode(int &errcnt, QString &errstr)
 // Returns applied chip settings
 MCP2210::ChipSettings MCP2210::getChipSettings(int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        GET_CHIP_SETTINGS  // Header
+    unsigned char command[COMMAND_SIZE] = {
+        GET_CHIP_SETTINGS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
     ChipSettings settings;
-    settings.gp0 = response.at(4);                                        // GP0 pin configuration corresponds to byte 4
-    settings.gp1 = response.at(5);                                        // GP1 pin configuration corresponds to byte 5
-    settings.gp2 = response.at(6);                                        // GP2 pin configuration corresponds to byte 6
-    settings.gp3 = response.at(7);                                        // GP3 pin configuration corresponds to byte 7
-    settings.gp4 = response.at(8);                                        // GP4 pin configuration corresponds to byte 8
-    settings.gp5 = response.at(9);                                        // GP5 pin configuration corresponds to byte 9
-    settings.gp6 = response.at(10);                                       // GP6 pin configuration corresponds to byte 10
-    settings.gp7 = response.at(11);                                       // GP7 pin configuration corresponds to byte 11
-    settings.gp8 = response.at(12);                                       // GP8 pin configuration corresponds to byte 12
-    settings.gpdir = response.at(15);                                     // Default GPIO directions (GPIO7 to GPIO0) corresponds to byte 15
-    settings.gpout = response.at(13);                                     // Default GPIO outputs (GPIO7 to GPIO0) corresponds to byte 13
-    settings.rmwakeup = (0x10 & response.at(17)) != 0x00;                 // Remote wake-up corresponds to bit 4 of byte 17
-    settings.intmode = static_cast<quint8>(0x07 & response.at(17) >> 1);  // Interrupt counting mode corresponds to bits 3:1 of byte 17
-    settings.nrelspi = (0x01 & response.at(17)) != 0x00;                  // SPI bus release corresponds to bit 0 of byte 17
+    MCP2210Codec::ChipSettingsLayout::decode(response, settings);
     return settings;
 }
 
@@ -345,44 +734,26 @@ QString MCP2210::getManufacturerDesc(int &errcnt, QString &errstr)
 // Retrieves the power-up (non-volatile) chip settings from the MCP2210 NVRAM
 MCP2210::ChipSettings MCP2210::getNVChipSettings(int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        GET_NVRAM_SETTINGS, NV_CHIP_SETTINGS  // Header
+    unsigned char command[COMMAND_SIZE] = {
+        GET_NVRAM_SETTINGS, NV_CHIP_SETTINGS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
     ChipSettings settings;
-    settings.gp0 = response.at(4);                                        // GP0 pin configuration corresponds to byte 4
-    settings.gp1 = response.at(5);                                        // GP1 pin configuration corresponds to byte 5
-    settings.gp2 = response.at(6);                                        // GP2 pin configuration corresponds to byte 6
-    settings.gp3 = response.at(7);                                        // GP3 pin configuration corresponds to byte 7
-    settings.gp4 = response.at(8);                                        // GP4 pin configuration corresponds to byte 8
-    settings.gp5 = response.at(9);                                        // GP5 pin configuration corresponds to byte 9
-    settings.gp6 = response.at(10);                                       // GP6 pin configuration corresponds to byte 10
-    settings.gp7 = response.at(11);                                       // GP7 pin configuration corresponds to byte 11
-    settings.gp8 = response.at(12);                                       // GP8 pin configuration corresponds to byte 12
-    settings.gpdir = response.at(15);                                     // Default GPIO directions (GPIO7 to GPIO0) corresponds to byte 15
-    settings.gpout = response.at(13);                                     // Default GPIO outputs (GPIO7 to GPIO0) corresponds to byte 13
-    settings.rmwakeup = (0x10 & response.at(17)) != 0x00;                 // Remote wake-up corresponds to bit 4 of byte 17
-    settings.intmode = static_cast<quint8>(0x07 & response.at(17) >> 1);  // Interrupt counting mode corresponds to bits 3:1 of byte 17
-    settings.nrelspi = (0x01 & response.at(17)) != 0x00;                  // SPI bus release corresponds to bit 0 of byte 17
+    MCP2210Codec::ChipSettingsLayout::decode(response, settings);
     return settings;
 }
 
 // Retrieves the power-up (non-volatile) SPI transfer settings from the MCP2210 NVRAM
 MCP2210::SPISettings MCP2210::getNVSPISettings(int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        GET_NVRAM_SETTINGS, NV_SPI_SETTINGS  // Header
+    unsigned char command[COMMAND_SIZE] = {
+        GET_NVRAM_SETTINGS, NV_SPI_SETTINGS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
     SPISettings settings;
-    settings.nbytes = static_cast<quint16>(response.at(19) << 8 | response.at(18));                                               // Number of bytes per SPI transfer corresponds to bytes 18 and 19 (little-endian conversion)
-    settings.bitrate = static_cast<quint32>(response.at(7) << 24 | response.at(6) << 16 | response.at(5) << 8 | response.at(4));  // Bit rate corresponds to bytes 4 to 7 (little-endian conversion)
-    settings.mode = response.at(20);                                                                                              // SPI mode corresponds to byte 20
-    settings.actcs = response.at(10);                                                                                             // Active chip select (CS7 to CS0) corresponds to byte 10
-    settings.idlcs = response.at(8);                                                                                              // Idle chip select (CS7 to CS0) corresponds to byte 8
-    settings.csdtdly = static_cast<quint16>(response.at(13) << 8 | response.at(12));                                              // Chip select to data corresponds to bytes 12 and 13 (little-endian conversion)
-    settings.dtcsdly = static_cast<quint16>(response.at(15) << 8 | response.at(14));                                              // Data to chip select delay corresponds to bytes 14 and 15 (little-endian conversion)
-    settings.itbytdly = static_cast<quint16>(response.at(17) << 8 | response.at(16));                                             // Inter-byte delay corresponds to bytes 16 and 17 (little-endian conversion)
+    MCP2210Codec::SPISettingsLayout::decode(response, settings);
     return settings;
 }
 
@@ -395,35 +766,26 @@ QString MCP2210::getProductDesc(int &errcnt, QString &errstr)
 // Returns applied SPI transfer settings
 MCP2210::SPISettings MCP2210::getSPISettings(int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        GET_SPI_SETTINGS  // Header
+    unsigned char command[COMMAND_SIZE] = {
+        GET_SPI_SETTINGS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
     SPISettings settings;
-    settings.nbytes = static_cast<quint16>(response.at(19) << 8 | response.at(18));                                               // Number of bytes per SPI transfer corresponds to bytes 18 and 19 (little-endian conversion)
-    settings.bitrate = static_cast<quint32>(response.at(7) << 24 | response.at(6) << 16 | response.at(5) << 8 | response.at(4));  // Bit rate corresponds to bytes 4 to 7 (little-endian conversion)
-    settings.mode = response.at(20);                                                                                              // SPI mode corresponds to byte 20
-    settings.actcs = response.at(10);                                                                                             // Active chip select (CS7 to CS0) corresponds to byte 10
-    settings.idlcs = response.at(8);                                                                                              // Idle chip select (CS7 to CS0) corresponds to byte 8
-    settings.csdtdly = static_cast<quint16>(response.at(13) << 8 | response.at(12));                                              // Chip select to data corresponds to bytes 12 and 13 (little-endian conversion)
-    settings.dtcsdly = static_cast<quint16>(response.at(15) << 8 | response.at(14));                                              // Data to chip select delay corresponds to bytes 14 and 15 (little-endian conversion)
-    settings.itbytdly = static_cast<quint16>(response.at(17) << 8 | response.at(16));                                             // Inter-byte delay corresponds to bytes 16 and 17 (little-endian conversion)
+    MCP2210Codec::SPISettingsLayout::decode(response, settings);
     return settings;
 }
 
 // Gets the USB parameters, namely VID, PID and power settings
 MCP2210::USBParameters MCP2210::getUSBParameters(int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        GET_NVRAM_SETTINGS, USB_PARAMETERS  // Header
+    unsigned char command[COMMAND_SIZE] = {
+        GET_NVRAM_SETTINGS, USB_PARAMETERS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
     USBParameters parameters;
-    parameters.vid = static_cast<quint16>(response.at(13) << 8 | response.at(12));  // Vendor ID corresponds to bytes 12 and 13 (little-endian conversion)
-    parameters.pid = static_cast<quint32>(response.at(15) << 8 | response.at(14));  // Product ID corresponds to bytes 14 and 15 (little-endian conversion)
-    parameters.maxpow = response.at(30);                                            // Maximum consumption current corresponds to byte 30
-    parameters.powmode = (0x40 & response.at(29)) != 0x00;                          // Power mode corresponds to bit 6 of byte 29 (bit 7 is redundant)
-    parameters.rmwakeup = (0x20 & response.at(29)) != 0x00;                         // Remote wake-up capability corresponds to bit 5 of byte 29
+    MCP2210Codec::USBParametersReadLayout::decode(response, parameters);
     return parameters;
 }
 
@@ -437,68 +799,101 @@ QVector<quint8> MCP2210::hidTransfer(const QVector<quint8> &data, int &errcnt, Q
     for (size_t i = 0; i < bytesToFill; ++i) {
         commandBuffer[i] = data[i];
     }
-    int preverrcnt = errcnt;
-#if LIBUSB_API_VERSION >= 0x01000105
-    interruptTransfer(EPOUT, commandBuffer, static_cast<int>(COMMAND_SIZE), nullptr, errcnt, errstr);
-#else
-    int bytesWritten;
-    interruptTransfer(EPOUT, commandBuffer, static_cast<int>(COMMAND_SIZE), &bytesWritten, errcnt, errstr);
-#endif
     unsigned char responseBuffer[COMMAND_SIZE];
-    int bytesRead = 0;  // Important!
-    interruptTransfer(EPIN, responseBuffer, static_cast<int>(COMMAND_SIZE), &bytesRead, errcnt, errstr);
+    transferPacket(commandBuffer, responseBuffer, errcnt, errstr);
     QVector<quint8> retdata(static_cast<int>(COMMAND_SIZE));
-    for (int i = 0; i < bytesRead; ++i) {
+    for (size_t i = 0; i < COMMAND_SIZE; ++i) {
         retdata[i] = responseBuffer[i];
     }
-    if (errcnt == preverrcnt && (bytesRead < static_cast<int>(COMMAND_SIZE) || responseBuffer[0] != commandBuffer[0])) {  // This additional verification only makes sense if the error count does not increase
-        ++errcnt;
-        errstr += QObject::tr("Received invalid response to HID command.\n");
-    }
     return retdata;
 }
 
-// Opens the device having the given VID, PID and, optionally, the given serial number, and assigns its handle
+// Locks the object, so that the calling thread gets exclusive access to the device until unlock() is called
+// This is useful to keep sequences of commands from being interleaved with commands from other threads (e.g. SPI transfers spanning several calls to spiTransfer())
+// Commands of the high priority class (GPIO commands and "CANCEL_SPI_TRANSFER") issued by other threads are still let through, between packets
+// If both priority classes are to be locked, the lock for the normal class must be taken first, as done by open() and close()
+// Calls can be nested, and have no effect if the thread-safe mode is disabled
+void MCP2210::lock()
+{
+    if (threadSafe_) {
+        mutex_.lock();
+    }
+}
+
+// Opens the device having the given VID, PID and, optionally, the given serial number, using the underlying transport
 int MCP2210::open(quint16 vid, quint16 pid, const QString &serial)
 {
+    Lock guard(this);
+    Lock priorityGuard(this, MCP2210Stats::PCHIGH);
     int retval;
     if (isOpen()) {  // Just in case the calling algorithm tries to open a device that was already sucessfully open, or tries to open different devices concurrently, all while using (or referencing to) the same object
         retval = SUCCESS;
-    } else if (libusb_init(&context_) != 0) {  // Initialize libusb. In case of failure
-        retval = ERROR_INIT;
-    } else {  // If libusb is initialized
-        if (serial.isNull()) {  // Note that serial, by omission, is a null QString
-            handle_ = libusb_open_device_with_vid_pid(context_, vid, pid);  // If no serial number is specified, this will open the first device found with matching VID and PID
-        } else {
-            handle_ = libusb_open_device_with_vid_pid_serial(context_, vid, pid, reinterpret_cast<unsigned char *>(serial.toLatin1().data()));
-        }
-        if (handle_ == nullptr) {  // If the previous operation fails to get a device handle
-            libusb_exit(context_);  // Deinitialize libusb
-            retval = ERROR_NOT_FOUND;
-        } else {  // If the device is successfully opened and a handle obtained
-            if (libusb_kernel_driver_active(handle_, 0) == 1) {  // If a kernel driver is active on the interface
-                libusb_detach_kernel_driver(handle_, 0);  // Detach the kernel driver
-                kernelWasAttached_ = true;  // Flag that the kernel driver was attached
-            } else {
-                kernelWasAttached_ = false;  // The kernel driver was not attached
+    } else {
+        retval = transport_->open(vid, pid, serial);
+        if (retval == SUCCESS) {
+            disconnected_ = false;  // Note that this flag is never assumed to be true for a device that was never opened - See constructor for details!
+            vid_ = vid;  // The device is identified the same way when reconnecting (see setAutoReconnect())
+            pid_ = pid;
+            serial_ = serial;
+            outageTimer_.invalidate();  // Any outage that preceded this call is over
+            for (int i = 0; i < RESTORE_SLOTS; ++i) {
+                restorePackets_[i].sequence = 0;  // The volatile state is that of a newly opened device
             }
-            if (libusb_claim_interface(handle_, 0) != 0) {  // Claim the interface. In case of failure
-                if (kernelWasAttached_) {  // If a kernel driver was attached to the interface before
-                    libusb_attach_kernel_driver(handle_, 0);  // Reattach the kernel driver
-                }
-                libusb_close(handle_);  // Close the device
-                libusb_exit(context_);  // Deinitialize libusb
-                handle_ = nullptr;  // Required to mark the device as closed
-                retval = ERROR_BUSY;
-            } else {
-                disconnected_ = false;  // Note that this flag is never assumed to be true for a device that was never opened - See constructor for details!
-                retval = SUCCESS;
+        }
+    }
+    return retval;
+}
+
+// Opens the device having the given VID, PID and serial number, waiting up to the given timeout (in milliseconds) for it to be released by another process, instead of returning ERROR_BUSY immediately
+// Processes that open the device this way hold an advisory lock while the device is open, so that waiting processes are woken up as soon as it is closed (see MCP2210DeviceLock)
+// The holder of the lock, if any, can be obtained via MCP2210DeviceLock::holder(), for instance in order to report who is using the device
+// If the device is held by a process that does not use the lock, claiming the device is retried every 100 ms until the timeout expires
+// No lock is used if the transport is shared among processes, as is the case with the daemon
+// If no serial number is given, the first device is resolved beforehand, and then opened by its serial number, so that the lock always refers to the device actually claimed
+int MCP2210::open(quint16 vid, quint16 pid, const QString &serial, int timeout)
+{
+    Lock guard(this);
+    Lock priorityGuard(this, MCP2210Stats::PCHIGH);
+    int retval;
+    if (isOpen() || transport_->isShared()) {
+        retval = open(vid, pid, serial);
+    } else {
+        QElapsedTimer timer;
+        timer.start();
+        QString deviceSerial = serial;
+        if (serial.isEmpty()) {
+            int errcnt = 0;
+            QString errstr;
+            QStringList serials = transport_->listDevices(vid, pid, errcnt, errstr);
+            if (!serials.isEmpty()) {  // Otherwise, the device is not found, or cannot be told apart, and the given serial number is kept
+                deviceSerial = serials.first();
             }
         }
+        MCP2210DeviceLock *deviceLock = new MCP2210DeviceLock(vid, pid, deviceSerial);
+        deviceLock->lock(timeout);  // On timeout, a last attempt to claim the device is made regardless
+        retval = open(vid, pid, deviceSerial);
+        while (retval == ERROR_BUSY && timer.elapsed() < timeout) {
+            QThread::msleep(static_cast<unsigned long>(qMin<qint64>(BUSY_RETRY_INTERVAL, timeout - timer.elapsed())));
+            retval = open(vid, pid, deviceSerial);
+        }
+        if (retval == SUCCESS) {
+            delete deviceLock_;
+            deviceLock_ = deviceLock;
+        } else {
+            delete deviceLock;
+        }
     }
     return retval;
 }
 
+// Clears the HID transfer statistics
+void MCP2210::resetStats()
+{
+    if (stats_ != nullptr) {
+        stats_->reset();
+    }
+}
+
 // Reads a byte from the given EEPROM address
 quint8 MCP2210::readEEPROMByte(quint8 address, int &errcnt, QString &errstr)
 {
@@ -514,6 +909,8 @@ quint8 MCP2210::readEEPROMByte(quint8 address, int &errcnt, QString &errstr)
 // If an error occurs, the size of the vector will be smaller than expected
 QVector<quint8> MCP2210::readEEPROMRange(quint8 begin, quint8 end, int &errcnt, QString &errstr)
 {
+    Lock guard(this);
+    MCP2210TraceSpan span("readEEPROMRange", "eeprom");
     QVector<quint8> values;
     if (begin > end) {
         ++errcnt;
@@ -545,6 +942,7 @@ quint8 MCP2210::resetEventCounter(int &errcnt, QString &errstr)
 // Sets the value of a given GPIO pin on the MCP2210
 quint8 MCP2210::setGPIO(int gpio, bool value, int &errcnt, QString &errstr)
 {
+    Lock guard(this, MCP2210Stats::PCHIGH);
     quint8 retval;
     if (gpio < GPIO0 || gpio > GPIO7) {
         ++errcnt;
@@ -571,6 +969,7 @@ quint8 MCP2210::setGPIO(int gpio, bool value, int &errcnt, QString &errstr)
 // Sets the direction of a given GPIO pin on the MCP2210
 quint8 MCP2210::setGPIODirection(int gpio, bool direction, int &errcnt, QString &errstr)
 {
+    Lock guard(this, MCP2210Stats::PCHIGH);
     quint8 retval;
     if (gpio < GPIO0 || gpio > GPIO7) {
         ++errcnt;
@@ -616,10 +1015,66 @@ quint8 MCP2210::setGPIOs(quint16 values, int &errcnt, QString &errstr)
     return response.at(1);
 }
 
+// Enables automatic reconnection with the given timeout, in milliseconds, or disables it if the timeout is negative (disabled by default)
+// While enabled, a disconnection detected during a command makes the device be reopened, by retrying every 100 ms until the timeout expires
+// Once reopened, the volatile state is restored by replaying the last successful commands that changed the chip settings, GPIO values, GPIO directions and SPI settings
+// The interrupted command is then resent and, if successful, no error is reported (except for SPI transfers, which are not resumed)
+// In thread-safe mode, other packets wait for the reconnection, since it holds the USB interface, but the timeout applies to the whole outage, so they are never delayed by more than one timeout
+// The device is identified by the same VID, PID and serial number given to open(), so a serial number should be given if several devices share the same VID and PID
+// Note that this function must be called before the object is shared between threads
+void MCP2210::setAutoReconnect(int timeout)
+{
+    reconnectTimeout_ = timeout < 0 ? -1 : timeout;
+}
+
+// Enables read coalescing with the given freshness window, in milliseconds, or disables it if the window is negative (disabled by default)
+// While enabled, a status query issued by getChipStatus(), getEventCount(), getGPIODirections() or getGPIOs() (or any function based on them) is not sent to the device if an identical query is in flight, or if one was sent within the freshness window
+// In such case, the response to that query is shared, which reduces the load on the device when several threads poll it independently
+// A window of zero shares only queries in flight, which never returns a result older than the call itself
+// Any other command (e.g. setGPIOs()) invalidates all responses obtained until then
+// Note that the first call should be done before the object is shared between threads
+void MCP2210::setCoalescingWindow(int msecs)
+{
+    if (coalescer_ == nullptr && msecs >= 0) {
+        coalescer_ = new MCP2210Coalescer;
+    }
+    if (coalescer_ != nullptr) {
+        coalescer_->setWindow(msecs);
+    }
+}
+
+// Enables or disables the recording of HID transfer statistics (disabled by default)
+// Statistics are preserved while disabled, and can be retrieved at any time via statsSnapshot()
+// Note that the first call should be done before the object is shared between threads
+void MCP2210::setStatsEnabled(bool enabled)
+{
+    if (stats_ == nullptr && enabled) {
+        stats_ = new MCP2210Stats;
+    }
+    if (stats_ != nullptr) {
+        stats_->setEnabled(enabled);
+    }
+}
+
+// Enables or disables the thread-safe mode (disabled by default)
+// In thread-safe mode, concurrent callers are serialized, so that each HID command and its response are never interleaved with those of another thread
+// Compound operations (e.g. toggleGPIO() or readEEPROMRange()) are also atomic in this mode, with respect to operations of the same priority class
+// GPIO commands and "CANCEL_SPI_TRANSFER" belong to the high priority class, and preempt other operations at the next packet boundary
+// Thus, a latency-critical call such as setGPIO() waits for at most one packet of an ongoing EEPROM or multi-chunk SPI loop, instead of the whole loop
+// The single exception is "SET_CHIP_SETTINGS" (see configureChipSettings()), which also takes the high priority lock, since it overwrites the GPIO values and directions
+// Queueing delays per priority class are reported by statsSnapshot(), while statistics are enabled
+// While the mode is disabled, no locking takes place at all, so single-threaded users are not penalized
+// Note that this function must be called before the object is shared between threads
+void MCP2210::setThreadSafe(bool enabled)
+{
+    threadSafe_ = enabled;
+}
+
 // Performs a basic SPI transfer
 // Note that the variable "status" is used to return either the SPI transfer engine status or, in case of error, the HID command response
 QVector<quint8> MCP2210::spiTransfer(const QVector<quint8> &data, quint8 &status, int &errcnt, QString &errstr)
 {
+    MCP2210TraceSpan span("spiTransfer", "spi");
     QVector<quint8> retdata;
     size_t bytesToSend = static_cast<size_t>(data.size());
     if (bytesToSend > SPIDATA_MAXSIZE) {
@@ -650,6 +1105,7 @@ QVector<quint8> MCP2210::spiTransfer(const QVector<quint8> &data, quint8 &status
 // Toggles (inverts the value of) a given GPIO pin on the MCP2210
 quint8 MCP2210::toggleGPIO(int gpio, int &errcnt, QString &errstr)
 {
+    Lock guard(this, MCP2210Stats::PCHIGH);
     quint8 retval;
     if (gpio < GPIO0 || gpio > GPIO7) {
         ++errcnt;
@@ -673,6 +1129,15 @@ quint8 MCP2210::toggleGPIO(int gpio, int &errcnt, QString &errstr)
     return retval;
 }
 
+// Unlocks the object, after a previous call to lock()
+// Note that the thread-safe mode must not be changed between calls to lock() and unlock()
+void MCP2210::unlock()
+{
+    if (threadSafe_) {
+        mutex_.unlock();
+    }
+}
+
 // Sends password over to the MCP2210
 // This function should be called before modifying a setting in the NVRAM, if a password is set
 quint8 MCP2210::usePassword(const QString &password, int &errcnt, QString &errstr)
@@ -715,6 +1180,8 @@ quint8 MCP2210::writeEEPROMByte(quint8 address, quint8 value, int &errcnt, QStri
 // Writes over the EEPROM, within the specified range and based on the given vector
 quint8 MCP2210::writeEEPROMRange(quint8 begin, quint8 end, const QVector<quint8> &values, int &errcnt, QString &errstr)
 {
+    Lock guard(this);
+    MCP2210TraceSpan span("writeEEPROMRange", "eeprom");
     quint8 retval;
     if (begin > end) {
         ++errcnt;
@@ -774,28 +1241,17 @@ quint8 MCP2210::writeNVChipSettings(const ChipSettings &settings, quint8 accessC
         errstr += "In writeNVChipSettings(): password cannot have non-latin characters.\n";  // Program logic error
         retval = OTHER_ERROR;
     } else {
-        QVector<quint8> command(passwordLength + 19);
-        command[0] = SET_NVRAM_SETTINGS;                                                                                // Header
-        command[1] = NV_CHIP_SETTINGS;
-        command[4] = settings.gp0;                                                                                      // GP0 pin configuration
-        command[5] = settings.gp1;                                                                                      // GP1 pin configuration
-        command[6] = settings.gp2;                                                                                      // GP2 pin configuration
-        command[7] = settings.gp3;                                                                                      // GP3 pin configuration
-        command[8] = settings.gp4;                                                                                      // GP4 pin configuration
-        command[9] = settings.gp5;                                                                                      // GP5 pin configuration
-        command[10] = settings.gp6;                                                                                     // GP6 pin configuration
-        command[11] = settings.gp7;                                                                                     // GP7 pin configuration
-        command[12] = settings.gp8,                                                                                     // GP8 pin configuration
-        command[13] = settings.gpout;                                                                                   // Default GPIO outputs (GPIO7 to GPIO0)
-        command[15] = settings.gpdir;                                                                                   // Default GPIO directions (GPIO7 to GPIO0)
-        command[16] = 0x01;
-        command[17] = static_cast<quint8>(settings.rmwakeup << 4 | (0x07 & settings.intmode) << 1 | settings.nrelspi);  // Other chip settings
-        command[18] = accessControlMode;                                                                                // Access control mode
+        unsigned char command[COMMAND_SIZE] = {
+            SET_NVRAM_SETTINGS, NV_CHIP_SETTINGS  // Header (unused indexes are filled with zeros)
+        };
+        MCP2210Codec::ChipSettingsLayout::encode(settings, command);
+        command[18] = accessControlMode;  // Access control mode
         for (int i = 0; i < passwordLength; ++i) {
             command[i + 19] = static_cast<quint8>(passwordLatin1[i]);
         }
-        QVector<quint8> response = hidTransfer(command, errcnt, errstr);
-        retval = response.at(1);
+        unsigned char response[COMMAND_SIZE];
+        transferPacket(command, response, errcnt, errstr);
+        retval = response[1];
     }
     return retval;
 }
@@ -810,20 +1266,13 @@ quint8 MCP2210::writeNVChipSettings(const ChipSettings &settings, int &errcnt, Q
 // Writes the given SPI transfer settings to the MCP2210 OTP NVRAM
 quint8 MCP2210::writeNVSPISettings(const SPISettings &settings, int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        SET_NVRAM_SETTINGS, NV_SPI_SETTINGS, 0x00, 0x00,                                           // Header
-        static_cast<quint8>(settings.bitrate), static_cast<quint8>(settings.bitrate >> 8),         // Bit rate
-        static_cast<quint8>(settings.bitrate >> 16), static_cast<quint8>(settings.bitrate >> 24),
-        settings.idlcs, 0x00,                                                                      // Idle chip select (CS7 to CS0)
-        settings.actcs, 0x00,                                                                      // Active chip select (CS7 to CS0)
-        static_cast<quint8>(settings.csdtdly), static_cast<quint8>(settings.csdtdly >> 8),         // Chip select to data delay
-        static_cast<quint8>(settings.dtcsdly), static_cast<quint8>(settings.dtcsdly >> 8),         // Data to chip select delay
-        static_cast<quint8>(settings.itbytdly), static_cast<quint8>(settings.itbytdly >> 8),       // Inter-byte delay
-        static_cast<quint8>(settings.nbytes), static_cast<quint8>(settings.nbytes >> 8),           // Number of bytes per SPI transaction
-        settings.mode                                                                              // SPI mode
+    unsigned char command[COMMAND_SIZE] = {
+        SET_NVRAM_SETTINGS, NV_SPI_SETTINGS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
-    return response.at(1);
+    MCP2210Codec::SPISettingsLayout::encode(settings, command);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
+    return response[1];
 }
 
 // Writes the product descriptor to the MCP2210 OTP NVRAM
@@ -843,47 +1292,20 @@ quint8 MCP2210::writeProductDesc(const QString &product, int &errcnt, QString &e
 // Writes the USB parameters to the MCP2210 OTP NVRAM
 quint8 MCP2210::writeUSBParameters(const USBParameters &parameters, int &errcnt, QString &errstr)
 {
-    QVector<quint8> command{
-        SET_NVRAM_SETTINGS, USB_PARAMETERS, 0x00, 0x00,                                                      // Header
-        static_cast<quint8>(parameters.vid), static_cast<quint8>(parameters.vid >> 8),                       // Vendor ID
-        static_cast<quint8>(parameters.pid), static_cast<quint8>(parameters.pid >> 8),                       // Product ID
-        static_cast<quint8>(!parameters.powmode << 7 | parameters.powmode << 6 | parameters.rmwakeup << 5),  // Chip power options
-        parameters.maxpow                                                                                    // Maximum consumption current
+    unsigned char command[COMMAND_SIZE] = {
+        SET_NVRAM_SETTINGS, USB_PARAMETERS  // Header (unused indexes are filled with zeros)
     };
-    QVector<quint8> response = hidTransfer(command, errcnt, errstr);
-    return response.at(1);
+    MCP2210Codec::USBParametersWriteLayout::encode(parameters, command);
+    unsigned char response[COMMAND_SIZE];
+    transferPacket(command, response, errcnt, errstr);
+    return response[1];
 }
 
-// Helper function to list devices
+// Helper function to list devices, using the default transport
 QStringList MCP2210::listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr)
 {
-    QStringList devices;
-    libusb_context *context;
-    if (libusb_init(&context) != 0) {  // Initialize libusb. In case of failure
-        ++errcnt;
-        errstr += QObject::tr("Could not initialize libusb.\n");
-    } else {  // If libusb is initialized
-        libusb_device **devs;
-        ssize_t devlist = libusb_get_device_list(context, &devs);  // Get a device list
-        if (devlist < 0) {  // If the previous operation fails to get a device list
-            ++errcnt;
-            errstr += QObject::tr("Failed to retrieve a list of devices.\n");
-        } else {
-            for (ssize_t i = 0; i < devlist; ++i) {  // Run through all listed devices
-                libusb_device_descriptor desc;
-                if (libusb_get_device_descriptor(devs[i], &desc) == 0 && desc.idVendor == vid && desc.idProduct == pid) {  // If the device descriptor is retrieved, and both VID and PID correspond to the respective given values
-                    libusb_device_handle *handle;
-                    if (libusb_open(devs[i], &handle) == 0) {  // Open the listed device. If successfull
-                        unsigned char str_desc[256];
-                        libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, str_desc, static_cast<int>(sizeof(str_desc)));  // Get the serial number string in ASCII format
-                        devices += reinterpret_cast<char *>(str_desc);  // Append the serial number string to the list
-                        libusb_close(handle);  // Close the device
-                    }
-                }
-            }
-            libusb_free_device_list(devs, 1);  // Free device list
-        }
-        libusb_exit(context);  // Deinitialize libusb
-    }
+    MCP2210Transport *transport = MCP2210Transport::create();
+    QStringList devices = transport->listDevices(vid, pid, errcnt, errstr);
+    delete transport;
     return devices;
 }
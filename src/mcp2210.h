@@ -22,22 +22,100 @@
 #define MCP2210_H
 
 // Includes
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QString>
 #include <QStringList>
 #include <QVector>
-#include <libusb-1.0/libusb.h>
+#include <QWaitCondition>
+#include "mcp2210stats.h"
+#include "mcp2210transport.h"
+
+// Forward declarations
+class MCP2210Coalescer;
+class MCP2210DeviceLock;
 
 class MCP2210
 {
 private:
-    libusb_context *context_;
-    libusb_device_handle *handle_;
-    bool disconnected_, kernelWasAttached_;
+    // Guard that locks the object for operations of the given priority class while in scope, but only if the thread-safe mode is enabled
+    // Operations of different priority classes are only serialized per packet (see BusGrant)
+    // Whenever both classes are locked by the same thread, the normal class must be locked first, so that threads never wait on each other in a cycle
+    class Lock
+    {
+    private:
+        const MCP2210 *mcp2210_;
+        int priorityClass_;
+        bool locked_;
+
+    public:
+        explicit Lock(const MCP2210 *mcp2210, int priorityClass = MCP2210Stats::PCNORMAL);
+        Lock(const Lock &) = delete;
+        ~Lock();
+
+        Lock &operator =(const Lock &) = delete;
+    };
+
+    // Guard that grants exclusive access to the USB interface for a single packet exchange, but only if the thread-safe mode is enabled
+    // Whenever the interface becomes free, waiting packets of the high priority class are granted access before any others
+    class BusGrant
+    {
+    private:
+        MCP2210 *mcp2210_;
+        bool granted_;
+
+    public:
+        BusGrant(MCP2210 *mcp2210, int priorityClass);
+        BusGrant(const BusGrant &) = delete;
+        ~BusGrant();
+
+        BusGrant &operator =(const BusGrant &) = delete;
+    };
+
+    // Last successful command of a kind that changes the volatile state, to be replayed after reconnecting
+    struct RestorePacket {
+        quint64 sequence;  // Order in which the command was sent (zero if none was sent)
+        unsigned char command[64];
+    };
 
+    MCP2210Transport *transport_;
+    MCP2210Stats *stats_;
+    MCP2210Coalescer *coalescer_;
+    MCP2210DeviceLock *deviceLock_;
+    MCP2210Stats::ReconnectStats reconnectStats_;
+    QAtomicInteger<quint64> completedExchanges_;
+    bool disconnected_;
+    bool threadSafe_;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    mutable QRecursiveMutex mutex_;
+    mutable QRecursiveMutex priorityMutex_;
+#else
+    mutable QMutex mutex_{QMutex::Recursive};
+    mutable QMutex priorityMutex_{QMutex::Recursive};
+#endif
+    QMutex busMutex_;
+    QWaitCondition busCondition_;
+    bool busBusy_;
+    int busHighWaiters_;
+    quint16 vid_;
+    quint16 pid_;
+    QString serial_;
+    int reconnectTimeout_;
+    QElapsedTimer outageTimer_;      // Started when a disconnection is detected, and invalidated once the device is reopened (see reconnect())
+    mutable QMutex reconnectMutex_;  // Protects "reconnectStats_", which is updated by packets of both priority classes
+    RestorePacket restorePackets_[4];
+    quint64 restoreSequence_;
+
+    void exchangePacket(const unsigned char *command, unsigned char *response, int &errcnt, QString &errstr);
     QString getDescGeneric(quint8 subcomid, int &errcnt, QString &errstr);
-    void interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, int &errcnt, QString &errstr);
+    int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, int &errcnt, QString &errstr);
+    bool reconnect(int &errcnt, QString &errstr);
+    void transferPacket(const unsigned char *command, unsigned char *response, int &errcnt, QString &errstr);
     quint8 writeDescGeneric(const QString &descriptor, quint8 subcomid, int &errcnt, QString &errstr);
 
+    static int priorityClass(quint8 command);
+
 public:
     // Class definitions
     static const quint16 VID = 0x04d8;                                   // Default USB vendor ID
@@ -46,6 +124,7 @@ public:
     static const int ERROR_INIT = 1;                                     // Returned by open() in case of a libusb initialization failure
     static const int ERROR_NOT_FOUND = 2;                                // Returned by open() if the device was not found
     static const int ERROR_BUSY = 3;                                     // Returned by open() if the device is already in use
+    static const int ERROR_ACCESS = 4;                                   // Returned by open() if access to the device was denied (hidraw transport only)
     static const size_t COMMAND_SIZE = 64;                               // HID command size
     static const size_t PREAMBLE_SIZE = 4;                               // HID command preamble size
     static const size_t SPIDATA_MAXSIZE = COMMAND_SIZE - PREAMBLE_SIZE;  // Maximum size of the data vector [60] for a single SPI transfer (only applicable to basic SPI transfers)
@@ -263,10 +342,21 @@ public:
     };
 
     MCP2210();
+    explicit MCP2210(MCP2210Transport *transport);
+    MCP2210(const MCP2210 &) = delete;
     ~MCP2210();
 
+    MCP2210 &operator =(const MCP2210 &) = delete;
+
+    quint64 coalescedReads() const;
+    int coalescingWindow() const;
+    quint64 completedExchanges() const;
     bool disconnected() const;
     bool isOpen() const;
+    bool isThreadSafe() const;
+    int reconnectTimeout() const;
+    MCP2210Stats::ReconnectStats reconnectStats() const;
+    MCP2210Stats::Snapshot statsSnapshot() const;
 
     quint8 cancelSPITransfer(int &errcnt, QString &errstr);
     void close();
@@ -287,16 +377,24 @@ public:
     SPISettings getSPISettings(int &errcnt, QString &errstr);
     USBParameters getUSBParameters(int &errcnt, QString &errstr);
     QVector<quint8> hidTransfer(const QVector<quint8> &data, int &errcnt, QString &errstr);
+    void lock();
     int open(quint16 vid, quint16 pid, const QString &serial = QString());
+    int open(quint16 vid, quint16 pid, const QString &serial, int timeout);
     quint8 readEEPROMByte(quint8 address, int &errcnt, QString &errstr);
     QVector<quint8> readEEPROMRange(quint8 begin, quint8 end, int &errcnt, QString &errstr);
     quint8 resetEventCounter(int &errcnt, QString &errstr);
+    void resetStats();
     quint8 setGPIO(int gpio, bool value, int &errcnt, QString &errstr);
     quint8 setGPIODirection(int gpio, bool direction, int &errcnt, QString &errstr);
     quint8 setGPIODirections(quint8 directions, int &errcnt, QString &errstr);
     quint8 setGPIOs(quint16 values, int &errcnt, QString &errstr);
+    void setAutoReconnect(int timeout);
+    void setCoalescingWindow(int msecs);
+    void setStatsEnabled(bool enabled);
+    void setThreadSafe(bool enabled);
     QVector<quint8> spiTransfer(const QVector<quint8> &data, quint8 &status, int &errcnt, QString &errstr);
     quint8 toggleGPIO(int gpio, int &errcnt, QString &errstr);
+    void unlock();
     quint8 usePassword(const QString &password, int &errcnt, QString &errstr);
     quint8 writeEEPROMByte(quint8 address, quint8 value, int &errcnt, QString &errstr);
     quint8 writeEEPROMRange(quint8 begin, quint8 end, const QVector<quint8> &values, int &errcnt, QString &errstr);
@@ -0,0 +1,329 @@
+/* MCP2210 asynchronous facade for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include "mcp2210async.h"
+
+// Creates a facade for the device referenced by the given handle, taking ownership of that handle
+MCP2210Async::MCP2210Async(MCP2210Pool::Handle &&handle, QObject *parent) :
+    QObject(parent),
+    handle_(std::move(handle)),
+    shared_(new Shared)
+{
+    shared_->owner = this;
+}
+
+// Pending operations still run after the facade is destroyed, and their futures still finish, but no signals are emitted
+MCP2210Async::~MCP2210Async()
+{
+    QMutexLocker locker(&shared_->mutex);
+    shared_->owner = nullptr;
+}
+
+// Returns the underlying pool handle
+MCP2210Pool::Handle &MCP2210Async::handle()
+{
+    return handle_;
+}
+
+// Checks if the facade is valid (i.e., if it references an open device)
+bool MCP2210Async::isValid() const
+{
+    return handle_.isValid();
+}
+
+// Cancels the ongoing SPI transfer
+QFuture<MCP2210Result<quint8>> MCP2210Async::cancelSPITransfer()
+{
+    return call<quint8>("cancelSPITransfer", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.cancelSPITransfer(errcnt, errstr);
+    });
+}
+
+// Configures volatile chip settings
+QFuture<MCP2210Result<quint8>> MCP2210Async::configureChipSettings(const MCP2210::ChipSettings &settings)
+{
+    return call<quint8>("configureChipSettings", [settings](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.configureChipSettings(settings, errcnt, errstr);
+    });
+}
+
+// Configures volatile SPI transfer settings
+QFuture<MCP2210Result<quint8>> MCP2210Async::configureSPISettings(const MCP2210::SPISettings &settings)
+{
+    return call<quint8>("configureSPISettings", [settings](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.configureSPISettings(settings, errcnt, errstr);
+    });
+}
+
+// Retrieves the access control mode from the MCP2210 NVRAM
+QFuture<MCP2210Result<quint8>> MCP2210Async::getAccessControlMode()
+{
+    return call<quint8>("getAccessControlMode", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getAccessControlMode(errcnt, errstr);
+    });
+}
+
+// Retrieves the current chip settings
+QFuture<MCP2210Result<MCP2210::ChipSettings>> MCP2210Async::getChipSettings()
+{
+    return call<MCP2210::ChipSettings>("getChipSettings", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getChipSettings(errcnt, errstr);
+    });
+}
+
+// Retrieves the chip status
+QFuture<MCP2210Result<MCP2210::ChipStatus>> MCP2210Async::getChipStatus()
+{
+    return call<MCP2210::ChipStatus>("getChipStatus", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getChipStatus(errcnt, errstr);
+    });
+}
+
+// Retrieves the number of events from the interrupt pin
+QFuture<MCP2210Result<quint16>> MCP2210Async::getEventCount()
+{
+    return call<quint16>("getEventCount", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getEventCount(errcnt, errstr);
+    });
+}
+
+// Retrieves the directions of all GPIO pins
+QFuture<MCP2210Result<quint8>> MCP2210Async::getGPIODirections()
+{
+    return call<quint8>("getGPIODirections", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getGPIODirections(errcnt, errstr);
+    });
+}
+
+// Retrieves the values of all GPIO pins
+QFuture<MCP2210Result<quint16>> MCP2210Async::getGPIOs()
+{
+    return call<quint16>("getGPIOs", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getGPIOs(errcnt, errstr);
+    });
+}
+
+// Gets the manufacturer descriptor from the MCP2210 NVRAM
+QFuture<MCP2210Result<QString>> MCP2210Async::getManufacturerDesc()
+{
+    return call<QString>("getManufacturerDesc", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getManufacturerDesc(errcnt, errstr);
+    });
+}
+
+// Retrieves the power-up chip settings from the MCP2210 NVRAM
+QFuture<MCP2210Result<MCP2210::ChipSettings>> MCP2210Async::getNVChipSettings()
+{
+    return call<MCP2210::ChipSettings>("getNVChipSettings", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getNVChipSettings(errcnt, errstr);
+    });
+}
+
+// Retrieves the power-up SPI transfer settings from the MCP2210 NVRAM
+QFuture<MCP2210Result<MCP2210::SPISettings>> MCP2210Async::getNVSPISettings()
+{
+    return call<MCP2210::SPISettings>("getNVSPISettings", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getNVSPISettings(errcnt, errstr);
+    });
+}
+
+// Gets the product descriptor from the MCP2210 NVRAM
+QFuture<MCP2210Result<QString>> MCP2210Async::getProductDesc()
+{
+    return call<QString>("getProductDesc", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getProductDesc(errcnt, errstr);
+    });
+}
+
+// Retrieves the current SPI transfer settings
+QFuture<MCP2210Result<MCP2210::SPISettings>> MCP2210Async::getSPISettings()
+{
+    return call<MCP2210::SPISettings>("getSPISettings", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getSPISettings(errcnt, errstr);
+    });
+}
+
+// Retrieves the USB parameters
+QFuture<MCP2210Result<MCP2210::USBParameters>> MCP2210Async::getUSBParameters()
+{
+    return call<MCP2210::USBParameters>("getUSBParameters", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.getUSBParameters(errcnt, errstr);
+    });
+}
+
+// Writes the given configuration to the MCP2210 NVRAM, and reads it back for verification, in a single operation
+// The given password is only used if the configuration sets the access control mode to "ACPASSWORD", in which case it becomes the new password
+// The resulting value is the configuration read back from the device, and an error is reported if it does not match the given configuration
+QFuture<MCP2210Result<Configuration>> MCP2210Async::provision(const Configuration &configuration, const QString &password)
+{
+    return call<Configuration>("provision", [configuration, password](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        Configuration deviceConfiguration;
+        int preverrcnt = errcnt;
+        mcp2210.writeManufacturerDesc(configuration.manufacturer, errcnt, errstr);
+        if (errcnt == preverrcnt) {
+            mcp2210.writeProductDesc(configuration.product, errcnt, errstr);
+        }
+        if (errcnt == preverrcnt) {
+            mcp2210.writeUSBParameters(configuration.usbParameters, errcnt, errstr);
+        }
+        if (errcnt == preverrcnt) {
+            mcp2210.writeNVSPISettings(configuration.spiSettings, errcnt, errstr);
+        }
+        if (errcnt == preverrcnt) {  // The chip settings are written last, since this may protect or even lock the device (as done by ConfiguratorWindow)
+            mcp2210.writeNVChipSettings(configuration.chipSettings, configuration.accessMode, configuration.accessMode == MCP2210::ACPASSWORD ? password : QString(), errcnt, errstr);
+        }
+        if (errcnt == preverrcnt) {
+            deviceConfiguration = readConfiguration(mcp2210, errcnt, errstr);
+            if (errcnt == preverrcnt && deviceConfiguration != configuration) {
+                ++errcnt;
+                errstr += QObject::tr("Failed verification.\n");
+            }
+        }
+        return deviceConfiguration;
+    });
+}
+
+// Reads the whole configuration from the MCP2210 NVRAM, as a consistent snapshot (no other operations on the device can run in between)
+QFuture<MCP2210Result<Configuration>> MCP2210Async::readConfiguration()
+{
+    return call<Configuration>("readConfiguration", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return readConfiguration(mcp2210, errcnt, errstr);
+    });
+}
+
+// Reads the whole MCP2210 EEPROM
+QFuture<MCP2210Result<MCP2210EEPROM>> MCP2210Async::readEEPROM()
+{
+    return call<MCP2210EEPROM>("readEEPROM", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        MCP2210EEPROM eeprom;
+        QVector<quint8> values = mcp2210.readEEPROMRange(0, MCP2210::EEPROM_SIZE - 1, errcnt, errstr);
+        for (size_t i = 0; i < MCP2210::EEPROM_SIZE; ++i) {
+            eeprom.bytes[i] = i < static_cast<size_t>(values.size()) ? values[i] : 0x00;  // On failure, the remaining bytes are zeroed
+        }
+        return eeprom;
+    });
+}
+
+// Resets the interrupt event counter
+QFuture<MCP2210Result<quint8>> MCP2210Async::resetEventCounter()
+{
+    return call<quint8>("resetEventCounter", [](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.resetEventCounter(errcnt, errstr);
+    });
+}
+
+// Sets the directions of all GPIO pins
+QFuture<MCP2210Result<quint8>> MCP2210Async::setGPIODirections(quint8 directions)
+{
+    return call<quint8>("setGPIODirections", [directions](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.setGPIODirections(directions, errcnt, errstr);
+    });
+}
+
+// Sets the values of all GPIO pins
+QFuture<MCP2210Result<quint8>> MCP2210Async::setGPIOs(quint16 values)
+{
+    return call<quint8>("setGPIOs", [values](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.setGPIOs(values, errcnt, errstr);
+    });
+}
+
+// Performs a basic SPI transfer (the SPI transfer status is not reported, since the transfer is complete once the operation finishes without errors)
+QFuture<MCP2210Result<QVector<quint8>>> MCP2210Async::spiTransfer(const QVector<quint8> &data)
+{
+    return call<QVector<quint8>>("spiTransfer", [data](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        quint8 status;
+        return mcp2210.spiTransfer(data, status, errcnt, errstr);
+    });
+}
+
+// Sends password over to the MCP2210
+QFuture<MCP2210Result<quint8>> MCP2210Async::usePassword(const QString &password)
+{
+    return call<quint8>("usePassword", [password](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.usePassword(password, errcnt, errstr);
+    });
+}
+
+// Writes the whole MCP2210 EEPROM
+QFuture<MCP2210Result<quint8>> MCP2210Async::writeEEPROM(const MCP2210EEPROM &eeprom)
+{
+    return call<quint8>("writeEEPROM", [eeprom](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        QVector<quint8> values(static_cast<int>(MCP2210::EEPROM_SIZE));
+        for (size_t i = 0; i < MCP2210::EEPROM_SIZE; ++i) {
+            values[static_cast<int>(i)] = eeprom.bytes[i];
+        }
+        return mcp2210.writeEEPROMRange(0, MCP2210::EEPROM_SIZE - 1, values, errcnt, errstr);
+    });
+}
+
+// Writes the manufacturer descriptor to the MCP2210 NVRAM
+QFuture<MCP2210Result<quint8>> MCP2210Async::writeManufacturerDesc(const QString &manufacturer)
+{
+    return call<quint8>("writeManufacturerDesc", [manufacturer](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.writeManufacturerDesc(manufacturer, errcnt, errstr);
+    });
+}
+
+// Writes the given chip settings, access control mode and password to the MCP2210 NVRAM
+QFuture<MCP2210Result<quint8>> MCP2210Async::writeNVChipSettings(const MCP2210::ChipSettings &settings, quint8 accessControlMode, const QString &password)
+{
+    return call<quint8>("writeNVChipSettings", [settings, accessControlMode, password](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.writeNVChipSettings(settings, accessControlMode, password, errcnt, errstr);
+    });
+}
+
+// Writes the given SPI transfer settings to the MCP2210 NVRAM
+QFuture<MCP2210Result<quint8>> MCP2210Async::writeNVSPISettings(const MCP2210::SPISettings &settings)
+{
+    return call<quint8>("writeNVSPISettings", [settings](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.writeNVSPISettings(settings, errcnt, errstr);
+    });
+}
+
+// Writes the product descriptor to the MCP2210 NVRAM
+QFuture<MCP2210Result<quint8>> MCP2210Async::writeProductDesc(const QString &product)
+{
+    return call<quint8>("writeProductDesc", [product](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.writeProductDesc(product, errcnt, errstr);
+    });
+}
+
+// Writes the given USB parameters to the MCP2210 NVRAM
+QFuture<MCP2210Result<quint8>> MCP2210Async::writeUSBParameters(const MCP2210::USBParameters &parameters)
+{
+    return call<quint8>("writeUSBParameters", [parameters](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        return mcp2210.writeUSBParameters(parameters, errcnt, errstr);
+    });
+}
+
+// Reads the whole configuration from the MCP2210 NVRAM, synchronously
+Configuration MCP2210Async::readConfiguration(MCP2210 &mcp2210, int &errcnt, QString &errstr)
+{
+    Configuration configuration;
+    configuration.manufacturer = mcp2210.getManufacturerDesc(errcnt, errstr);
+    configuration.product = mcp2210.getProductDesc(errcnt, errstr);
+    configuration.usbParameters = mcp2210.getUSBParameters(errcnt, errstr);
+    configuration.chipSettings = mcp2210.getNVChipSettings(errcnt, errstr);
+    configuration.spiSettings = mcp2210.getNVSPISettings(errcnt, errstr);
+    configuration.accessMode = mcp2210.getAccessControlMode(errcnt, errstr);
+    return configuration;
+}
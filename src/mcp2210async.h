@@ -0,0 +1,137 @@
+/* MCP2210 asynchronous facade for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210ASYNC_H
+#define MCP2210ASYNC_H
+
+// Includes
+#include <functional>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include "configuration.h"
+#include "mcp2210.h"
+#include "mcp2210eeprom.h"
+#include "mcp2210pool.h"
+
+// Result of an asynchronous operation, following the usual error reporting convention
+template <typename T>
+struct MCP2210Result
+{
+    T value;
+    int errcnt;
+    QString errstr;
+};
+
+// Asynchronous facade for an MCP2210 device in a pool, meant for Qt applications that must not block their event loop
+// Every operation returns immediately with a QFuture, which finishes once the operation is run by the worker assigned to the device
+// Results can be obtained via QFutureWatcher, or via the operationFinished() signal, both being delivered by the Qt event loop (no polling is involved)
+// Operations on the same device run in the order they were issued
+class MCP2210Async : public QObject
+{
+    Q_OBJECT
+
+private:
+    // State shared with pending operations, which allows them to outlive the facade
+    struct Shared {
+        QMutex mutex;
+        MCP2210Async *owner;
+    };
+
+    MCP2210Pool::Handle handle_;
+    QSharedPointer<Shared> shared_;
+
+public:
+    explicit MCP2210Async(MCP2210Pool::Handle &&handle, QObject *parent = nullptr);
+    ~MCP2210Async();
+
+    MCP2210Pool::Handle &handle();
+    bool isValid() const;
+
+    template <typename T>
+    QFuture<MCP2210Result<T>> call(const QString &operation, const std::function<T(MCP2210 &, int &, QString &)> &function);
+
+    QFuture<MCP2210Result<quint8>> cancelSPITransfer();
+    QFuture<MCP2210Result<quint8>> configureChipSettings(const MCP2210::ChipSettings &settings);
+    QFuture<MCP2210Result<quint8>> configureSPISettings(const MCP2210::SPISettings &settings);
+    QFuture<MCP2210Result<quint8>> getAccessControlMode();
+    QFuture<MCP2210Result<MCP2210::ChipSettings>> getChipSettings();
+    QFuture<MCP2210Result<MCP2210::ChipStatus>> getChipStatus();
+    QFuture<MCP2210Result<quint16>> getEventCount();
+    QFuture<MCP2210Result<quint8>> getGPIODirections();
+    QFuture<MCP2210Result<quint16>> getGPIOs();
+    QFuture<MCP2210Result<QString>> getManufacturerDesc();
+    QFuture<MCP2210Result<MCP2210::ChipSettings>> getNVChipSettings();
+    QFuture<MCP2210Result<MCP2210::SPISettings>> getNVSPISettings();
+    QFuture<MCP2210Result<QString>> getProductDesc();
+    QFuture<MCP2210Result<MCP2210::SPISettings>> getSPISettings();
+    QFuture<MCP2210Result<MCP2210::USBParameters>> getUSBParameters();
+    QFuture<MCP2210Result<Configuration>> provision(const Configuration &configuration, const QString &password);
+    QFuture<MCP2210Result<Configuration>> readConfiguration();
+    QFuture<MCP2210Result<MCP2210EEPROM>> readEEPROM();
+    QFuture<MCP2210Result<quint8>> resetEventCounter();
+    QFuture<MCP2210Result<quint8>> setGPIODirections(quint8 directions);
+    QFuture<MCP2210Result<quint8>> setGPIOs(quint16 values);
+    QFuture<MCP2210Result<QVector<quint8>>> spiTransfer(const QVector<quint8> &data);
+    QFuture<MCP2210Result<quint8>> usePassword(const QString &password);
+    QFuture<MCP2210Result<quint8>> writeEEPROM(const MCP2210EEPROM &eeprom);
+    QFuture<MCP2210Result<quint8>> writeManufacturerDesc(const QString &manufacturer);
+    QFuture<MCP2210Result<quint8>> writeNVChipSettings(const MCP2210::ChipSettings &settings, quint8 accessControlMode, const QString &password);
+    QFuture<MCP2210Result<quint8>> writeNVSPISettings(const MCP2210::SPISettings &settings);
+    QFuture<MCP2210Result<quint8>> writeProductDesc(const QString &product);
+    QFuture<MCP2210Result<quint8>> writeUSBParameters(const MCP2210::USBParameters &parameters);
+
+    static Configuration readConfiguration(MCP2210 &mcp2210, int &errcnt, QString &errstr);
+
+signals:
+    void operationFinished(const QString &operation, int errcnt, const QString &errstr);
+};
+
+// Runs the given function asynchronously on the device, returning a future for its result
+// This can be used for any operation or sequence of operations not covered by this class
+// The operationFinished() signal is emitted with the given operation name once the function returns, unless the facade was destroyed meanwhile
+template <typename T>
+QFuture<MCP2210Result<T>> MCP2210Async::call(const QString &operation, const std::function<T(MCP2210 &, int &, QString &)> &function)
+{
+    QFutureInterface<MCP2210Result<T>> futureInterface;
+    futureInterface.reportStarted();
+    QFuture<MCP2210Result<T>> future = futureInterface.future();
+    QSharedPointer<MCP2210Result<T>> result(new MCP2210Result<T>());
+    QSharedPointer<Shared> shared = shared_;
+    handle_.post([result, function](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+        result->value = function(mcp2210, errcnt, errstr);
+    }, [futureInterface, result, shared, operation](int errcnt, const QString &errstr) mutable {
+        result->errcnt = errcnt;
+        result->errstr = errstr;
+        futureInterface.reportFinished(result.data());
+        QMutexLocker locker(&shared->mutex);
+        if (shared->owner != nullptr) {
+            emit shared->owner->operationFinished(operation, errcnt, errstr);  // Delivered via a queued connection to receivers living in other threads
+        }
+    });
+    return future;
+}
+
+#endif  // MCP2210ASYNC_H
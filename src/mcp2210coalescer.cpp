@@ -0,0 +1,173 @@
+/* MCP2210 read coalescer for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cstring>
+#include <QMutexLocker>
+#include "mcp2210.h"
+#include "mcp2210coalescer.h"
+
+// Private function that checks if the given slot holds a completed response that can be shared with a query that arrived at the given time
+// A completed response is shareable if its query was sent within the freshness window before the arrival time (or after it), and after the last invalidation
+// Note that this does not apply to queries in flight, which are shared whatever the freshness window is (see take())
+bool MCP2210Coalescer::isShareable(const Slot &slot, qint64 arrival) const
+{
+    return slot.sentAt >= arrival - 1000000LL * window_.load() && slot.sentAt >= invalidatedAt_;  // Only called while enabled, so the window is never negative
+}
+
+// Private function that returns the slot index corresponding to the given command, or -1 if the command is not coalescable
+int MCP2210Coalescer::slotIndex(const unsigned char *command)
+{
+    int index;
+    if (command[0] == MCP2210::GET_CHIP_STATUS) {
+        index = 0;
+    } else if (command[0] == MCP2210::GET_GPIO_VALUES) {
+        index = 1;
+    } else if (command[0] == MCP2210::GET_GPIO_DIRECTIONS) {
+        index = 2;
+    } else if (command[0] == MCP2210::GET_EVENT_COUNT && command[1] == 0x01) {  // The event count query is only read-only if the counter is not reset
+        index = 3;
+    } else {
+        index = -1;
+    }
+    return index;
+}
+
+MCP2210Coalescer::MCP2210Coalescer() :
+    window_(0),
+    coalesced_(0),
+    invalidatedAt_(0)
+{
+    clock_.start();
+    for (int i = 0; i < SLOTS; ++i) {
+        slots_[i].errcnt = 0;
+        slots_[i].sentAt = 0;
+        slots_[i].generation = 0;
+        slots_[i].inFlight = false;
+        slots_[i].valid = false;
+    }
+}
+
+// Returns the number of queries that were answered without being sent to the device
+quint64 MCP2210Coalescer::coalesced() const
+{
+    return coalesced_.load();
+}
+
+// Returns the current time, in nanoseconds, as used for arrival times (see take())
+qint64 MCP2210Coalescer::now() const
+{
+    return clock_.nsecsElapsed();
+}
+
+// Checks if coalescing is enabled
+bool MCP2210Coalescer::isEnabled() const
+{
+    return window_.load() >= 0;
+}
+
+// Returns the freshness window, in milliseconds, or -1 if coalescing is disabled
+int MCP2210Coalescer::window() const
+{
+    return window_.load();
+}
+
+// Marks the given query as being in flight, so that identical queries may join it
+// This must be called by the thread that is about to send the query, only after it got exclusive access to the USB interface
+void MCP2210Coalescer::begin(const unsigned char *command)
+{
+    int index = slotIndex(command);
+    if (index >= 0) {
+        QMutexLocker locker(&mutex_);
+        Slot &slot = slots_[index];
+        slot.sentAt = clock_.nsecsElapsed();
+        slot.inFlight = true;
+        slot.valid = false;
+    }
+}
+
+// Stores the response to the given query, waking up any threads that joined it
+// If the command is not coalescable, all stored responses are invalidated instead
+void MCP2210Coalescer::finish(const unsigned char *command, const unsigned char *response, int errcnt, const QString &errstr)
+{
+    int index = slotIndex(command);
+    if (index < 0) {
+        invalidate();
+    } else {
+        QMutexLocker locker(&mutex_);
+        Slot &slot = slots_[index];
+        std::memcpy(slot.response, response, sizeof(slot.response));
+        slot.errcnt = errcnt;
+        slot.errstr = errstr;
+        slot.inFlight = false;
+        slot.valid = true;
+        ++slot.generation;
+        condition_.wakeAll();
+    }
+}
+
+// Invalidates all stored responses, including those of queries that are in flight
+void MCP2210Coalescer::invalidate()
+{
+    QMutexLocker locker(&mutex_);
+    invalidatedAt_ = clock_.nsecsElapsed();
+}
+
+// Sets the freshness window, in milliseconds (zero means that only queries in flight are shared, and a negative value disables coalescing)
+void MCP2210Coalescer::setWindow(int msecs)
+{
+    window_.store(msecs < 0 ? -1 : msecs);
+}
+
+// Tries to answer the given query, which arrived at the given time, without sending it to the device
+// If "join" is true and an identical query is in flight, the calling thread waits for its response
+// Any errors reported by the shared query are reported to the caller as well, and the function returns true if the query was answered
+bool MCP2210Coalescer::take(const unsigned char *command, unsigned char *response, qint64 arrival, bool join, int &errcnt, QString &errstr)
+{
+    bool taken = false;
+    int index = slotIndex(command);
+    if (index >= 0) {
+        QMutexLocker locker(&mutex_);
+        Slot &slot = slots_[index];
+        bool joined = join && slot.inFlight && slot.sentAt >= invalidatedAt_;  // A query in flight is shared whatever the freshness window is, since no newer response could be obtained any sooner
+        if (joined) {
+            quint64 generation = slot.generation;
+            while (slot.generation == generation) {
+                condition_.wait(&mutex_);
+            }
+        }
+        bool shareable = joined ? slot.sentAt >= invalidatedAt_ : isShareable(slot, arrival);  // The freshness window only applies to completed responses
+        if (slot.valid && !slot.inFlight && shareable && (slot.errcnt == 0 || joined)) {  // Failed responses are only shared with threads that joined the query
+            std::memcpy(response, slot.response, sizeof(slot.response));
+            errcnt += slot.errcnt;
+            errstr += slot.errstr;
+            coalesced_.fetchAndAddRelaxed(1);
+            taken = true;
+        }
+    }
+    return taken;
+}
+
+// Checks if the given command is a read-only query, so that identical copies issued at the same time can share a single response (as done by the MCP2210 daemon)
+// Only the queries that are typically polled have a slot in this coalescer (see slotIndex())
+bool MCP2210Coalescer::isCoalescable(const unsigned char *command)
+{
+    return slotIndex(command) >= 0 || command[0] == MCP2210::GET_CHIP_SETTINGS || command[0] == MCP2210::GET_SPI_SETTINGS || command[0] == MCP2210::READ_EEPROM || command[0] == MCP2210::GET_NVRAM_SETTINGS;
+}
@@ -0,0 +1,81 @@
+/* MCP2210 read coalescer for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210COALESCER_H
+#define MCP2210COALESCER_H
+
+// Includes
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+// Coalescer for read-only status queries ("GET_CHIP_STATUS", "GET_GPIO_VALUES", "GET_GPIO_DIRECTIONS" and "GET_EVENT_COUNT" without reset)
+// A query is answered without a USB round trip if an identical query is in flight, or if one was sent within the freshness window
+// Results obtained before the last command that is not coalescable (e.g. "SET_GPIO_VALUES") are never shared, since that command may have changed the state of the device
+class MCP2210Coalescer
+{
+private:
+    static const int SLOTS = 4;  // One slot per coalescable query
+
+    struct Slot {
+        unsigned char response[64];
+        int errcnt;          // Number of errors reported by the query
+        QString errstr;      // Errors reported by the query
+        qint64 sentAt;       // Time at which the query was sent (see now())
+        quint64 generation;  // Incremented each time the query completes
+        bool inFlight;       // The query is being sent by a thread
+        bool valid;          // The response is available for sharing
+    };
+
+    QMutex mutex_;
+    QWaitCondition condition_;
+    QElapsedTimer clock_;
+    QAtomicInteger<int> window_;
+    QAtomicInteger<quint64> coalesced_;
+    Slot slots_[SLOTS];
+    qint64 invalidatedAt_;
+
+    bool isShareable(const Slot &slot, qint64 arrival) const;
+
+    static int slotIndex(const unsigned char *command);
+
+public:
+    MCP2210Coalescer();
+    MCP2210Coalescer(const MCP2210Coalescer &) = delete;
+
+    MCP2210Coalescer &operator =(const MCP2210Coalescer &) = delete;
+
+    quint64 coalesced() const;
+    bool isEnabled() const;
+    qint64 now() const;
+    int window() const;
+
+    void begin(const unsigned char *command);
+    void finish(const unsigned char *command, const unsigned char *response, int errcnt, const QString &errstr);
+    void invalidate();
+    void setWindow(int msecs);
+    bool take(const unsigned char *command, unsigned char *response, qint64 arrival, bool join, int &errcnt, QString &errstr);
+
+    static bool isCoalescable(const unsigned char *command);
+};
+
+#endif  // MCP2210COALESCER_H
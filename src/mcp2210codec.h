@@ -0,0 +1,219 @@
+/* MCP2210 packet codec for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210CODEC_H
+#define MCP2210CODEC_H
+
+// Includes
+#include <QtGlobal>
+#include "mcp2210.h"
+
+// Table-driven codec for the fixed layout payloads of HID commands and responses
+// Each layout is a compile-time list of field descriptors, from which encode() and decode() are generated and fully inlined
+// Layouts are verified at compile time, so that no field can fall outside the 64-byte packet or overlap another field
+namespace MCP2210Codec
+{
+
+// Number of bits set in the given value
+constexpr int popCount(quint32 value)
+{
+    return value == 0 ? 0 : static_cast<int>(0x01 & value) + popCount(value >> 1);
+}
+
+// Descriptor of a struct member, stored in little-endian format at the given offset, using the given width in bytes
+// Single byte fields can also be bit fields, by specifying a shift and a mask, and boolean bit fields can be stored negated
+template <typename S, typename T, T S::*member, int offset, int width = sizeof(T), int shift = 0, quint32 mask = 0xff, bool negated = false>
+struct Field {
+    static_assert(offset >= static_cast<int>(MCP2210::PREAMBLE_SIZE) && offset + width <= static_cast<int>(MCP2210::COMMAND_SIZE), "Field must lie within the payload");
+    static_assert(width == 1 || width == 2 || width == 4, "Field width must be 1, 2 or 4 bytes");
+    static_assert(width == 1 || (shift == 0 && mask == 0xff), "Only single byte fields can be bit fields");
+    static_assert((mask << shift) <= 0xff, "Bit field must fit within its byte");
+
+    // Returns the bits occupied by the field within the byte at the given index
+    static constexpr quint32 occupancy(int index)
+    {
+        return index < offset || index >= offset + width ? 0x00 : (width == 1 ? mask << shift : 0xff);
+    }
+
+    static void decode(const unsigned char *packet, S &s)
+    {
+        quint32 value;
+        if (width == 4) {
+            value = static_cast<quint32>(packet[offset + 3] << 24 | packet[offset + 2] << 16 | packet[offset + 1] << 8 | packet[offset]);
+        } else if (width == 2) {
+            value = static_cast<quint32>(packet[offset + 1] << 8 | packet[offset]);
+        } else {
+            value = mask & (negated ? ~packet[offset] : packet[offset]) >> shift;
+        }
+        s.*member = static_cast<T>(value);
+    }
+
+    static void encode(const S &s, unsigned char *packet)
+    {
+        quint32 value = static_cast<quint32>(s.*member);
+        if (width == 1) {
+            packet[offset] = static_cast<unsigned char>(packet[offset] | (mask & (negated ? ~value : value)) << shift);  // Bit fields sharing the same byte are combined
+        } else {
+            for (int i = 0; i < width; ++i) {
+                packet[offset + i] = static_cast<unsigned char>(value >> 8 * i);
+            }
+        }
+    }
+};
+
+// Descriptor of a constant byte, which is written when encoding and ignored when decoding
+template <int offset, quint8 value>
+struct Constant {
+    static_assert(offset >= static_cast<int>(MCP2210::PREAMBLE_SIZE) && offset < static_cast<int>(MCP2210::COMMAND_SIZE), "Constant must lie within the payload");
+
+    // Returns the bits occupied by the constant within the byte at the given index
+    static constexpr quint32 occupancy(int index)
+    {
+        return index == offset ? 0xff : 0x00;
+    }
+
+    template <typename S>
+    static void decode(const unsigned char *, S &)
+    {
+    }
+
+    template <typename S>
+    static void encode(const S &, unsigned char *packet)
+    {
+        packet[offset] = value;
+    }
+};
+
+// Combined occupancy of a list of descriptors, used to detect overlapping fields
+template <typename... Fields>
+struct Occupancy;
+
+template <>
+struct Occupancy<> {
+    static constexpr quint32 combined(int)
+    {
+        return 0x00;
+    }
+
+    static constexpr int bitCount(int)
+    {
+        return 0;
+    }
+};
+
+template <typename F, typename... Rest>
+struct Occupancy<F, Rest...> {
+    // Returns the bits occupied by all descriptors within the byte at the given index
+    static constexpr quint32 combined(int index)
+    {
+        return F::occupancy(index) | Occupancy<Rest...>::combined(index);
+    }
+
+    // Returns the number of bits claimed by all descriptors within the byte at the given index (greater than the number of occupied bits if any overlap)
+    static constexpr int bitCount(int index)
+    {
+        return popCount(F::occupancy(index)) + Occupancy<Rest...>::bitCount(index);
+    }
+
+    // Checks that no descriptors overlap, from the given index up to the end of the packet
+    static constexpr bool disjoint(int index = 0)
+    {
+        return index == static_cast<int>(MCP2210::COMMAND_SIZE) || (popCount(combined(index)) == bitCount(index) && disjoint(index + 1));
+    }
+};
+
+// Layout of a payload, made of the given descriptors
+// Packets passed to encode() must be zero-initialized, since bit fields are combined into their bytes
+template <typename S, typename... Fields>
+struct Layout {
+    static_assert(Occupancy<Fields...>::disjoint(), "Layout fields must not overlap");
+
+    static void decode(const unsigned char *packet, S &s)
+    {
+        int expansion[] = {0, (Fields::decode(packet, s), 0)...};
+        static_cast<void>(expansion);
+    }
+
+    static void encode(const S &s, unsigned char *packet)
+    {
+        int expansion[] = {0, (Fields::encode(s, packet), 0)...};
+        static_cast<void>(expansion);
+    }
+};
+
+// Chip settings, shared by "GET_CHIP_SETTINGS", "SET_CHIP_SETTINGS" and the corresponding NVRAM sub-commands
+typedef MCP2210::ChipSettings CS;
+typedef Layout<CS,
+    Field<CS, quint8, &CS::gp0, 4>,                          // GP0 pin configuration corresponds to byte 4
+    Field<CS, quint8, &CS::gp1, 5>,                          // GP1 pin configuration corresponds to byte 5
+    Field<CS, quint8, &CS::gp2, 6>,                          // GP2 pin configuration corresponds to byte 6
+    Field<CS, quint8, &CS::gp3, 7>,                          // GP3 pin configuration corresponds to byte 7
+    Field<CS, quint8, &CS::gp4, 8>,                          // GP4 pin configuration corresponds to byte 8
+    Field<CS, quint8, &CS::gp5, 9>,                          // GP5 pin configuration corresponds to byte 9
+    Field<CS, quint8, &CS::gp6, 10>,                         // GP6 pin configuration corresponds to byte 10
+    Field<CS, quint8, &CS::gp7, 11>,                         // GP7 pin configuration corresponds to byte 11
+    Field<CS, quint8, &CS::gp8, 12>,                         // GP8 pin configuration corresponds to byte 12
+    Field<CS, quint8, &CS::gpout, 13>,                       // Default GPIO outputs (GPIO7 to GPIO0) corresponds to byte 13
+    Constant<14, 0x00>,                                      // Default GPIO8 output (not applicable)
+    Field<CS, quint8, &CS::gpdir, 15>,                       // Default GPIO directions (GPIO7 to GPIO0) corresponds to byte 15
+    Constant<16, 0x01>,                                      // Default GPIO8 direction (input only)
+    Field<CS, bool, &CS::rmwakeup, 17, 1, 4, 0x01>,          // Remote wake-up corresponds to bit 4 of byte 17
+    Field<CS, quint8, &CS::intmode, 17, 1, 1, 0x07>,         // Interrupt counting mode corresponds to bits 3:1 of byte 17
+    Field<CS, bool, &CS::nrelspi, 17, 1, 0, 0x01>            // SPI bus release corresponds to bit 0 of byte 17
+> ChipSettingsLayout;
+
+// SPI transfer settings, shared by "GET_SPI_SETTINGS", "SET_SPI_SETTINGS" and the corresponding NVRAM sub-commands
+typedef MCP2210::SPISettings SS;
+typedef Layout<SS,
+    Field<SS, quint32, &SS::bitrate, 4>,                     // Bit rate corresponds to bytes 4 to 7
+    Field<SS, quint8, &SS::idlcs, 8>,                        // Idle chip select (CS7 to CS0) corresponds to byte 8
+    Constant<9, 0x00>,                                       // Idle chip select (CS8, not applicable)
+    Field<SS, quint8, &SS::actcs, 10>,                       // Active chip select (CS7 to CS0) corresponds to byte 10
+    Constant<11, 0x00>,                                      // Active chip select (CS8, not applicable)
+    Field<SS, quint16, &SS::csdtdly, 12>,                    // Chip select to data delay corresponds to bytes 12 and 13
+    Field<SS, quint16, &SS::dtcsdly, 14>,                    // Data to chip select delay corresponds to bytes 14 and 15
+    Field<SS, quint16, &SS::itbytdly, 16>,                   // Inter-byte delay corresponds to bytes 16 and 17
+    Field<SS, quint16, &SS::nbytes, 18>,                     // Number of bytes per SPI transaction corresponds to bytes 18 and 19
+    Field<SS, quint8, &SS::mode, 20>                         // SPI mode corresponds to byte 20
+> SPISettingsLayout;
+
+// USB parameters, as returned by "GET_NVRAM_SETTINGS" (note that the layout differs from the one used for writing)
+typedef MCP2210::USBParameters UP;
+typedef Layout<UP,
+    Field<UP, quint16, &UP::vid, 12>,                        // Vendor ID corresponds to bytes 12 and 13
+    Field<UP, quint16, &UP::pid, 14>,                        // Product ID corresponds to bytes 14 and 15
+    Field<UP, bool, &UP::powmode, 29, 1, 6, 0x01>,           // Power mode corresponds to bit 6 of byte 29 (bit 7 is redundant)
+    Field<UP, bool, &UP::rmwakeup, 29, 1, 5, 0x01>,          // Remote wake-up capability corresponds to bit 5 of byte 29
+    Field<UP, quint8, &UP::maxpow, 30>                       // Maximum consumption current corresponds to byte 30
+> USBParametersReadLayout;
+
+// USB parameters, as written by "SET_NVRAM_SETTINGS"
+typedef Layout<UP,
+    Field<UP, quint16, &UP::vid, 4>,                         // Vendor ID corresponds to bytes 4 and 5
+    Field<UP, quint16, &UP::pid, 6>,                         // Product ID corresponds to bytes 6 and 7
+    Field<UP, bool, &UP::powmode, 8, 1, 7, 0x01, true>,      // Bus-powered mode corresponds to bit 7 of byte 8
+    Field<UP, bool, &UP::powmode, 8, 1, 6, 0x01>,            // Self-powered mode corresponds to bit 6 of byte 8
+    Field<UP, bool, &UP::rmwakeup, 8, 1, 5, 0x01>,           // Remote wake-up capability corresponds to bit 5 of byte 8
+    Field<UP, quint8, &UP::maxpow, 9>                        // Maximum consumption current corresponds to byte 9
+> USBParametersWriteLayout;
+
+}
+
+#endif  // MCP2210CODEC_H
@@ -0,0 +1,176 @@
+/* MCP2210 context switcher for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QObject>
+#include "mcp2210contextswitcher.h"
+
+// Private function that verifies the response to a command sent by restore(), reporting an error if the command was not completed
+bool MCP2210ContextSwitcher::checkResponse(quint8 response, const QString &operation, int &errcnt, QString &errstr)
+{
+    ++commands_;
+    bool completed = response == MCP2210::COMPLETED;
+    if (!completed) {
+        ++errcnt;
+        errstr += QObject::tr("Failed to %1 (response 0x%2).\n").arg(operation).arg(response, 2, 16, QChar('0'));
+    }
+    return completed;
+}
+
+// Creates a context switcher for the given device, which must remain valid during the lifetime of the switcher
+MCP2210ContextSwitcher::MCP2210ContextSwitcher(MCP2210 &mcp2210) :
+    mcp2210_(mcp2210),
+    knownState_(),
+    known_(false),
+    commands_(0)
+{
+}
+
+// Returns the number of commands sent to the device so far, including those sent by capture()
+quint64 MCP2210ContextSwitcher::commands() const
+{
+    return commands_;
+}
+
+// Returns the context having the given name (the returned state is zeroed if there is no such context)
+MCP2210State MCP2210ContextSwitcher::context(const QString &name) const
+{
+    return contexts_.value(name, MCP2210State());
+}
+
+// Returns the names of all saved contexts, in alphabetical order
+QStringList MCP2210ContextSwitcher::contexts() const
+{
+    return contexts_.keys();
+}
+
+// Checks if a context having the given name was saved
+bool MCP2210ContextSwitcher::hasContext(const QString &name) const
+{
+    return contexts_.contains(name);
+}
+
+// Checks if the current state of the device is known
+bool MCP2210ContextSwitcher::isKnown() const
+{
+    return known_;
+}
+
+// Returns the last known state of the device (only meaningful if isKnown() returns true)
+MCP2210State MCP2210ContextSwitcher::knownState() const
+{
+    return knownState_;
+}
+
+// Reads the volatile state of the device, which becomes the last known state if successful
+MCP2210State MCP2210ContextSwitcher::capture(int &errcnt, QString &errstr)
+{
+    int preverrcnt = errcnt;
+    MCP2210State state;
+    state.chipSettings = mcp2210_.getChipSettings(errcnt, errstr);
+    state.chipSettings.gpdir = mcp2210_.getGPIODirections(errcnt, errstr);  // The chip settings only hold the power-up directions and values, so the current ones are read separately
+    state.chipSettings.gpout = static_cast<quint8>(mcp2210_.getGPIOs(errcnt, errstr));
+    state.spiSettings = mcp2210_.getSPISettings(errcnt, errstr);
+    commands_ += 4;
+    known_ = errcnt == preverrcnt;
+    if (known_) {
+        knownState_ = state;
+    }
+    return state;
+}
+
+// Forgets the last known state, so that the next call to restore() captures the state of the device beforehand
+void MCP2210ContextSwitcher::invalidate()
+{
+    known_ = false;
+}
+
+// Removes the context having the given name (this has no effect if there is no such context)
+void MCP2210ContextSwitcher::removeContext(const QString &name)
+{
+    contexts_.remove(name);
+}
+
+// Applies the given state to the device, sending only the commands needed to go from the last known state to the given one
+// If the chip settings differ in anything other than GPIO directions and values, they are applied in a single command that also sets those
+// Otherwise, GPIO values are set before GPIO directions, so that pins becoming outputs do so with their intended values
+// SPI transfer settings are applied last, after any chip select pins are configured
+// If the state of the device is unknown, it is captured first, and on failure it becomes unknown again
+void MCP2210ContextSwitcher::restore(const MCP2210State &state, int &errcnt, QString &errstr)
+{
+    int preverrcnt = errcnt;
+    if (!known_) {
+        capture(errcnt, errstr);
+    }
+    if (errcnt == preverrcnt && knownState_ != state) {
+        MCP2210::ChipSettings currentSettings = knownState_.chipSettings;
+        MCP2210::ChipSettings targetSettings = state.chipSettings;
+        quint8 mask = state.outputMask();
+        bool valuesDiffer = (mask & currentSettings.gpout) != (mask & targetSettings.gpout);
+        bool directionsDiffer = currentSettings.gpdir != targetSettings.gpdir;
+        currentSettings.gpdir = targetSettings.gpdir;
+        currentSettings.gpout = targetSettings.gpout;
+        bool ok = true;
+        if (currentSettings != targetSettings) {
+            ok = checkResponse(mcp2210_.configureChipSettings(targetSettings, errcnt, errstr), QObject::tr("configure chip settings"), errcnt, errstr);
+        } else {
+            if (valuesDiffer) {
+                ok = checkResponse(mcp2210_.setGPIOs(targetSettings.gpout, errcnt, errstr), QObject::tr("set GPIO values"), errcnt, errstr);
+            }
+            if (ok && directionsDiffer) {
+                ok = checkResponse(mcp2210_.setGPIODirections(targetSettings.gpdir, errcnt, errstr), QObject::tr("set GPIO directions"), errcnt, errstr);
+            }
+        }
+        if (ok && knownState_.spiSettings != state.spiSettings) {
+            ok = checkResponse(mcp2210_.configureSPISettings(state.spiSettings, errcnt, errstr), QObject::tr("configure SPI settings"), errcnt, errstr);
+        }
+    }
+    known_ = errcnt == preverrcnt;
+    if (known_) {
+        knownState_ = state;
+    }
+}
+
+// Saves the given state as a context having the given name, replacing any context having the same name
+void MCP2210ContextSwitcher::saveContext(const QString &name, const MCP2210State &state)
+{
+    contexts_.insert(name, state);
+}
+
+// Captures the state of the device, and saves it as a context having the given name
+void MCP2210ContextSwitcher::saveContext(const QString &name, int &errcnt, QString &errstr)
+{
+    int preverrcnt = errcnt;
+    MCP2210State state = capture(errcnt, errstr);
+    if (errcnt == preverrcnt) {
+        saveContext(name, state);
+    }
+}
+
+// Switches to the context having the given name (see restore())
+void MCP2210ContextSwitcher::switchTo(const QString &name, int &errcnt, QString &errstr)
+{
+    if (!contexts_.contains(name)) {
+        ++errcnt;
+        errstr += QObject::tr("In switchTo(): there is no context named \"%1\".\n").arg(name);  // Program logic error
+    } else {
+        restore(contexts_.value(name), errcnt, errstr);
+    }
+}
@@ -0,0 +1,67 @@
+/* MCP2210 context switcher for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210CONTEXTSWITCHER_H
+#define MCP2210CONTEXTSWITCHER_H
+
+// Includes
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include "mcp2210.h"
+#include "mcp2210state.h"
+
+// Switcher that captures and restores the volatile state of an MCP2210, sending only the commands needed to go from the last known state to the requested one
+// Named contexts (e.g. one per test phase) can be saved and then switched to in a single call
+// The last known state is the one last applied or captured, so it must be invalidated if the device is reconfigured by other means (see invalidate())
+class MCP2210ContextSwitcher
+{
+private:
+    MCP2210 &mcp2210_;
+    MCP2210State knownState_;
+    bool known_;
+    QMap<QString, MCP2210State> contexts_;
+    quint64 commands_;
+
+    bool checkResponse(quint8 response, const QString &operation, int &errcnt, QString &errstr);
+
+public:
+    explicit MCP2210ContextSwitcher(MCP2210 &mcp2210);
+    MCP2210ContextSwitcher(const MCP2210ContextSwitcher &) = delete;
+
+    MCP2210ContextSwitcher &operator =(const MCP2210ContextSwitcher &) = delete;
+
+    quint64 commands() const;
+    MCP2210State context(const QString &name) const;
+    QStringList contexts() const;
+    bool hasContext(const QString &name) const;
+    bool isKnown() const;
+    MCP2210State knownState() const;
+
+    MCP2210State capture(int &errcnt, QString &errstr);
+    void invalidate();
+    void removeContext(const QString &name);
+    void restore(const MCP2210State &state, int &errcnt, QString &errstr);
+    void saveContext(const QString &name, const MCP2210State &state);
+    void saveContext(const QString &name, int &errcnt, QString &errstr);
+    void switchTo(const QString &name, int &errcnt, QString &errstr);
+};
+
+#endif  // MCP2210CONTEXTSWITCHER_H
@@ -0,0 +1,72 @@
+# Project include file for the MCP2210 core, which comprises the MCP2210
+# class, its transports, the packet codec and the configuration I/O classes
+# The core only depends on QtCore, QtNetwork and libusb, so that it can be
+# built into the standalone library found in "lib", which applications link
+# against via "mcp2210corelib.pri"
+
+QT += network
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/configuration.cpp \
+    $$PWD/configurationreader.cpp \
+    $$PWD/configurationwriter.cpp \
+    $$PWD/hidrawtransport.cpp \
+    $$PWD/libusb-extra.c \
+    $$PWD/libusbeventthread.cpp \
+    $$PWD/libusbtransport.cpp \
+    $$PWD/mcp2210.cpp \
+    $$PWD/mcp2210async.cpp \
+    $$PWD/mcp2210coalescer.cpp \
+    $$PWD/mcp2210contextswitcher.cpp \
+    $$PWD/mcp2210devicecache.cpp \
+    $$PWD/mcp2210devicelock.cpp \
+    $$PWD/mcp2210eeprom.cpp \
+    $$PWD/mcp2210emulator.cpp \
+    $$PWD/mcp2210monitor.cpp \
+    $$PWD/mcp2210pool.cpp \
+    $$PWD/mcp2210protocol.cpp \
+    $$PWD/mcp2210state.cpp \
+    $$PWD/mcp2210stats.cpp \
+    $$PWD/mcp2210tracer.cpp \
+    $$PWD/mcp2210transport.cpp \
+    $$PWD/mcp2210watchdog.cpp \
+    $$PWD/recordingtransport.cpp \
+    $$PWD/replaytransport.cpp \
+    $$PWD/sockettransport.cpp
+
+CORE_HEADERS = \
+    $$PWD/configuration.h \
+    $$PWD/configurationreader.h \
+    $$PWD/configurationwriter.h \
+    $$PWD/hidrawtransport.h \
+    $$PWD/libusb-extra.h \
+    $$PWD/libusbeventthread.h \
+    $$PWD/libusbtransport.h \
+    $$PWD/mcp2210.h \
+    $$PWD/mcp2210async.h \
+    $$PWD/mcp2210coalescer.h \
+    $$PWD/mcp2210codec.h \
+    $$PWD/mcp2210contextswitcher.h \
+    $$PWD/mcp2210coro.h \
+    $$PWD/mcp2210devicecache.h \
+    $$PWD/mcp2210devicelock.h \
+    $$PWD/mcp2210eeprom.h \
+    $$PWD/mcp2210emulator.h \
+    $$PWD/mcp2210limits.h \
+    $$PWD/mcp2210monitor.h \
+    $$PWD/mcp2210pool.h \
+    $$PWD/mcp2210protocol.h \
+    $$PWD/mcp2210state.h \
+    $$PWD/mcp2210stats.h \
+    $$PWD/mcp2210tracer.h \
+    $$PWD/mcp2210transport.h \
+    $$PWD/mcp2210watchdog.h \
+    $$PWD/recordingtransport.h \
+    $$PWD/replaytransport.h \
+    $$PWD/sockettransport.h
+
+HEADERS += $$CORE_HEADERS
+
+LIBS += -lusb-1.0
@@ -0,0 +1,21 @@
+# Project include file for applications that link against the MCP2210 core
+# library, instead of compiling the core sources themselves (see
+# "mcp2210core.pri")
+# The library must be built beforehand within the "lib" directory, which the
+# top-level project "mcp2210-conf.pro" does before building any application
+
+QT += network
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+CORE_LIB_DIR = $$shadowed($$PWD/lib)
+
+LIBS += -L$$CORE_LIB_DIR -lmcp2210core -lusb-1.0
+
+# Relink whenever the library is rebuilt (see "lib/mcp2210core.pro")
+mcp2210core_shared {
+    PRE_TARGETDEPS += $$CORE_LIB_DIR/libmcp2210core.so
+} else {
+    PRE_TARGETDEPS += $$CORE_LIB_DIR/libmcp2210core.a
+}
@@ -0,0 +1,298 @@
+/* MCP2210 coroutine API for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210CORO_H
+#define MCP2210CORO_H
+
+// Awaitable MCP2210 operations, for use within C++20 coroutines (e.g. "quint16 values = co_await device.getGPIOs(errcnt, errstr);")
+// Each operation is posted as a job to the worker that the MCP2210Pool assigned to the device, and the coroutine is resumed on that same worker once the job finishes
+// A suspended coroutine holds no thread, but each job still blocks its worker for the duration of the USB round trips it takes
+// Thus, a handful of worker threads can multiplex a large number of device conversations, but the number of transfers in flight is bounded by the number of workers
+// Transfers are not submitted via libusb_submit_transfer() from here, since they must go through MCP2210, which serializes them and handles coalescing, statistics and reconnection for every transport
+// Even when the libusb event thread is enabled (see LibusbEventThread), the worker sleeps until that thread completes each transfer
+// This header requires a compiler with coroutine support (e.g. "CONFIG += c++2a" or "QMAKE_CXXFLAGS += -std=c++20"), as done by the "mcp2210-coroping" benchmark
+
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+#error "mcp2210coro.h requires C++20 coroutine support (e.g. \"CONFIG += c++2a\")"
+#endif
+
+// Includes
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "mcp2210.h"
+#include "mcp2210pool.h"
+
+namespace MCP2210Coro
+{
+// Coroutine return type for fire-and-forget conversations, which start running immediately and free themselves once finished
+// Exceptions must not escape the coroutine body
+class Task
+{
+public:
+    struct promise_type {
+        Task get_return_object()
+        {
+            return Task();
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+};
+
+// Awaitable that runs a single job on a device and yields its result, following the usual error reporting convention
+// Errors reported by the job are added to the given error count and appended to the given error string, as the blocking API would do
+template <typename T>
+class Operation
+{
+    static_assert(!std::is_void<T>::value, "Operation requires a job that returns a value");
+
+private:
+    MCP2210Pool::Handle *handle_;
+    std::function<T(MCP2210 &, int &, QString &)> function_;
+    int &errcnt_;
+    QString &errstr_;
+    T result_;
+
+public:
+    Operation(MCP2210Pool::Handle *handle, std::function<T(MCP2210 &, int &, QString &)> function, int &errcnt, QString &errstr) :
+        handle_(handle),
+        function_(std::move(function)),
+        errcnt_(errcnt),
+        errstr_(errstr),
+        result_()
+    {
+    }
+
+    // Completes immediately, without suspending, if the handle is invalid (the error is then reported by await_resume())
+    bool await_ready() const
+    {
+        return !handle_->isValid();
+    }
+
+    // Posts the job, and resumes the coroutine from the assigned worker once the job finishes
+    void await_suspend(std::coroutine_handle<> coroutine)
+    {
+        handle_->post([this](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            result_ = function_(mcp2210, errcnt, errstr);
+        }, [this, coroutine](int errcnt, const QString &errstr) {
+            errcnt_ += errcnt;
+            errstr_ += errstr;
+            coroutine.resume();
+        });
+    }
+
+    T await_resume()
+    {
+        if (!handle_->isValid()) {
+            ++errcnt_;
+            errstr_ += QObject::tr("In co_await: invalid handle.\n");  // Program logic error
+        }
+        return std::move(result_);
+    }
+};
+
+// Device that exposes awaitable versions of the MCP2210 operations
+// The device should be owned by the coroutine that uses it (e.g. by being a local variable), so that it stays open while operations are pending
+class Device
+{
+private:
+    MCP2210Pool::Handle handle_;
+
+public:
+    Device() = default;
+    explicit Device(MCP2210Pool::Handle &&handle) :
+        handle_(std::move(handle))
+    {
+    }
+
+    Device(const Device &) = delete;
+    Device(Device &&) = default;
+
+    Device &operator =(const Device &) = delete;
+    Device &operator =(Device &&) = default;
+
+    // Returns the underlying pool handle
+    MCP2210Pool::Handle &handle()
+    {
+        return handle_;
+    }
+
+    // Checks if the device is valid (i.e., if it references an open device)
+    bool isValid() const
+    {
+        return handle_.isValid();
+    }
+
+    // Returns an awaitable that runs the given function on the device, for any operation or sequence of operations not covered below
+    // The function must have the signature "T function(MCP2210 &mcp2210, int &errcnt, QString &errstr)", where "T" is not void
+    template <typename F>
+    auto call(F function, int &errcnt, QString &errstr) -> Operation<decltype(function(std::declval<MCP2210 &>(), errcnt, errstr))>
+    {
+        return {&handle_, std::move(function), errcnt, errstr};
+    }
+
+    // Awaitable version of MCP2210::cancelSPITransfer()
+    Operation<quint8> cancelSPITransfer(int &errcnt, QString &errstr)
+    {
+        return call([](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.cancelSPITransfer(errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::configureChipSettings()
+    Operation<quint8> configureChipSettings(const MCP2210::ChipSettings &settings, int &errcnt, QString &errstr)
+    {
+        return call([settings](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.configureChipSettings(settings, errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::configureSPISettings()
+    Operation<quint8> configureSPISettings(const MCP2210::SPISettings &settings, int &errcnt, QString &errstr)
+    {
+        return call([settings](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.configureSPISettings(settings, errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::getChipSettings()
+    Operation<MCP2210::ChipSettings> getChipSettings(int &errcnt, QString &errstr)
+    {
+        return call([](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.getChipSettings(errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::getChipStatus()
+    Operation<MCP2210::ChipStatus> getChipStatus(int &errcnt, QString &errstr)
+    {
+        return call([](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.getChipStatus(errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::getEventCount()
+    Operation<quint16> getEventCount(int &errcnt, QString &errstr)
+    {
+        return call([](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.getEventCount(errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::getGPIO()
+    Operation<bool> getGPIO(int gpio, int &errcnt, QString &errstr)
+    {
+        return call([gpio](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.getGPIO(gpio, errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::getGPIOs()
+    Operation<quint16> getGPIOs(int &errcnt, QString &errstr)
+    {
+        return call([](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.getGPIOs(errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::getSPISettings()
+    Operation<MCP2210::SPISettings> getSPISettings(int &errcnt, QString &errstr)
+    {
+        return call([](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.getSPISettings(errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::getUSBParameters()
+    Operation<MCP2210::USBParameters> getUSBParameters(int &errcnt, QString &errstr)
+    {
+        return call([](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.getUSBParameters(errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::readEEPROMRange()
+    Operation<QVector<quint8>> readEEPROMRange(quint8 begin, quint8 end, int &errcnt, QString &errstr)
+    {
+        return call([begin, end](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.readEEPROMRange(begin, end, errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::setGPIO()
+    Operation<quint8> setGPIO(int gpio, bool value, int &errcnt, QString &errstr)
+    {
+        return call([gpio, value](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.setGPIO(gpio, value, errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::setGPIOs()
+    Operation<quint8> setGPIOs(quint16 values, int &errcnt, QString &errstr)
+    {
+        return call([values](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.setGPIOs(values, errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::spiTransfer()
+    // The given status variable must outlive the operation, which is the case if it is local to the awaiting coroutine
+    Operation<QVector<quint8>> spiTransfer(const QVector<quint8> &data, quint8 &status, int &errcnt, QString &errstr)
+    {
+        quint8 *statusPtr = &status;
+        return call([data, statusPtr](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.spiTransfer(data, *statusPtr, errcnt, errstr);
+        }, errcnt, errstr);
+    }
+
+    // Awaitable version of MCP2210::writeEEPROMRange()
+    Operation<quint8> writeEEPROMRange(quint8 begin, quint8 end, const QVector<quint8> &values, int &errcnt, QString &errstr)
+    {
+        return call([begin, end, values](MCP2210 &mcp2210, int &errcnt, QString &errstr) {
+            return mcp2210.writeEEPROMRange(begin, end, values, errcnt, errstr);
+        }, errcnt, errstr);
+    }
+};
+}
+
+#endif  // MCP2210CORO_H
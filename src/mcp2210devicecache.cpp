@@ -0,0 +1,204 @@
+/* MCP2210 device cache for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QDateTime>
+#include <QMutexLocker>
+#include "mcp2210.h"
+#include "mcp2210devicecache.h"
+
+// Returns the key that identifies the entry
+QString MCP2210DeviceCache::Entry::key() const
+{
+    return QString("%1:%2/%3@%4/%5").arg(vid, 4, 16, QChar('0')).arg(pid, 4, 16, QChar('0')).arg(device.path).arg(device.address).arg(device.serial);
+}
+
+// Private constructor, since a single cache is shared by the whole process (see instance())
+MCP2210DeviceCache::MCP2210DeviceCache() :
+    descriptorReads_(0),
+    generation_(0),
+    hits_(0)
+{
+}
+
+// Returns the number of times the NVRAM descriptors of a device were read so far
+quint64 MCP2210DeviceCache::descriptorReads() const
+{
+    QMutexLocker locker(&mutex_);
+    return descriptorReads_;
+}
+
+// Gets the cached NVRAM descriptors of the device having the given VID, PID and serial number
+// Returns false if the device is not cached or its descriptors were not read yet, in which case "manufacturer" and "product" are left untouched
+bool MCP2210DeviceCache::descriptors(quint16 vid, quint16 pid, const QString &serial, QString &manufacturer, QString &product)
+{
+    QMutexLocker locker(&mutex_);
+    bool retval = false;
+    for (const Entry &entry : entries_) {
+        if (entry.vid == vid && entry.pid == pid && entry.device.serial == serial && entry.descriptorsValid) {
+            manufacturer = entry.manufacturer;
+            product = entry.product;
+            ++hits_;
+            retval = true;
+            break;
+        }
+    }
+    return retval;
+}
+
+// Returns all cached entries, from the last enumeration of each VID and PID pair
+QVector<MCP2210DeviceCache::Entry> MCP2210DeviceCache::entries() const
+{
+    QMutexLocker locker(&mutex_);
+    QVector<Entry> entries;
+    entries.reserve(entries_.size());
+    for (const Entry &entry : entries_) {
+        entries += entry;
+    }
+    return entries;
+}
+
+// Returns the number of times an entry was reused by enumerate(), instead of reading the NVRAM descriptors again
+quint64 MCP2210DeviceCache::hits() const
+{
+    QMutexLocker locker(&mutex_);
+    return hits_;
+}
+
+// Enumerates the devices having the given VID and PID via the default transport, returning their entries in enumeration order
+// Devices that are already cached, at the same location and address, are not opened again to read their USB strings
+// If "readDescriptors" is true, the NVRAM descriptors are read from each device that has no valid descriptors yet, which requires opening it
+// Devices that are in use by other processes cannot be opened, and are returned without valid descriptors (this is not considered an error)
+// Entries of devices that are no longer found are dropped
+QVector<MCP2210DeviceCache::Entry> MCP2210DeviceCache::enumerate(quint16 vid, quint16 pid, bool readDescriptors, int &errcnt, QString &errstr)
+{
+    QVector<MCP2210Transport::DeviceInfo> known;
+    {
+        QMutexLocker locker(&mutex_);
+        for (const Entry &entry : entries_) {
+            if (entry.vid == vid && entry.pid == pid) {
+                known += entry.device;
+            }
+        }
+    }
+    MCP2210Transport *transport = MCP2210Transport::create();
+    QVector<MCP2210Transport::DeviceInfo> devices = transport->enumerateDevices(vid, pid, known, errcnt, errstr);
+    delete transport;
+    QVector<Entry> entries;
+    entries.reserve(devices.size());
+    quint64 generation;
+    {
+        QMutexLocker locker(&mutex_);
+        generation = generation_;
+        for (const MCP2210Transport::DeviceInfo &device : devices) {
+            Entry entry = Entry();
+            entry.vid = vid;
+            entry.pid = pid;
+            entry.device = device;
+            QHash<QString, Entry>::const_iterator cached = entries_.constFind(entry.key());
+            if (cached == entries_.constEnd()) {
+                entry.timestamp = QDateTime::currentMSecsSinceEpoch();
+            } else {
+                entry = cached.value();
+                if (entry.descriptorsValid) {
+                    ++hits_;
+                }
+            }
+            entries += entry;
+        }
+    }
+    quint64 descriptorReads = 0;
+    for (Entry &entry : entries) {
+        if (readDescriptors && !entry.descriptorsValid) {  // The device is opened without holding the mutex, since this takes several round trips
+            MCP2210 mcp2210;
+            if (mcp2210.open(vid, pid, entry.device.serial) == MCP2210::SUCCESS) {
+                int preverrcnt = errcnt;
+                entry.manufacturer = mcp2210.getManufacturerDesc(errcnt, errstr);
+                entry.product = mcp2210.getProductDesc(errcnt, errstr);
+                entry.descriptorsValid = errcnt == preverrcnt;
+                if (entry.descriptorsValid) {
+                    ++descriptorReads;
+                }
+            }
+        }
+    }
+    QMutexLocker locker(&mutex_);
+    descriptorReads_ += descriptorReads;
+    bool invalidated = generation_ != generation;  // Entries were invalidated while the mutex was not held, so the descriptors obtained so far may be stale
+    for (QHash<QString, Entry>::iterator i = entries_.begin(); i != entries_.end();) {
+        if (i.value().vid == vid && i.value().pid == pid) {
+            i = entries_.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    for (const Entry &entry : entries) {
+        QHash<QString, Entry>::iterator inserted = entries_.insert(entry.key(), entry);
+        if (invalidated) {
+            inserted.value().descriptorsValid = false;  // The descriptors are read again on the next enumeration
+        }
+    }
+    return entries;
+}
+
+// Invalidates all entries, so that the NVRAM descriptors of all devices are read again on the next enumeration
+void MCP2210DeviceCache::invalidate()
+{
+    QMutexLocker locker(&mutex_);
+    entries_.clear();
+    ++generation_;
+}
+
+// Invalidates the entries of the device having the given VID, PID and serial number, or of all devices having the given VID and PID if no serial number is given
+void MCP2210DeviceCache::invalidate(quint16 vid, quint16 pid, const QString &serial)
+{
+    QMutexLocker locker(&mutex_);
+    for (QHash<QString, Entry>::iterator i = entries_.begin(); i != entries_.end();) {
+        if (i.value().vid == vid && i.value().pid == pid && (serial.isEmpty() || i.value().device.serial == serial)) {
+            i = entries_.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    ++generation_;
+}
+
+// Stores the NVRAM descriptors that were read from the device having the given VID, PID and serial number, if that device is cached
+// This lets callers that open a device anyway (e.g. in order to check its health) fill the cache, instead of having enumerate() open the device again
+// The descriptors are discarded if the device is not cached, which is the case if it was invalidated after being enumerated
+void MCP2210DeviceCache::setDescriptors(quint16 vid, quint16 pid, const QString &serial, const QString &manufacturer, const QString &product)
+{
+    QMutexLocker locker(&mutex_);
+    ++descriptorReads_;
+    for (Entry &entry : entries_) {
+        if (entry.vid == vid && entry.pid == pid && entry.device.serial == serial) {
+            entry.descriptorsValid = true;
+            entry.manufacturer = manufacturer;
+            entry.product = product;
+        }
+    }
+}
+
+// Returns the cache shared by the whole process
+MCP2210DeviceCache &MCP2210DeviceCache::instance()
+{
+    static MCP2210DeviceCache cache;  // Initialization is thread-safe as per C++11
+    return cache;
+}
@@ -0,0 +1,77 @@
+/* MCP2210 device cache for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210DEVICECACHE_H
+#define MCP2210DEVICECACHE_H
+
+// Includes
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include "mcp2210transport.h"
+
+// Process-wide cache of enumeration metadata, holding the location, USB strings and, optionally, the NVRAM descriptors of each device
+// Entries are keyed by VID, PID, location, address and serial number, so a device that is attached again (even to the same port) gets a new entry
+// Devices that are no longer found are dropped on each enumeration, and writing the descriptors of a device via MCP2210 invalidates its entry
+// USB strings and NVRAM descriptors are only read for devices that are new, attached again or invalidated, so that refreshing an inventory of many devices costs a single enumeration
+class MCP2210DeviceCache
+{
+public:
+    struct Entry {
+        quint16 vid;                          // Vendor ID
+        quint16 pid;                          // Product ID
+        MCP2210Transport::DeviceInfo device;  // Enumeration data, including the USB strings
+        bool descriptorsValid;                // The NVRAM descriptors below were read
+        QString manufacturer;                 // Manufacturer descriptor, as read from NVRAM
+        QString product;                      // Product descriptor, as read from NVRAM
+        qint64 timestamp;                     // Time at which the device was first found, in milliseconds since the epoch
+
+        QString key() const;
+    };
+
+private:
+    mutable QMutex mutex_;
+    QHash<QString, Entry> entries_;
+    quint64 descriptorReads_;
+    quint64 generation_;  // Incremented on every invalidation, so that enumerate() can tell if entries were invalidated while it was reading descriptors
+    quint64 hits_;
+
+    MCP2210DeviceCache();
+
+public:
+    MCP2210DeviceCache(const MCP2210DeviceCache &) = delete;
+
+    MCP2210DeviceCache &operator =(const MCP2210DeviceCache &) = delete;
+
+    quint64 descriptorReads() const;
+    bool descriptors(quint16 vid, quint16 pid, const QString &serial, QString &manufacturer, QString &product);
+    QVector<Entry> entries() const;
+    quint64 hits() const;
+
+    QVector<Entry> enumerate(quint16 vid, quint16 pid, bool readDescriptors, int &errcnt, QString &errstr);
+    void invalidate();
+    void invalidate(quint16 vid, quint16 pid, const QString &serial = QString());
+    void setDescriptors(quint16 vid, quint16 pid, const QString &serial, const QString &manufacturer, const QString &product);
+
+    static MCP2210DeviceCache &instance();
+};
+
+#endif  // MCP2210DEVICECACHE_H
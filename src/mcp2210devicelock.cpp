@@ -0,0 +1,248 @@
+/* MCP2210 device lock for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QStringList>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QThread>
+#include <QtGlobal>
+#include "mcp2210devicelock.h"
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+// Definitions
+const int RETRY_INTERVAL = 100;   // Interval between attempts to acquire the lock, in milliseconds, if inotify is not available
+const int WAKEUP_INTERVAL = 1000;  // Maximum time spent waiting for an inotify event, in milliseconds (some file systems, such as NFS, do not report events)
+
+// Checks if the holder is valid, which means that the lock is currently held
+bool MCP2210DeviceLock::Holder::isValid() const
+{
+    return pid != 0;
+}
+
+// Returns a description of the holder, suitable for error messages
+QString MCP2210DeviceLock::Holder::toString() const
+{
+    return QObject::tr("%1 (PID %2 on %3, since %4)").arg(application.isEmpty() ? QObject::tr("unknown application") : application).arg(pid).arg(hostname).arg(since.toString(Qt::ISODate));
+}
+
+// Private function that opens the given lock file, creating it if "create" is true, and returns its descriptor, or -1 in case of failure
+// Symbolic links are never followed, and anything other than a regular file is refused, so that a file planted in the lock directory cannot redirect the lock to another file
+static int openLockFile(const QString &fileName, bool create)
+{
+    int fd = -1;
+#ifdef Q_OS_UNIX
+    QByteArray path = QFile::encodeName(fileName);
+    int flags = O_CLOEXEC | O_NOFOLLOW | O_NONBLOCK;  // O_NONBLOCK prevents blocking on a planted FIFO, and has no effect on regular files
+    if (create) {
+        fd = ::open(path.constData(), O_RDWR | O_CREAT | flags, 0644);  // Other users can still lock the file, via a read-only descriptor
+    }
+    if (fd < 0) {
+        fd = ::open(path.constData(), O_RDONLY | flags);  // A lock file created by another user can still be locked
+    }
+    struct stat status;
+    if (fd >= 0 && (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))) {
+        ::close(fd);
+        fd = -1;
+    }
+#else
+    Q_UNUSED(fileName);
+    Q_UNUSED(create);
+#endif
+    return fd;
+}
+
+// Private function that records the current process as the holder of the lock
+void MCP2210DeviceLock::writeHolder()
+{
+#ifdef Q_OS_UNIX
+    QByteArray data = QString("%1\n%2\n%3\n%4\n").arg(QCoreApplication::applicationPid()).arg(QSysInfo::machineHostName()).arg(QCoreApplication::applicationName()).arg(QDateTime::currentDateTime().toString(Qt::ISODate)).toUtf8();
+    if (ftruncate(fd_, 0) == 0) {
+        ssize_t written = pwrite(fd_, data.constData(), static_cast<size_t>(data.size()), 0);
+        Q_UNUSED(written);  // Lock files created by other users may be read-only, in which case the lock is still valid, although the holder is not recorded
+    }
+#endif
+}
+
+// Creates a lock for the device having the given VID, PID and serial number (the lock is not acquired)
+MCP2210DeviceLock::MCP2210DeviceLock(quint16 vid, quint16 pid, const QString &serial) :
+    fileName_(fileName(vid, pid, serial)),
+    fd_(-1),
+    locked_(false)
+{
+}
+
+MCP2210DeviceLock::~MCP2210DeviceLock()
+{
+    unlock();  // Also closes the lock file
+}
+
+// Returns the path of the lock file
+QString MCP2210DeviceLock::fileName() const
+{
+    return fileName_;
+}
+
+// Returns the process that holds the lock, as recorded in the lock file (the returned holder is not valid if the lock is not held)
+// The lock is probed first, so that the record left behind by a holder that crashed is not reported
+MCP2210DeviceLock::Holder MCP2210DeviceLock::holder() const
+{
+    Holder holder = Holder();
+#ifdef Q_OS_UNIX
+    int fd = openLockFile(fileName_, false);
+    if (fd >= 0) {
+        bool held = locked_ || flock(fd, LOCK_SH | LOCK_NB) != 0;  // If a shared lock can be acquired, nobody holds the lock (the shared lock is released when the file is closed)
+        if (held) {
+            QByteArray data;
+            char buffer[256];
+            ssize_t bytesRead;
+            while ((bytesRead = read(fd, buffer, sizeof(buffer))) > 0 && data.size() < 4096) {
+                data.append(buffer, static_cast<int>(bytesRead));
+            }
+            QStringList fields = QString::fromUtf8(data).split('\n');
+            if (fields.size() >= 4) {
+                holder.pid = fields.at(0).toLongLong();
+                holder.hostname = fields.at(1);
+                holder.application = fields.at(2);
+                holder.since = QDateTime::fromString(fields.at(3), Qt::ISODate);
+            }
+        }
+        ::close(fd);
+    }
+#endif
+    return holder;
+}
+
+// Checks if the lock is held by this object
+bool MCP2210DeviceLock::isLocked() const
+{
+    return locked_;
+}
+
+// Acquires the lock, waiting up to the given timeout (in milliseconds) for it to be released by another process, and returns true if successful
+// On Linux, the lock file is watched via inotify, so that the lock is acquired as soon as its holder closes the file, either explicitly or by terminating
+bool MCP2210DeviceLock::lock(int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    bool retval = tryLock();
+#ifdef Q_OS_LINUX
+    int notifyfd = retval || fd_ < 0 ? -1 : inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (notifyfd >= 0) {
+        if (inotify_add_watch(notifyfd, QFile::encodeName(fileName_).constData(), IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF) >= 0) {
+            retval = tryLock();  // The lock may have been released before the watch was added
+            qint64 remaining = timeout - timer.elapsed();
+            while (!retval && remaining > 0) {
+                pollfd pfd = {notifyfd, POLLIN, 0};
+                if (poll(&pfd, 1, static_cast<int>(qMin<qint64>(remaining, WAKEUP_INTERVAL))) > 0) {
+                    char buffer[4096];
+                    while (read(notifyfd, buffer, sizeof(buffer)) > 0) {  // Events are discarded, since any of them warrants a new attempt
+                    }
+                }
+                retval = tryLock();
+                remaining = timeout - timer.elapsed();
+            }
+        }
+        ::close(notifyfd);
+    }
+#endif
+    while (!retval && timer.elapsed() < timeout) {  // Fallback used if inotify is not available
+        QThread::msleep(static_cast<unsigned long>(qMin<qint64>(RETRY_INTERVAL, timeout - timer.elapsed())));
+        retval = tryLock();
+    }
+    return retval;
+}
+
+// Attempts to acquire the lock without waiting, and returns true if successful (or if the lock is already held by this object)
+// On platforms other than Unix, advisory locks are not supported, and this function always succeeds
+bool MCP2210DeviceLock::tryLock()
+{
+    if (!locked_) {
+#ifdef Q_OS_UNIX
+        if (fd_ < 0) {
+            fd_ = openLockFile(fileName_, true);
+        }
+        locked_ = fd_ >= 0 && flock(fd_, LOCK_EX | LOCK_NB) == 0;
+        if (locked_) {
+            writeHolder();
+        }
+#else
+        locked_ = true;
+#endif
+    }
+    return locked_;
+}
+
+// Releases the lock, if held, and closes the lock file, which wakes up any processes waiting for the lock
+void MCP2210DeviceLock::unlock()
+{
+#ifdef Q_OS_UNIX
+    if (fd_ >= 0) {
+        if (locked_) {
+            int result = ftruncate(fd_, 0);  // The holder is cleared before releasing the lock
+            Q_UNUSED(result);
+        }
+        ::close(fd_);  // Closing the file also releases the lock
+        fd_ = -1;
+    }
+#endif
+    locked_ = false;
+}
+
+// Returns the path of the lock file for the device having the given VID, PID and serial number
+// Lock files are kept in "/run/lock", which is shared by all users, or in the runtime directory of the user if it does not exist (in which case locks only arbitrate between processes of the same user)
+// Only alphanumeric characters of the serial number are used, and the serial number is omitted if empty
+QString MCP2210DeviceLock::fileName(quint16 vid, quint16 pid, const QString &serial)
+{
+    QString name = QString("mcp2210-%1-%2").arg(vid, 4, 16, QChar('0')).arg(pid, 4, 16, QChar('0'));
+    QString sanitizedSerial;
+    for (int i = 0; i < serial.size(); ++i) {
+        if (serial.at(i).isLetterOrNumber() && serial.at(i).unicode() < 0x80) {
+            sanitizedSerial += serial.at(i);
+        }
+    }
+    if (!sanitizedSerial.isEmpty()) {
+        name += "-" + sanitizedSerial;
+    }
+    QString directory = "/run/lock";
+    if (!QFileInfo(directory).isDir()) {
+        directory = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    }
+    if (directory.isEmpty()) {
+        directory = QDir::tempPath();  // Last resort, on platforms without a runtime directory
+    }
+    return QDir(directory).filePath(name + ".lock");
+}
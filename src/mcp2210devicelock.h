@@ -0,0 +1,70 @@
+/* MCP2210 device lock for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210DEVICELOCK_H
+#define MCP2210DEVICELOCK_H
+
+// Includes
+#include <QDateTime>
+#include <QString>
+
+// Advisory inter-process lock for a given device, used to hand devices over between processes (see MCP2210::open())
+// The lock is an exclusive flock() on a file in "/run/lock" (see fileName()), so it is released by the kernel if the holder crashes, and it holds the PID, host and application name of its holder
+// On Linux, waiting for the lock relies on inotify events that are triggered when the holder releases the lock, so that handoffs are fast and no polling is involved
+class MCP2210DeviceLock
+{
+public:
+    // Process that holds the lock, as recorded in the lock file
+    struct Holder {
+        qint64 pid;            // Process ID (zero if the lock is not held)
+        QString hostname;      // Host name
+        QString application;   // Application name
+        QDateTime since;       // Time at which the lock was acquired
+
+        bool isValid() const;
+        QString toString() const;
+    };
+
+private:
+    QString fileName_;
+    int fd_;
+    bool locked_;
+
+    void writeHolder();
+
+public:
+    MCP2210DeviceLock(quint16 vid, quint16 pid, const QString &serial);
+    MCP2210DeviceLock(const MCP2210DeviceLock &) = delete;
+    ~MCP2210DeviceLock();
+
+    MCP2210DeviceLock &operator =(const MCP2210DeviceLock &) = delete;
+
+    QString fileName() const;
+    Holder holder() const;
+    bool isLocked() const;
+
+    bool lock(int timeout);
+    bool tryLock();
+    void unlock();
+
+    static QString fileName(quint16 vid, quint16 pid, const QString &serial);
+};
+
+#endif  // MCP2210DEVICELOCK_H
@@ -0,0 +1,622 @@
+/* MCP2210 emulator for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cstring>
+#include <QMutexLocker>
+#include <QObject>
+#include <QThread>
+#include <libusb-1.0/libusb.h>
+#include "mcp2210.h"
+#include "mcp2210emulator.h"
+
+// Definitions
+const quint32 SUPPORTED_BITRATES[] = {  // Bit rates supported by the MCP2210, in ascending order
+    MCP2210::BRT1K464, MCP2210::BRT1K5, MCP2210::BRT1K875, MCP2210::BRT2K5, MCP2210::BRT3K, MCP2210::BRT3K125, MCP2210::BRT3K75, MCP2210::BRT5K,
+    MCP2210::BRT6K, MCP2210::BRT6K25, MCP2210::BRT7K5, MCP2210::BRT9K375, MCP2210::BRT10K, MCP2210::BRT12K, MCP2210::BRT12K5, MCP2210::BRT15K,
+    MCP2210::BRT15K625, MCP2210::BRT18K75, MCP2210::BRT20K, MCP2210::BRT24K, MCP2210::BRT25K, MCP2210::BRT30K, MCP2210::BRT31K25, MCP2210::BRT37K5,
+    MCP2210::BRT40K, MCP2210::BRT46K875, MCP2210::BRT48K, MCP2210::BRT50K, MCP2210::BRT60K, MCP2210::BRT62K5, MCP2210::BRT75K, MCP2210::BRT80K,
+    MCP2210::BRT93K75, MCP2210::BRT100K, MCP2210::BRT120K, MCP2210::BRT125K, MCP2210::BRT150K, MCP2210::BRT187K5, MCP2210::BRT200K, MCP2210::BRT240K,
+    MCP2210::BRT250K, MCP2210::BRT300K, MCP2210::BRT375K, MCP2210::BRT400K, MCP2210::BRT500K, MCP2210::BRT600K, MCP2210::BRT750K, MCP2210::BRT1M,
+    MCP2210::BRT1M2, MCP2210::BRT1M5, MCP2210::BRT2M, MCP2210::BRT3M, MCP2210::BRT12M
+};
+const quint8 PWTRIES_MAX = 5;  // Number of wrong password attempts after which access is blocked until the next power cycle
+
+// Factory default NVRAM contents
+const quint8 DEFAULT_CHIP_SETTINGS[14] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // All pins configured as GPIOs
+    0xff, 0x01,                                            // Default GPIO outputs
+    0xff, 0x01,                                            // Default GPIO directions (all inputs)
+    0x00                                                   // Other chip settings
+};
+const quint8 DEFAULT_SPI_SETTINGS[17] = {
+    0x40, 0x42, 0x0f, 0x00,  // Bit rate (1 Mib/s)
+    0xff, 0x01,              // Idle chip select
+    0x00, 0x00,              // Active chip select
+    0x01, 0x00,              // Chip select to data delay
+    0x01, 0x00,              // Data to chip select delay
+    0x01, 0x00,              // Inter-byte delay
+    0x04, 0x00,              // Number of bytes per SPI transaction
+    0x00                     // SPI mode
+};
+const quint8 DEFAULT_USB_PARAMETERS[6] = {
+    0xd8, 0x04,  // Vendor ID
+    0xde, 0x00,  // Product ID
+    0x80,        // Chip power options (bus-powered)
+    0x32         // Maximum consumption current (100 mA)
+};
+const char DEFAULT_MANUFACTURER[] = "Microchip Technology Inc.";
+const char DEFAULT_PRODUCT[] = "MCP2210 USB to SPI Master";
+
+MCP2210Emulator::SPISlave::~SPISlave()
+{
+}
+
+// Called when the chip select pin to which the slave is attached is deasserted (the default implementation does nothing)
+void MCP2210Emulator::SPISlave::deselect()
+{
+}
+
+// Called when the chip select pin to which the slave is attached is asserted (the default implementation does nothing)
+void MCP2210Emulator::SPISlave::select()
+{
+}
+
+// Returns the received byte
+quint8 MCP2210Emulator::LoopbackSlave::transfer(quint8 mosi)
+{
+    return mosi;
+}
+
+MCP2210Emulator::MCP2210Emulator(const QString &serial) :
+    serial_(serial),
+    responseReadyAt_(0),
+    connected_(true),
+    externalMaster_(false),
+    isOpen_(false),
+    accessControlMode_(MCP2210::ACNONE),
+    gpioInputs_(0x01ff)  // External inputs are assumed to be pulled up
+{
+    for (int i = 0; i < 9; ++i) {
+        slaves_[i] = nullptr;
+    }
+    timingModel_.enabled = false;
+    timingModel_.usbLatency = 1000;
+    timingModel_.spiTiming = true;
+    std::memset(password_, 0x00, sizeof(password_));
+    std::memcpy(nvChipSettings_, DEFAULT_CHIP_SETTINGS, sizeof(nvChipSettings_));
+    std::memcpy(nvSPISettings_, DEFAULT_SPI_SETTINGS, sizeof(nvSPISettings_));
+    std::memcpy(usbParameters_, DEFAULT_USB_PARAMETERS, sizeof(usbParameters_));
+    writeDescriptor(manufacturer_, DEFAULT_MANUFACTURER);
+    writeDescriptor(product_, DEFAULT_PRODUCT);
+    std::memset(eeprom_, 0xff, sizeof(eeprom_));  // Erased EEPROM
+    clock_.start();
+    powerCycle();
+}
+
+MCP2210Emulator::~MCP2210Emulator()
+{
+    for (int i = 0; i < 9; ++i) {
+        delete slaves_[i];
+    }
+}
+
+// Checks if the emulated device is open
+bool MCP2210Emulator::isOpen() const
+{
+    QMutexLocker locker(&mutex_);
+    return isOpen_;
+}
+
+// Attaches the given SPI slave model to the given chip select pin (0 to 8), taking ownership of it
+// Any slave previously attached to the same pin is deleted
+void MCP2210Emulator::attachSPISlave(int cs, SPISlave *slave)
+{
+    QMutexLocker locker(&mutex_);
+    if (cs >= MCP2210::GPIO0 && cs <= MCP2210::GPIO8) {
+        delete slaves_[cs];
+        slaves_[cs] = slave;
+    } else {
+        delete slave;  // The slave is not attachable, but ownership was still taken
+    }
+}
+
+// Closes the emulated device
+void MCP2210Emulator::close()
+{
+    QMutexLocker locker(&mutex_);
+    isOpen_ = false;
+    responsePending_ = false;
+}
+
+// Returns the contents of the emulated EEPROM
+QVector<quint8> MCP2210Emulator::eeprom() const
+{
+    QMutexLocker locker(&mutex_);
+    QVector<quint8> contents(static_cast<int>(MCP2210::EEPROM_SIZE));
+    for (size_t i = 0; i < MCP2210::EEPROM_SIZE; ++i) {
+        contents[static_cast<int>(i)] = eeprom_[i];
+    }
+    return contents;
+}
+
+// Performs an emulated interrupt transfer, returning the equivalent libusb result
+// Each OUT transfer is processed as a HID command, and its response is returned by the following IN transfer
+int MCP2210Emulator::interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    QMutexLocker locker(&mutex_);
+    int result = LIBUSB_SUCCESS;
+    int bytes = 0;
+    if (!connected_) {
+        result = LIBUSB_ERROR_NO_DEVICE;
+    } else if (!isOpen_ || length != static_cast<int>(MCP2210::COMMAND_SIZE)) {
+        result = LIBUSB_ERROR_INVALID_PARAM;
+    } else if (endpointAddr < 0x80) {  // OUT direction
+        processCommand(data, response_);
+        responsePending_ = true;
+        bytes = length;
+    } else if (!responsePending_) {  // IN direction, but there is no response to be read
+        locker.unlock();
+        QThread::msleep(timeout);
+        result = LIBUSB_ERROR_TIMEOUT;
+    } else {  // IN direction
+        qint64 wait = responseReadyAt_ - clock_.nsecsElapsed() / 1000;  // Remaining time until the response is ready, in microseconds
+        if (wait > 1000 * static_cast<qint64>(timeout)) {  // The response will not be available in time (note that it remains pending)
+            locker.unlock();
+            QThread::msleep(timeout);
+            result = LIBUSB_ERROR_TIMEOUT;
+        } else {
+            if (wait > 0) {
+                QThread::usleep(static_cast<unsigned long>(wait));
+            }
+            std::memcpy(data, response_, MCP2210::COMMAND_SIZE);
+            responsePending_ = false;
+            bytes = length;
+        }
+    }
+    if (transferred != nullptr) {
+        *transferred = bytes;
+    }
+    return result;
+}
+
+// Lists the serial number of the emulated device, if the given VID and PID match the ones stored in its NVRAM
+QStringList MCP2210Emulator::listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr)
+{
+    Q_UNUSED(errcnt);
+    Q_UNUSED(errstr);
+    QMutexLocker locker(&mutex_);
+    QStringList devices;
+    if (connected_ && vid == (usbParameters_[1] << 8 | usbParameters_[0]) && pid == (usbParameters_[3] << 8 | usbParameters_[2])) {
+        devices += serial_;
+    }
+    return devices;
+}
+
+// Opens the emulated device, if the given VID, PID and, optionally, the given serial number match
+int MCP2210Emulator::open(quint16 vid, quint16 pid, const QString &serial)
+{
+    QMutexLocker locker(&mutex_);
+    int retval;
+    if (!connected_ || vid != (usbParameters_[1] << 8 | usbParameters_[0]) || pid != (usbParameters_[3] << 8 | usbParameters_[2]) || (!serial.isNull() && serial != serial_)) {
+        retval = MCP2210::ERROR_NOT_FOUND;
+    } else if (isOpen_) {  // Only one user is allowed, as if the interface was claimed
+        retval = MCP2210::ERROR_BUSY;
+    } else {
+        isOpen_ = true;
+        responsePending_ = false;
+        retval = MCP2210::SUCCESS;
+    }
+    return retval;
+}
+
+// Emulates a power cycle, which loads the power-up settings from the NVRAM and resets the access control state
+void MCP2210Emulator::powerCycle()
+{
+    QMutexLocker locker(&mutex_);
+    std::memcpy(chipSettings_, nvChipSettings_, sizeof(chipSettings_));
+    std::memcpy(spiSettings_, nvSPISettings_, sizeof(spiSettings_));
+    gpioOutputs_ = static_cast<quint16>(chipSettings_[10] << 8 | chipSettings_[9]);
+    gpioDirections_ = static_cast<quint16>(chipSettings_[12] << 8 | chipSettings_[11]);
+    eventCount_ = 0;
+    pwtries_ = 0;
+    pwok_ = false;
+    responsePending_ = false;
+    transferActive_ = false;
+    transferRemaining_ = 0;
+    misoBuffer_.clear();
+}
+
+// Returns the serial number of the emulated device
+QString MCP2210Emulator::serial() const
+{
+    QMutexLocker locker(&mutex_);
+    return serial_;
+}
+
+// Emulates a device disconnection (false) or reconnection (true), the latter implying a power cycle
+void MCP2210Emulator::setConnected(bool connected)
+{
+    QMutexLocker locker(&mutex_);
+    if (connected && !connected_) {
+        locker.unlock();
+        powerCycle();
+        locker.relock();
+    }
+    connected_ = connected;
+    if (!connected) {
+        isOpen_ = false;
+    }
+}
+
+// Sets the level that is externally applied to a given GPIO pin, counting events on GP6 according to the interrupt counting mode
+void MCP2210Emulator::setExternalInput(int gpio, bool value)
+{
+    QMutexLocker locker(&mutex_);
+    if (gpio >= MCP2210::GPIO0 && gpio <= MCP2210::GPIO8) {
+        quint16 mask = static_cast<quint16>(0x0001 << gpio);
+        bool previous = (mask & gpioInputs_) != 0x0000;
+        gpioInputs_ = value ? static_cast<quint16>(mask | gpioInputs_) : static_cast<quint16>(~mask & gpioInputs_);
+        if (gpio == MCP2210::GPIO6 && chipSettings_[6] == MCP2210::PCFUNC && previous != value) {  // GP6 is used as the interrupt input when configured as a dedicated function pin
+            quint8 intmode = static_cast<quint8>(0x07 & chipSettings_[13] >> 1);
+            bool rising = value;
+            if ((intmode == MCP2210::IMCNTFE && !rising) || (intmode == MCP2210::IMCNTRE && rising) ||  // Edges are counted as they happen
+                (intmode == MCP2210::IMCNTLP && rising) || (intmode == MCP2210::IMCNTHP && !rising)) {  // Pulses are counted as soon as they end
+                if (eventCount_ < 0xffff) {
+                    ++eventCount_;
+                }
+            }
+        }
+    }
+}
+
+// Emulates an external SPI master taking (true) or releasing (false) the SPI bus
+void MCP2210Emulator::setExternalMaster(bool active)
+{
+    QMutexLocker locker(&mutex_);
+    externalMaster_ = active;
+}
+
+// Sets the timing model
+void MCP2210Emulator::setTimingModel(const TimingModel &timingModel)
+{
+    QMutexLocker locker(&mutex_);
+    timingModel_ = timingModel;
+}
+
+// Private function that checks if NVRAM write access is blocked, according to the access control mode
+bool MCP2210Emulator::accessBlocked() const
+{
+    return accessControlMode_ == MCP2210::ACLOCKED || (accessControlMode_ == MCP2210::ACPASSWORD && !pwok_);
+}
+
+// Private function that returns a bitmap of the chip select pins currently selecting a slave (CS7 to CS0)
+// A pin selects when configured as chip select and its active value differs from its idle value
+quint8 MCP2210Emulator::activeChipSelects() const
+{
+    quint8 selects = 0x00;
+    quint8 toggled = static_cast<quint8>(spiSettings_[4] ^ spiSettings_[6]);  // Idle versus active chip select values (CS7 to CS0)
+    for (int i = 0; i < 8; ++i) {
+        if (chipSettings_[i] == MCP2210::PCCS && (0x01 << i & toggled) != 0x00) {
+            selects = static_cast<quint8>(0x01 << i | selects);
+        }
+    }
+    return selects;
+}
+
+// Private function that aborts any ongoing SPI transfer, deselecting the slaves
+void MCP2210Emulator::cancelTransfer()
+{
+    if (transferActive_) {
+        quint8 selects = activeChipSelects();
+        for (int i = 0; i < 8; ++i) {
+            if (slaves_[i] != nullptr && (0x01 << i & selects) != 0x00) {
+                slaves_[i]->deselect();
+            }
+        }
+        transferActive_ = false;
+    }
+    transferRemaining_ = 0;
+    misoBuffer_.clear();
+}
+
+// Private function that fills bytes 2 to 5 of the given response with the chip status
+void MCP2210Emulator::fillChipStatus(unsigned char *response) const
+{
+    response[2] = externalMaster_ ? 0x00 : 0x01;  // SPI bus release external request status (0x01 means no request)
+    if (externalMaster_) {
+        response[3] = MCP2210::BOEXT;
+    } else {
+        response[3] = transferActive_ ? MCP2210::BOOWN : MCP2210::BONO;
+    }
+    response[4] = pwtries_;
+    response[5] = pwok_ ? 0x01 : 0x00;
+}
+
+// Private function that returns the current values of all GPIO pins (GPIO8 to GPIO0)
+// Pins set as outputs return their latched value, while pins set as inputs return the externally applied level (GPIO8 is an input only pin)
+quint16 MCP2210Emulator::gpioValues() const
+{
+    quint16 directions = static_cast<quint16>(0x0100 | gpioDirections_);
+    return static_cast<quint16>((~directions & gpioOutputs_) | (directions & gpioInputs_)) & 0x01ff;
+}
+
+// Private function that processes a given 64-byte HID command, generating the corresponding response
+void MCP2210Emulator::processCommand(const unsigned char *command, unsigned char *response)
+{
+    std::memset(response, 0x00, MCP2210::COMMAND_SIZE);
+    response[0] = command[0];  // The command ID is always echoed
+    response[1] = MCP2210::COMPLETED;
+    qint64 processingTime = timingModel_.enabled ? timingModel_.usbLatency : 0;
+    switch (command[0]) {
+    case MCP2210::GET_CHIP_STATUS:
+        fillChipStatus(response);
+        break;
+    case MCP2210::CANCEL_SPI_TRANSFER:
+        cancelTransfer();
+        fillChipStatus(response);
+        break;
+    case MCP2210::GET_EVENT_COUNT:
+        response[4] = static_cast<quint8>(eventCount_);
+        response[5] = static_cast<quint8>(eventCount_ >> 8);
+        if (command[1] == 0x00) {  // Reset the event counter
+            eventCount_ = 0;
+        }
+        break;
+    case MCP2210::GET_CHIP_SETTINGS:
+        std::memcpy(response + 4, chipSettings_, sizeof(chipSettings_));
+        break;
+    case MCP2210::SET_CHIP_SETTINGS:
+        if (accessBlocked()) {
+            response[1] = MCP2210::BLOCKED;
+        } else if (transferActive_) {
+            response[1] = MCP2210::IN_PROGRESS;
+        } else {
+            std::memcpy(chipSettings_, command + 4, sizeof(chipSettings_));
+            gpioOutputs_ = static_cast<quint16>(chipSettings_[10] << 8 | chipSettings_[9]);  // Setting the chip settings also sets the GPIO outputs and directions
+            gpioDirections_ = static_cast<quint16>(chipSettings_[12] << 8 | chipSettings_[11]);
+        }
+        break;
+    case MCP2210::SET_GPIO_VALUES:
+        gpioOutputs_ = static_cast<quint16>((command[5] << 8 | command[4]) & 0x00ff);  // GPIO8 is an input only pin
+        response[4] = static_cast<quint8>(gpioValues());
+        response[5] = static_cast<quint8>(gpioValues() >> 8);
+        break;
+    case MCP2210::GET_GPIO_VALUES:
+        response[4] = static_cast<quint8>(gpioValues());
+        response[5] = static_cast<quint8>(gpioValues() >> 8);
+        break;
+    case MCP2210::SET_GPIO_DIRECTIONS:
+        gpioDirections_ = static_cast<quint16>(command[5] << 8 | command[4]);
+        response[4] = command[4];
+        response[5] = command[5];
+        break;
+    case MCP2210::GET_GPIO_DIRECTIONS:
+        response[4] = static_cast<quint8>(gpioDirections_);
+        response[5] = static_cast<quint8>(gpioDirections_ >> 8);
+        break;
+    case MCP2210::SET_SPI_SETTINGS:
+        if (transferActive_) {
+            response[1] = MCP2210::IN_PROGRESS;
+        } else {
+            quint32 bitrate = quantizeBitRate(static_cast<quint32>(command[7] << 24 | command[6] << 16 | command[5] << 8 | command[4]));
+            std::memcpy(spiSettings_, command + 4, sizeof(spiSettings_));
+            spiSettings_[0] = static_cast<quint8>(bitrate);  // Only supported bit rates are applied
+            spiSettings_[1] = static_cast<quint8>(bitrate >> 8);
+            spiSettings_[2] = static_cast<quint8>(bitrate >> 16);
+            spiSettings_[3] = static_cast<quint8>(bitrate >> 24);
+        }
+        break;
+    case MCP2210::GET_SPI_SETTINGS:
+        std::memcpy(response + 4, spiSettings_, sizeof(spiSettings_));
+        break;
+    case MCP2210::TRANSFER_SPI_DATA:
+        if (timingModel_.enabled && timingModel_.spiTiming) {
+            processingTime += spiTransferTime(command[1], !transferActive_, command[1] >= transferRemaining_);
+        }
+        transferSPIData(command, response);
+        break;
+    case MCP2210::READ_EEPROM:
+        response[2] = command[1];  // Address
+        response[3] = eeprom_[command[1]];  // Value
+        break;
+    case MCP2210::WRITE_EEPROM:
+        if (accessBlocked()) {
+            response[1] = MCP2210::BLOCKED;  // EEPROM is password protected or permanently locked
+        } else {
+            eeprom_[command[1]] = command[2];
+        }
+        break;
+    case MCP2210::SET_NVRAM_SETTINGS:
+        if (accessBlocked()) {
+            response[1] = MCP2210::BLOCKED;
+        } else {
+            response[1] = command[1];  // Sub-command ID
+            switch (command[1]) {
+            case MCP2210::NV_SPI_SETTINGS:
+                std::memcpy(nvSPISettings_, command + 4, sizeof(nvSPISettings_));
+                break;
+            case MCP2210::NV_CHIP_SETTINGS: {
+                std::memcpy(nvChipSettings_, command + 4, sizeof(nvChipSettings_));
+                accessControlMode_ = command[18];
+                bool passwordGiven = false;
+                for (size_t i = 0; i < sizeof(password_); ++i) {
+                    passwordGiven = passwordGiven || command[i + 19] != 0x00;
+                }
+                if (accessControlMode_ == MCP2210::ACPASSWORD && passwordGiven) {  // An empty password leaves the stored password unchanged
+                    std::memcpy(password_, command + 19, sizeof(password_));
+                }
+                break;
+            }
+            case MCP2210::USB_PARAMETERS:
+                std::memcpy(usbParameters_, command + 4, sizeof(usbParameters_));
+                break;
+            case MCP2210::PRODUCT_NAME:
+                std::memcpy(product_, command + 4, sizeof(product_));
+                break;
+            case MCP2210::MANUFACTURER_NAME:
+                std::memcpy(manufacturer_, command + 4, sizeof(manufacturer_));
+                break;
+            default:
+                response[1] = MCP2210::UNKNOWN;
+            }
+            if (response[1] == command[1]) {
+                response[1] = MCP2210::COMPLETED;
+            }
+        }
+        break;
+    case MCP2210::GET_NVRAM_SETTINGS:
+        response[1] = MCP2210::COMPLETED;
+        response[2] = command[1];  // Sub-command ID
+        switch (command[1]) {
+        case MCP2210::NV_SPI_SETTINGS:
+            std::memcpy(response + 4, nvSPISettings_, sizeof(nvSPISettings_));
+            break;
+        case MCP2210::NV_CHIP_SETTINGS:
+            std::memcpy(response + 4, nvChipSettings_, sizeof(nvChipSettings_));
+            response[18] = accessControlMode_;  // Note that the password is never returned
+            break;
+        case MCP2210::USB_PARAMETERS:
+            response[12] = usbParameters_[0];  // Vendor ID
+            response[13] = usbParameters_[1];
+            response[14] = usbParameters_[2];  // Product ID
+            response[15] = usbParameters_[3];
+            response[29] = usbParameters_[4];  // Chip power options
+            response[30] = usbParameters_[5];  // Maximum consumption current
+            break;
+        case MCP2210::PRODUCT_NAME:
+            std::memcpy(response + 4, product_, sizeof(product_));
+            break;
+        case MCP2210::MANUFACTURER_NAME:
+            std::memcpy(response + 4, manufacturer_, sizeof(manufacturer_));
+            break;
+        default:
+            response[1] = MCP2210::UNKNOWN;
+        }
+        break;
+    case MCP2210::SEND_PASSWORD:
+        if (accessControlMode_ == MCP2210::ACLOCKED) {
+            response[1] = MCP2210::REJECTED;
+        } else if (pwtries_ >= PWTRIES_MAX) {
+            response[1] = MCP2210::BLOCKED;
+        } else if (accessControlMode_ == MCP2210::ACNONE || std::memcmp(password_, command + 4, sizeof(password_)) == 0) {
+            pwok_ = true;
+        } else {
+            ++pwtries_;
+            response[1] = pwtries_ >= PWTRIES_MAX ? MCP2210::BLOCKED : MCP2210::WRONG_PASSWORD;
+        }
+        break;
+    default:
+        response[1] = MCP2210::UNKNOWN;
+    }
+    responseReadyAt_ = clock_.nsecsElapsed() / 1000 + processingTime;
+}
+
+// Private function that returns the time taken to clock the given number of bytes, in microseconds, including the applicable delays
+qint64 MCP2210Emulator::spiTransferTime(size_t bytes, bool first, bool last) const
+{
+    quint32 bitrate = static_cast<quint32>(spiSettings_[3] << 24 | spiSettings_[2] << 16 | spiSettings_[1] << 8 | spiSettings_[0]);
+    quint16 csdtdly = static_cast<quint16>(spiSettings_[9] << 8 | spiSettings_[8]);
+    quint16 dtcsdly = static_cast<quint16>(spiSettings_[11] << 8 | spiSettings_[10]);
+    quint16 itbytdly = static_cast<quint16>(spiSettings_[13] << 8 | spiSettings_[12]);
+    qint64 time = bitrate == 0 ? 0 : static_cast<qint64>(8000000ULL * bytes / bitrate);
+    if (bytes > 1) {
+        time += 100 * static_cast<qint64>(itbytdly) * static_cast<qint64>(bytes - 1);  // Delays are expressed in 100us units
+    }
+    if (first) {
+        time += 100 * static_cast<qint64>(csdtdly);
+    }
+    if (last) {
+        time += 100 * static_cast<qint64>(dtcsdly);
+    }
+    return time;
+}
+
+// Private function that processes a "TRANSFER_SPI_DATA" command
+// Data received from the slave is returned with the response to the following command, just as the MCP2210 does
+void MCP2210Emulator::transferSPIData(const unsigned char *command, unsigned char *response)
+{
+    size_t bytesToSend = command[1] > MCP2210::SPIDATA_MAXSIZE ? MCP2210::SPIDATA_MAXSIZE : command[1];
+    if (externalMaster_) {
+        response[1] = MCP2210::BUSY;
+    } else {
+        quint8 selects = activeChipSelects();
+        if (!transferActive_) {  // Start of a new SPI transaction
+            transferActive_ = true;
+            transferRemaining_ = static_cast<quint16>(spiSettings_[15] << 8 | spiSettings_[14]);
+            misoBuffer_.clear();
+            for (int i = 0; i < 8; ++i) {
+                if (slaves_[i] != nullptr && (0x01 << i & selects) != 0x00) {
+                    slaves_[i]->select();
+                }
+            }
+        }
+        size_t received = static_cast<size_t>(misoBuffer_.size());  // Data received during the previous command
+        for (size_t i = 0; i < received; ++i) {
+            response[i + MCP2210::PREAMBLE_SIZE] = misoBuffer_.at(static_cast<int>(i));
+        }
+        response[2] = static_cast<quint8>(received);
+        misoBuffer_.clear();
+        if (bytesToSend > transferRemaining_) {  // Excess data is ignored
+            bytesToSend = transferRemaining_;
+        }
+        for (size_t i = 0; i < bytesToSend; ++i) {
+            quint8 miso = 0xff;  // The MISO line is assumed to be pulled up when no slave drives it
+            for (int j = 0; j < 8; ++j) {
+                if (slaves_[j] != nullptr && (0x01 << j & selects) != 0x00) {
+                    miso = static_cast<quint8>(miso & slaves_[j]->transfer(command[i + MCP2210::PREAMBLE_SIZE]));  // Slaves driving the line simultaneously behave as a wired AND
+                }
+            }
+            misoBuffer_.push_back(miso);
+        }
+        transferRemaining_ = static_cast<quint16>(transferRemaining_ - bytesToSend);
+        if (transferRemaining_ == 0 && misoBuffer_.isEmpty()) {  // All data was sent and received
+            cancelTransfer();
+            response[3] = MCP2210::TRANSFER_FINISHED;
+        } else if (received == 0) {
+            response[3] = MCP2210::TRANSFER_STARTED;
+        } else {
+            response[3] = MCP2210::TRANSFER_NOT_FINISHED;
+        }
+    }
+}
+
+// Private function that stores a given string in a raw USB string descriptor
+void MCP2210Emulator::writeDescriptor(quint8 *descriptor, const QString &value)
+{
+    std::memset(descriptor, 0x00, 60);
+    int length = value.size() > static_cast<int>(MCP2210::DESC_MAXLEN) ? static_cast<int>(MCP2210::DESC_MAXLEN) : value.size();
+    descriptor[0] = static_cast<quint8>(2 * length + 2);  // Descriptor length in bytes
+    descriptor[1] = 0x03;  // USB descriptor constant
+    for (int i = 0; i < length; ++i) {
+        descriptor[2 * i + 2] = static_cast<quint8>(value[i].unicode());
+        descriptor[2 * i + 3] = static_cast<quint8>(value[i].unicode() >> 8);
+    }
+}
+
+// Private helper function that returns the highest supported bit rate not exceeding the given one (or the minimum supported bit rate, if the given one is lower)
+quint32 MCP2210Emulator::quantizeBitRate(quint32 bitrate)
+{
+    quint32 quantized = SUPPORTED_BITRATES[0];
+    for (size_t i = 0; i < sizeof(SUPPORTED_BITRATES) / sizeof(SUPPORTED_BITRATES[0]) && SUPPORTED_BITRATES[i] <= bitrate; ++i) {
+        quantized = SUPPORTED_BITRATES[i];
+    }
+    return quantized;
+}
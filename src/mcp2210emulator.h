@@ -0,0 +1,112 @@
+/* MCP2210 emulator for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210EMULATOR_H
+#define MCP2210EMULATOR_H
+
+// Includes
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "mcp2210transport.h"
+
+// Software model of the MCP2210 that implements the complete HID command set, so that it can be used as a transport in place of real hardware
+// The model includes the NVRAM sections, the 256-byte EEPROM, the access control state machine, the GPIO pins and event counter, and the SPI engine
+class MCP2210Emulator : public MCP2210Transport
+{
+public:
+    // Pluggable model of an SPI slave, attached to a given chip select pin via attachSPISlave()
+    class SPISlave
+    {
+    public:
+        virtual ~SPISlave();
+
+        virtual void deselect();
+        virtual void select();
+        virtual quint8 transfer(quint8 mosi) = 0;
+    };
+
+    // SPI slave model that returns each received byte as is
+    class LoopbackSlave : public SPISlave
+    {
+    public:
+        quint8 transfer(quint8 mosi);
+    };
+
+    struct TimingModel {
+        bool enabled;             // Timing model enabled (if false, every response is available immediately)
+        unsigned int usbLatency;  // Round-trip latency for each command, in microseconds (a full-speed interrupt endpoint is polled once every millisecond)
+        bool spiTiming;           // Take into account the SPI wire time and the configured SPI delays
+    };
+
+private:
+    mutable QMutex mutex_;
+    QString serial_;
+    SPISlave *slaves_[9];
+    TimingModel timingModel_;
+    QElapsedTimer clock_;
+    qint64 responseReadyAt_;
+    unsigned char response_[64];
+    bool connected_, externalMaster_, isOpen_, pwok_, responsePending_, transferActive_;
+    quint8 accessControlMode_, pwtries_;
+    quint8 password_[8];
+    quint8 nvChipSettings_[14], nvSPISettings_[17], chipSettings_[14], spiSettings_[17];
+    quint8 usbParameters_[6];
+    quint8 manufacturer_[60], product_[60];
+    quint8 eeprom_[256];
+    quint16 eventCount_, gpioDirections_, gpioInputs_, gpioOutputs_;
+    QVector<quint8> misoBuffer_;
+    quint16 transferRemaining_;
+
+    bool accessBlocked() const;
+    quint8 activeChipSelects() const;
+    void cancelTransfer();
+    void fillChipStatus(unsigned char *response) const;
+    quint16 gpioValues() const;
+    void processCommand(const unsigned char *command, unsigned char *response);
+    qint64 spiTransferTime(size_t bytes, bool first, bool last) const;
+    void transferSPIData(const unsigned char *command, unsigned char *response);
+    void writeDescriptor(quint8 *descriptor, const QString &value);
+
+    static quint32 quantizeBitRate(quint32 bitrate);
+
+public:
+    explicit MCP2210Emulator(const QString &serial = QString("0000000001"));
+    ~MCP2210Emulator();
+
+    bool isOpen() const;
+
+    void attachSPISlave(int cs, SPISlave *slave);
+    void close();
+    QVector<quint8> eeprom() const;
+    int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout);
+    QStringList listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr);
+    int open(quint16 vid, quint16 pid, const QString &serial);
+    void powerCycle();
+    QString serial() const;
+    void setConnected(bool connected);
+    void setExternalInput(int gpio, bool value);
+    void setExternalMaster(bool active);
+    void setTimingModel(const TimingModel &timingModel);
+};
+
+#endif  // MCP2210EMULATOR_H
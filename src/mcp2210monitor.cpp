@@ -0,0 +1,207 @@
+/* MCP2210 polling monitor for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include "mcp2210monitor.h"
+
+// Checks if both samples hold the same value, assuming that they refer to the same query
+bool MCP2210Monitor::Sample::sameValue(const Sample &other) const
+{
+    bool retval;
+    if (query == QYGPIOS) {
+        retval = gpios == other.gpios;
+    } else if (query == QYCHIPSTATUS) {
+        retval = chipStatus == other.chipStatus;
+    } else {
+        retval = eventCount == other.eventCount;
+    }
+    return retval;
+}
+
+// Private function that returns the shortest interval among all subscriptions to the given query (zero if there are none)
+int MCP2210Monitor::shortestInterval(int query) const
+{
+    int shortest = 0;
+    for (const Subscription &subscription : subscriptions_) {
+        if (subscription.query == query && (shortest == 0 || subscription.interval < shortest)) {
+            shortest = subscription.interval;
+        }
+    }
+    return shortest;
+}
+
+// Private function that starts the timer so that it fires when the earliest subscription is due, or stops it if there are no subscriptions
+void MCP2210Monitor::schedule()
+{
+    if (subscriptions_.isEmpty()) {
+        timer_.stop();
+    } else {
+        qint64 next = subscriptions_.first().due;
+        for (const Subscription &subscription : subscriptions_) {
+            if (subscription.due < next) {
+                next = subscription.due;
+            }
+        }
+        qint64 delay = next - clock_.elapsed();
+        timer_.start(delay < 0 ? 0 : static_cast<int>(delay));
+    }
+}
+
+// Private function that sends the given query to the device, returning the result as a sample
+MCP2210Monitor::Sample MCP2210Monitor::sample(int query, qint64 now, int &errcnt, QString &errstr)
+{
+    Sample sample = Sample();
+    sample.query = query;
+    sample.timestamp = now;
+    if (query == QYGPIOS) {
+        sample.gpios = mcp2210_.getGPIOs(errcnt, errstr);
+    } else if (query == QYCHIPSTATUS) {
+        sample.chipStatus = mcp2210_.getChipStatus(errcnt, errstr);
+    } else {
+        sample.eventCount = mcp2210_.getEventCount(errcnt, errstr);
+    }
+    ++commands_;
+    return sample;
+}
+
+// Creates a monitor for the given device, which must remain valid during the lifetime of the monitor
+MCP2210Monitor::MCP2210Monitor(MCP2210 &mcp2210, QObject *parent) :
+    QObject(parent),
+    mcp2210_(mcp2210),
+    timer_(this),  // The timer is a child of the monitor, so that it follows the monitor when moved to another thread
+    commands_(0),
+    notifications_(0),
+    nextId_(1)
+{
+    for (int i = 0; i < QUERIES; ++i) {
+        sampled_[i] = false;
+    }
+    clock_.start();
+    timer_.setSingleShot(true);
+    timer_.setTimerType(Qt::PreciseTimer);
+    connect(&timer_, &QTimer::timeout, this, &MCP2210Monitor::poll);
+}
+
+// Returns the number of queries sent to the device so far
+quint64 MCP2210Monitor::commands() const
+{
+    return commands_;
+}
+
+// Returns the number of samples delivered to subscribers so far
+quint64 MCP2210Monitor::notifications() const
+{
+    return notifications_;
+}
+
+// Returns the number of active subscriptions
+int MCP2210Monitor::subscriptionCount() const
+{
+    return subscriptions_.size();
+}
+
+// Subscribes to the given query (see "QY" values), to be sampled every given interval (in milliseconds), returning the subscription ID
+// The first sample is taken as soon as control returns to the event loop
+// If "changesOnly" is true, the callback is only called for the first sample and whenever the value changes afterwards
+// Callbacks run on the thread that the monitor lives in, and may subscribe or unsubscribe
+int MCP2210Monitor::subscribe(int query, int interval, const Callback &callback, bool changesOnly)
+{
+    Subscription subscription;
+    subscription.id = nextId_++;
+    subscription.query = query < QYGPIOS || query >= QUERIES ? QYGPIOS : query;
+    subscription.interval = interval < 1 ? 1 : interval;
+    subscription.changesOnly = changesOnly;
+    subscription.callback = callback;
+    subscription.due = clock_.elapsed();
+    subscription.notified = false;
+    subscription.last = Sample();
+    subscriptions_ += subscription;
+    schedule();
+    return subscription.id;
+}
+
+// Cancels the subscription having the given ID (this has no effect if the ID is not valid)
+void MCP2210Monitor::unsubscribe(int id)
+{
+    for (int i = 0; i < subscriptions_.size(); ++i) {
+        if (subscriptions_[i].id == id) {
+            subscriptions_.removeAt(i);
+            break;
+        }
+    }
+    schedule();
+}
+
+// Serves all subscriptions that are due, sending each required query to the device at most once
+// Subscriptions due within a quarter of their interval are served as well, so that subscriptions having similar rates share their queries
+void MCP2210Monitor::poll()
+{
+    qint64 now = clock_.elapsed();
+    QList<int> due;
+    bool needed[QUERIES] = {};
+    for (const Subscription &subscription : subscriptions_) {
+        if (subscription.due - subscription.interval / 4 <= now) {
+            due += subscription.id;
+            needed[subscription.query] = true;
+        }
+    }
+    int errcnt = 0;
+    QString errstr;
+    bool available[QUERIES] = {};
+    for (int i = 0; i < QUERIES; ++i) {
+        if (needed[i]) {
+            if (!sampled_[i] || now - samples_[i].timestamp >= 3 * shortestInterval(i) / 4) {  // Otherwise, the previous sample is recent enough to be shared
+                int preverrcnt = errcnt;
+                Sample result = sample(i, now, errcnt, errstr);
+                if (errcnt == preverrcnt) {
+                    samples_[i] = result;
+                    sampled_[i] = true;
+                    available[i] = true;
+                }
+            } else {
+                available[i] = true;
+            }
+        }
+    }
+    for (int id : due) {
+        for (int i = 0; i < subscriptions_.size(); ++i) {
+            if (subscriptions_[i].id == id) {  // The subscription may have been cancelled by a previous callback
+                Subscription &subscription = subscriptions_[i];
+                subscription.due += subscription.interval;
+                if (subscription.due <= now) {  // Missed deadlines are skipped, instead of causing a burst of samples
+                    subscription.due = now + subscription.interval;
+                }
+                const Sample &result = samples_[subscription.query];
+                if (available[subscription.query] && (!subscription.changesOnly || !subscription.notified || !result.sameValue(subscription.last))) {
+                    subscription.notified = true;
+                    subscription.last = result;
+                    Callback callback = subscription.callback;  // Copied, since the callback may modify the list of subscriptions
+                    ++notifications_;
+                    callback(result);
+                }
+                break;
+            }
+        }
+    }
+    if (errcnt > 0) {
+        emit errorOccurred(errstr);
+    }
+    schedule();
+}
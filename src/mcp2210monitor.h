@@ -0,0 +1,108 @@
+/* MCP2210 polling monitor for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210MONITOR_H
+#define MCP2210MONITOR_H
+
+// Includes
+#include <functional>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "mcp2210.h"
+
+// Polling scheduler that serves several monitors of the same device (e.g. GPIO, chip status and event count monitors) using a single timer
+// Each subscription asks for a given query at a given interval, and all subscriptions are merged onto a single timeline
+// A query is sent to the device at most once per tick, and is not repeated within three quarters of the shortest interval subscribed for it, so that traffic is bounded by the fastest subscriber
+// Subscribers that are due at about the same time are served in the same tick, and can ask to be notified only when the value changes
+// The device is accessed from the thread that the monitor lives in, so the MCP2210 object must be in thread-safe mode if it is also used by other threads
+class MCP2210Monitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The following values are applicable to subscribe()
+    static const int QYGPIOS = 0;        // GPIO values, via "GET_GPIO_VALUES"
+    static const int QYCHIPSTATUS = 1;   // Chip status, via "GET_CHIP_STATUS"
+    static const int QYEVENTCOUNT = 2;   // Event count, via "GET_EVENT_COUNT" (without resetting the counter)
+    static const int QUERIES = 3;        // Number of queries
+
+    // Result of a query, of which only the field that corresponds to the query is meaningful
+    struct Sample {
+        int query;                       // Query (see "QY" values)
+        quint16 gpios;                   // GPIO values (QYGPIOS)
+        MCP2210::ChipStatus chipStatus;  // Chip status (QYCHIPSTATUS)
+        quint16 eventCount;              // Event count (QYEVENTCOUNT)
+        qint64 timestamp;                // Time at which the query was sent, in milliseconds since the monitor was created
+
+        bool sameValue(const Sample &other) const;
+    };
+
+    typedef std::function<void(const Sample &sample)> Callback;
+
+private:
+    struct Subscription {
+        int id;
+        int query;
+        int interval;         // Interval, in milliseconds
+        bool changesOnly;     // Only notify when the value changes
+        Callback callback;
+        qint64 due;           // Time at which the subscription is next due
+        bool notified;        // At least one sample was delivered
+        Sample last;          // Last sample delivered
+    };
+
+    MCP2210 &mcp2210_;
+    QTimer timer_;
+    QElapsedTimer clock_;
+    QList<Subscription> subscriptions_;
+    Sample samples_[QUERIES];  // Last sample obtained for each query
+    bool sampled_[QUERIES];    // A sample was obtained for the given query
+    quint64 commands_;
+    quint64 notifications_;
+    int nextId_;
+
+    int shortestInterval(int query) const;
+    void schedule();
+    Sample sample(int query, qint64 now, int &errcnt, QString &errstr);
+
+public:
+    explicit MCP2210Monitor(MCP2210 &mcp2210, QObject *parent = nullptr);
+    MCP2210Monitor(const MCP2210Monitor &) = delete;
+
+    MCP2210Monitor &operator =(const MCP2210Monitor &) = delete;
+
+    quint64 commands() const;
+    quint64 notifications() const;
+    int subscriptionCount() const;
+
+    int subscribe(int query, int interval, const Callback &callback, bool changesOnly = false);
+    void unsubscribe(int id);
+
+signals:
+    void errorOccurred(const QString &errstr);
+
+private slots:
+    void poll();
+};
+
+#endif  // MCP2210MONITOR_H
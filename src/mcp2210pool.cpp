@@ -0,0 +1,460 @@
+/* MCP2210 device pool for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QMutexLocker>
+#include <QObject>
+#include <QQueue>
+#include <QSemaphore>
+#include <QThread>
+#include <QWaitCondition>
+#include "mcp2210pool.h"
+
+// Definitions
+const int WORKERS_MAX = 16;  // Maximum number of worker threads chosen by default (a single worker can serve many devices, since each HID command takes about 1ms)
+
+// Worker thread that runs queued tasks in order
+class MCP2210Pool::Worker : public QThread
+{
+private:
+    QMutex mutex_;
+    QWaitCondition condition_;
+    QQueue<std::function<void()>> tasks_;
+    bool stopping_;
+
+protected:
+    void run();
+
+public:
+    int devices;  // Number of devices assigned to this worker (protected by the mutex of the pool)
+
+    Worker();
+
+    void post(const std::function<void()> &task);
+    void stop();
+};
+
+// Runs queued tasks until stopped, and only after running all tasks that were queued before the stop request
+void MCP2210Pool::Worker::run()
+{
+    bool done = false;
+    while (!done) {
+        std::function<void()> task;
+        mutex_.lock();
+        while (tasks_.isEmpty() && !stopping_) {
+            condition_.wait(&mutex_);
+        }
+        if (tasks_.isEmpty()) {
+            done = true;
+        } else {
+            task = tasks_.dequeue();
+        }
+        mutex_.unlock();
+        if (task) {
+            task();
+        }
+    }
+}
+
+MCP2210Pool::Worker::Worker() :
+    stopping_(false),
+    devices(0)
+{
+}
+
+// Queues the given task
+void MCP2210Pool::Worker::post(const std::function<void()> &task)
+{
+    QMutexLocker locker(&mutex_);
+    tasks_.enqueue(task);
+    condition_.wakeOne();
+}
+
+// Requests the worker to stop, once all queued tasks are run, and waits for it to finish
+void MCP2210Pool::Worker::stop()
+{
+    mutex_.lock();
+    stopping_ = true;
+    condition_.wakeOne();
+    mutex_.unlock();
+    wait();
+}
+
+// Private function that is used to add a reference to the given entry
+void MCP2210Pool::acquire(Entry *entry)
+{
+    QMutexLocker locker(&mutex_);
+    ++entry->references;
+}
+
+// Private function that is used to run a job on the given entry, updating its health state
+// This function always runs on the worker assigned to the entry
+void MCP2210Pool::execute(Entry *entry, const Job &job, int &errcnt, QString &errstr)
+{
+    int preverrcnt = errcnt;
+    QString jobErrstr;
+    job(*entry->mcp2210, errcnt, jobErrstr);
+    errstr += jobErrstr;
+    bool disconnected = entry->mcp2210->disconnected();
+    QMutexLocker locker(&mutex_);
+    ++entry->jobs;
+    if (errcnt == preverrcnt) {
+        entry->consecutiveErrors = 0;
+        entry->health = disconnected ? HSDISCONNECTED : HSHEALTHY;
+    } else {
+        ++entry->failedJobs;
+        ++entry->consecutiveErrors;
+        entry->lastError = jobErrstr;
+        entry->health = disconnected ? HSDISCONNECTED : HSDEGRADED;
+    }
+}
+
+// Private function that returns the entry of the device having the given VID, PID and serial number, or a null pointer if there is none
+// Must be called with the pool mutex held
+MCP2210Pool::Entry *MCP2210Pool::find(quint16 vid, quint16 pid, const QString &serial) const
+{
+    Entry *retval = nullptr;
+    for (Entry *entry : entries_) {
+        if (entry->vid == vid && entry->pid == pid && entry->serial == serial) {
+            retval = entry;
+            break;
+        }
+    }
+    return retval;
+}
+
+// Private function that is used to remove a reference to the given entry, closing the device once the last reference is removed
+// Closing is done by the assigned worker, after any jobs that are still queued for the device
+void MCP2210Pool::release(Entry *entry)
+{
+    QMutexLocker locker(&mutex_);
+    --entry->references;
+    if (entry->references == 0) {
+        entries_.removeOne(entry);  // The entry is no longer found by open(), so a new one is created if the device is opened again
+        --entry->worker->devices;
+        entry->worker->post([entry]() {
+            entry->mcp2210->close();
+            delete entry->mcp2210;
+            delete entry;
+        });
+    }
+}
+
+// Private constructor, used by MCP2210Pool to create a valid handle (a reference must be acquired beforehand)
+MCP2210Pool::Handle::Handle(MCP2210Pool *pool, Entry *entry) :
+    pool_(pool),
+    entry_(entry)
+{
+}
+
+// Creates an invalid handle
+MCP2210Pool::Handle::Handle() :
+    pool_(nullptr),
+    entry_(nullptr)
+{
+}
+
+// Move constructor, which leaves the other handle invalid
+MCP2210Pool::Handle::Handle(Handle &&other) :
+    pool_(other.pool_),
+    entry_(other.entry_)
+{
+    other.pool_ = nullptr;
+    other.entry_ = nullptr;
+}
+
+MCP2210Pool::Handle::~Handle()
+{
+    release();
+}
+
+// Move assignment operator, which releases the current device (if any) and leaves the other handle invalid
+MCP2210Pool::Handle &MCP2210Pool::Handle::operator =(Handle &&other)
+{
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        entry_ = other.entry_;
+        other.pool_ = nullptr;
+        other.entry_ = nullptr;
+    }
+    return *this;
+}
+
+// Returns the number of consecutive jobs that failed (zero if the handle is invalid)
+int MCP2210Pool::Handle::consecutiveErrors() const
+{
+    int errors = 0;
+    if (entry_ != nullptr) {
+        QMutexLocker locker(&pool_->mutex_);
+        errors = entry_->consecutiveErrors;
+    }
+    return errors;
+}
+
+// Returns the number of jobs that failed (zero if the handle is invalid)
+quint64 MCP2210Pool::Handle::failedJobs() const
+{
+    quint64 failedJobs = 0;
+    if (entry_ != nullptr) {
+        QMutexLocker locker(&pool_->mutex_);
+        failedJobs = entry_->failedJobs;
+    }
+    return failedJobs;
+}
+
+// Returns the health state of the device, based on the outcome of the last job ("HSDISCONNECTED" [2] if the handle is invalid)
+int MCP2210Pool::Handle::health() const
+{
+    int health = HSDISCONNECTED;
+    if (entry_ != nullptr) {
+        QMutexLocker locker(&pool_->mutex_);
+        health = entry_->health;
+    }
+    return health;
+}
+
+// Checks if the handle is valid
+bool MCP2210Pool::Handle::isValid() const
+{
+    return entry_ != nullptr;
+}
+
+// Returns the number of jobs run (zero if the handle is invalid)
+quint64 MCP2210Pool::Handle::jobs() const
+{
+    quint64 jobs = 0;
+    if (entry_ != nullptr) {
+        QMutexLocker locker(&pool_->mutex_);
+        jobs = entry_->jobs;
+    }
+    return jobs;
+}
+
+// Returns the error string of the last failed job (empty if the handle is invalid)
+QString MCP2210Pool::Handle::lastError() const
+{
+    QString lastError;
+    if (entry_ != nullptr) {
+        QMutexLocker locker(&pool_->mutex_);
+        lastError = entry_->lastError;
+    }
+    return lastError;
+}
+
+// Returns the underlying MCP2210 object (null if the handle is invalid)
+// The object is in thread-safe mode, so it can be used directly from any thread, although jobs should be preferred
+MCP2210 *MCP2210Pool::Handle::mcp2210() const
+{
+    return entry_ == nullptr ? nullptr : entry_->mcp2210;
+}
+
+// Returns the serial number of the device (empty if the handle is invalid)
+QString MCP2210Pool::Handle::serial() const
+{
+    return entry_ == nullptr ? QString() : entry_->serial;
+}
+
+// Queues the given job to run on the worker assigned to the device, without waiting for it
+// Any errors are reflected by the health state of the device, and by lastError()
+void MCP2210Pool::Handle::post(const Job &job)
+{
+    post(job, Completion());
+}
+
+// Queues the given job to run on the worker assigned to the device, and calls the given completion handler once it finishes
+// The completion handler runs on the same worker, after the health state of the device is updated, and may post further jobs or release handles
+// If the handle is invalid, the completion handler is called immediately, reporting an error
+void MCP2210Pool::Handle::post(const Job &job, const Completion &completion)
+{
+    if (entry_ == nullptr) {
+        if (completion) {
+            completion(1, QObject::tr("In post(): invalid handle.\n"));  // Program logic error
+        }
+    } else {
+        MCP2210Pool *pool = pool_;
+        Entry *entry = entry_;
+        pool->acquire(entry);  // The entry must remain valid until the job runs, even if this handle is released meanwhile
+        entry->worker->post([pool, entry, job, completion]() {
+            int errcnt = 0;
+            QString errstr;
+            pool->execute(entry, job, errcnt, errstr);
+            if (completion) {
+                completion(errcnt, errstr);
+            }
+            pool->release(entry);
+        });
+    }
+}
+
+// Releases the device, leaving the handle invalid (the device is closed if no other handles reference it)
+void MCP2210Pool::Handle::release()
+{
+    if (entry_ != nullptr) {
+        pool_->release(entry_);
+        pool_ = nullptr;
+        entry_ = nullptr;
+    }
+}
+
+// Runs the given job on the worker assigned to the device, and waits for it to finish
+// If called from that worker (i.e., from within another job), the job runs immediately
+void MCP2210Pool::Handle::run(const Job &job, int &errcnt, QString &errstr)
+{
+    if (entry_ == nullptr) {
+        ++errcnt;
+        errstr += QObject::tr("In run(): invalid handle.\n");  // Program logic error
+    } else if (QThread::currentThread() == entry_->worker) {
+        pool_->execute(entry_, job, errcnt, errstr);
+    } else {
+        MCP2210Pool *pool = pool_;
+        Entry *entry = entry_;
+        QSemaphore done;
+        int *errcntPtr = &errcnt;
+        QString *errstrPtr = &errstr;
+        entry->worker->post([pool, entry, &job, &done, errcntPtr, errstrPtr]() {
+            pool->execute(entry, job, *errcntPtr, *errstrPtr);
+            done.release();
+        });
+        done.acquire();
+    }
+}
+
+// Creates a pool with the given number of worker threads (if zero, the ideal thread count is used, up to a maximum of 16)
+MCP2210Pool::MCP2210Pool(int workers)
+{
+    if (workers <= 0) {
+        workers = qBound(1, QThread::idealThreadCount(), WORKERS_MAX);
+    }
+    for (int i = 0; i < workers; ++i) {
+        Worker *worker = new Worker;
+        worker->start();
+        workers_ += worker;
+    }
+}
+
+// Note that all handles must be released before the pool is destroyed
+MCP2210Pool::~MCP2210Pool()
+{
+    for (Worker *worker : workers_) {
+        worker->stop();  // Any pending jobs, including those that close devices, are run before the worker stops
+        delete worker;
+    }
+}
+
+// Returns the number of open devices
+int MCP2210Pool::deviceCount() const
+{
+    QMutexLocker locker(&mutex_);
+    int count = 0;
+    for (Entry *entry : entries_) {
+        if (!entry->opening) {  // Devices that are still being opened are not counted
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Returns the serial numbers of all open devices
+QStringList MCP2210Pool::openDevices() const
+{
+    QMutexLocker locker(&mutex_);
+    QStringList devices;
+    for (Entry *entry : entries_) {
+        if (!entry->opening) {
+            devices += entry->serial;
+        }
+    }
+    return devices;
+}
+
+// Returns the number of worker threads
+int MCP2210Pool::workerCount() const
+{
+    return workers_.size();
+}
+
+// Opens the device having the given VID, PID and serial number, returning a handle to it
+// If the device is already open in the pool, the existing MCP2210 object is shared, and no USB access takes place
+// The device is opened without holding the pool mutex, so that other devices can be opened or released meanwhile, while concurrent calls for the same device wait for the outcome
+// If the device cannot be opened, the returned handle is invalid
+MCP2210Pool::Handle MCP2210Pool::open(quint16 vid, quint16 pid, const QString &serial, int &errcnt, QString &errstr)
+{
+    QMutexLocker locker(&mutex_);
+    Entry *found = find(vid, pid, serial);
+    while (found != nullptr && found->opening) {  // Another thread is opening the same device
+        openCondition_.wait(&mutex_);
+        found = find(vid, pid, serial);  // The entry is removed if that thread fails to open the device
+    }
+    if (found == nullptr) {
+        found = new Entry;  // The entry is reserved, so that the device is only opened once
+        found->mcp2210 = nullptr;
+        found->vid = vid;
+        found->pid = pid;
+        found->serial = serial;
+        found->worker = nullptr;
+        found->references = 0;
+        found->opening = true;
+        found->health = HSHEALTHY;
+        found->jobs = 0;
+        found->failedJobs = 0;
+        found->consecutiveErrors = 0;
+        entries_ += found;
+        locker.unlock();
+        MCP2210 *mcp2210 = new MCP2210;
+        mcp2210->setThreadSafe(true);
+        int result = mcp2210->open(vid, pid, serial);
+        locker.relock();
+        if (result != MCP2210::SUCCESS) {
+            ++errcnt;
+            if (result == MCP2210::ERROR_NOT_FOUND) {
+                errstr += QObject::tr("Could not find device with serial number %1.\n").arg(serial);
+            } else if (result == MCP2210::ERROR_BUSY) {
+                errstr += QObject::tr("Device with serial number %1 is currently unavailable.\n").arg(serial);
+            } else if (result == MCP2210::ERROR_ACCESS) {
+                errstr += QObject::tr("Access to device with serial number %1 was denied.\n").arg(serial);
+            } else {
+                errstr += QObject::tr("Could not initialize device with serial number %1.\n").arg(serial);
+            }
+            entries_.removeOne(found);
+            delete found;
+            found = nullptr;
+            delete mcp2210;
+        } else {
+            Worker *worker = workers_.first();
+            for (Worker *candidate : workers_) {  // The least loaded worker is chosen
+                if (candidate->devices < worker->devices) {
+                    worker = candidate;
+                }
+            }
+            ++worker->devices;
+            found->mcp2210 = mcp2210;
+            found->worker = worker;
+            found->opening = false;
+        }
+        openCondition_.wakeAll();
+    }
+    Handle handle;
+    if (found != nullptr) {
+        ++found->references;
+        handle = Handle(this, found);
+    }
+    return handle;
+}
@@ -0,0 +1,128 @@
+/* MCP2210 device pool for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210POOL_H
+#define MCP2210POOL_H
+
+// Includes
+#include <functional>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+#include "mcp2210.h"
+
+// Pool that manages many open MCP2210 devices, using a fixed budget of worker threads
+// Each device is assigned to the least loaded worker when opened, and all jobs for that device run on that worker, in order
+// Devices are shared by serial number: opening a device that is already open returns another handle to the same MCP2210 object
+// A device is closed once its last handle is destroyed
+class MCP2210Pool
+{
+public:
+    // Job to be run on a device, using the usual error reporting convention (see post() and run())
+    typedef std::function<void(MCP2210 &mcp2210, int &errcnt, QString &errstr)> Job;
+
+    // Completion handler, which runs on the worker right after the job it refers to, given the errors reported by that job (see post())
+    typedef std::function<void(int errcnt, const QString &errstr)> Completion;
+
+    // The following values are applicable to Handle::health()
+    static const int HSHEALTHY = 0;       // Last job completed without errors
+    static const int HSDEGRADED = 1;      // Last job failed, but the device is still connected
+    static const int HSDISCONNECTED = 2;  // Device has been disconnected
+
+private:
+    class Worker;
+
+    struct Entry {
+        MCP2210 *mcp2210;
+        quint16 vid;
+        quint16 pid;
+        QString serial;
+        Worker *worker;
+        int references;         // Number of handles referencing the entry
+        bool opening;           // The device is being opened (see open())
+        int health;             // Health state (see "HS" values)
+        quint64 jobs;           // Number of jobs run
+        quint64 failedJobs;     // Number of jobs that failed
+        int consecutiveErrors;  // Number of consecutive jobs that failed
+        QString lastError;      // Error string of the last failed job
+    };
+
+    mutable QMutex mutex_;
+    QWaitCondition openCondition_;
+    QList<Entry *> entries_;
+    QList<Worker *> workers_;
+
+    void acquire(Entry *entry);
+    void execute(Entry *entry, const Job &job, int &errcnt, QString &errstr);
+    Entry *find(quint16 vid, quint16 pid, const QString &serial) const;
+    void release(Entry *entry);
+
+public:
+    // Move-only handle to a device in the pool, which keeps the device open while valid
+    class Handle
+    {
+    private:
+        MCP2210Pool *pool_;
+        Entry *entry_;
+
+        Handle(MCP2210Pool *pool, Entry *entry);
+
+        friend class MCP2210Pool;
+
+    public:
+        Handle();
+        Handle(const Handle &) = delete;
+        Handle(Handle &&other);
+        ~Handle();
+
+        Handle &operator =(const Handle &) = delete;
+        Handle &operator =(Handle &&other);
+
+        int consecutiveErrors() const;
+        quint64 failedJobs() const;
+        int health() const;
+        bool isValid() const;
+        quint64 jobs() const;
+        QString lastError() const;
+        MCP2210 *mcp2210() const;
+        QString serial() const;
+
+        void post(const Job &job);
+        void post(const Job &job, const Completion &completion);
+        void release();
+        void run(const Job &job, int &errcnt, QString &errstr);
+    };
+
+    explicit MCP2210Pool(int workers = 0);
+    MCP2210Pool(const MCP2210Pool &) = delete;
+    ~MCP2210Pool();
+
+    MCP2210Pool &operator =(const MCP2210Pool &) = delete;
+
+    int deviceCount() const;
+    QStringList openDevices() const;
+    int workerCount() const;
+
+    Handle open(quint16 vid, quint16 pid, const QString &serial, int &errcnt, QString &errstr);
+};
+
+#endif  // MCP2210POOL_H
@@ -0,0 +1,87 @@
+/* MCP2210 daemon protocol for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include "mcp2210protocol.h"
+
+// Definitions
+const quint32 PAYLOAD_MAXSIZE = MCP2210Protocol::BATCH_MAXSIZE * (MCP2210Protocol::RESULT_SIZE + MCP2210Protocol::PACKET_SIZE);  // Maximum payload size, given by the largest "TRANSFER" answer
+
+// Appends a 16-bit value to the given data, in little-endian format
+void MCP2210Protocol::appendUInt16(QByteArray &data, quint16 value)
+{
+    data += static_cast<char>(value);
+    data += static_cast<char>(value >> 8);
+}
+
+// Appends a 32-bit value to the given data, in little-endian format
+void MCP2210Protocol::appendUInt32(QByteArray &data, quint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        data += static_cast<char>(value >> 8 * i);
+    }
+}
+
+// Builds a frame of the given type, containing the given payload
+QByteArray MCP2210Protocol::buildFrame(quint8 type, const QByteArray &payload)
+{
+    QByteArray frame;
+    frame.reserve(HEADER_SIZE + payload.size());
+    frame += static_cast<char>(type);
+    appendUInt32(frame, static_cast<quint32>(payload.size()));
+    frame += payload;
+    return frame;
+}
+
+// Reads a 16-bit value from the given data, at the given index, in little-endian format
+// The caller must ensure that the data has at least two bytes from that index onwards
+quint16 MCP2210Protocol::readUInt16(const QByteArray &data, int index)
+{
+    return static_cast<quint16>(static_cast<quint8>(data.at(index + 1)) << 8 | static_cast<quint8>(data.at(index)));
+}
+
+// Reads a 32-bit value from the given data, at the given index, in little-endian format
+// The caller must ensure that the data has at least four bytes from that index onwards
+quint32 MCP2210Protocol::readUInt32(const QByteArray &data, int index)
+{
+    return static_cast<quint32>(static_cast<quint8>(data.at(index + 3)) << 24 | static_cast<quint8>(data.at(index + 2)) << 16 | static_cast<quint8>(data.at(index + 1)) << 8 | static_cast<quint8>(data.at(index)));
+}
+
+// Takes the first complete frame from the given buffer, if available, returning "FRTAKEN" [1] in that case
+int MCP2210Protocol::takeFrame(QByteArray &buffer, quint8 &type, QByteArray &payload)
+{
+    int retval;
+    if (buffer.size() < HEADER_SIZE) {
+        retval = FRINCOMPLETE;
+    } else {
+        quint32 size = readUInt32(buffer, 1);
+        if (size > PAYLOAD_MAXSIZE) {
+            retval = FRINVALID;
+        } else if (static_cast<quint32>(buffer.size()) < HEADER_SIZE + size) {
+            retval = FRINCOMPLETE;
+        } else {
+            type = static_cast<quint8>(buffer.at(0));
+            payload = buffer.mid(HEADER_SIZE, static_cast<int>(size));
+            buffer.remove(0, HEADER_SIZE + static_cast<int>(size));
+            retval = FRTAKEN;
+        }
+    }
+    return retval;
+}
@@ -0,0 +1,62 @@
+/* MCP2210 daemon protocol for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210PROTOCOL_H
+#define MCP2210PROTOCOL_H
+
+// Includes
+#include <QByteArray>
+#include <QtGlobal>
+
+// Protocol spoken between the MCP2210 daemon (mcp2210d) and its clients (see SocketTransport) over a local socket
+// Every message is a frame made of a 5-byte header (type and payload length, the latter being a little-endian 32-bit value), followed by the payload
+// Requests are answered in order, using frames of the same type, and only "CLOSE" requests have no answer
+namespace MCP2210Protocol
+{
+const char DEFAULT_SERVER[] = "mcp2210d";  // Default local server name (overridden via the "MCP2210_SOCKET" environment variable)
+const int HEADER_SIZE = 5;                 // Frame header size
+const int PACKET_SIZE = 64;                // HID report size
+const int BATCH_MAXSIZE = 256;             // Maximum number of HID commands per "TRANSFER" request
+const int RESULT_SIZE = 4;                 // Size of each result field (little-endian 32-bit value)
+
+// Frame types
+const quint8 LIST = 0x01;      // Lists devices (request: VID and PID; answer: status byte, followed by the newline-separated serial numbers, or by an error message, in UTF-8)
+const quint8 OPEN = 0x02;      // Opens a device (request: VID, PID and serial number in UTF-8; answer: open() result)
+const quint8 CLOSE = 0x03;     // Closes the device (no payload, and no answer)
+const quint8 TRANSFER = 0x04;  // Transfers a batch of HID commands atomically (request: 64 bytes per command; answer: libusb result, followed by 64 bytes, per command)
+
+// The following values are applicable to the status byte of "LIST" answers
+const quint8 STOK = 0x00;      // Devices listed successfully
+const quint8 STFAILED = 0x01;  // Failed to list devices
+
+void appendUInt16(QByteArray &data, quint16 value);
+void appendUInt32(QByteArray &data, quint32 value);
+QByteArray buildFrame(quint8 type, const QByteArray &payload);
+quint16 readUInt16(const QByteArray &data, int index);
+quint32 readUInt32(const QByteArray &data, int index);
+int takeFrame(QByteArray &buffer, quint8 &type, QByteArray &payload);
+
+// The following values are returned by takeFrame()
+const int FRINCOMPLETE = 0;  // No complete frame available yet
+const int FRTAKEN = 1;       // Frame taken from the buffer
+const int FRINVALID = 2;     // Frame is invalid (oversized payload), and the connection should be dropped
+}
+
+#endif  // MCP2210PROTOCOL_H
@@ -0,0 +1,55 @@
+/* MCP2210 volatile state for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include "mcp2210state.h"
+
+// Returns a mask of the pins configured as GPIO outputs (GPIO7 to GPIO0), which are the only pins whose values are part of the state
+quint8 MCP2210State::outputMask() const
+{
+    const quint8 pins[] = {
+        chipSettings.gp0, chipSettings.gp1, chipSettings.gp2, chipSettings.gp3, chipSettings.gp4, chipSettings.gp5, chipSettings.gp6, chipSettings.gp7
+    };
+    quint8 mask = 0x00;
+    for (int i = MCP2210::GPIO0; i <= MCP2210::GPIO7; ++i) {
+        if (pins[i] == MCP2210::PCGPIO && (0x01 << i & chipSettings.gpdir) == 0x00) {  // A direction bit set to zero corresponds to an output
+            mask = static_cast<quint8>(0x01 << i | mask);
+        }
+    }
+    return mask;
+}
+
+// "Equal to" operator for MCP2210State
+// The values of pins that are not GPIO outputs are ignored, since they do not depend on the state
+bool MCP2210State::operator ==(const MCP2210State &other) const
+{
+    MCP2210::ChipSettings chipSettings1 = chipSettings;
+    MCP2210::ChipSettings chipSettings2 = other.chipSettings;
+    quint8 mask = outputMask();
+    chipSettings1.gpout = static_cast<quint8>(mask & chipSettings1.gpout);
+    chipSettings2.gpout = static_cast<quint8>(mask & chipSettings2.gpout);
+    return chipSettings1 == chipSettings2 && spiSettings == other.spiSettings;  // Note that the masks are equal if the remaining chip settings are equal
+}
+
+// "Not equal to" operator for MCP2210State
+bool MCP2210State::operator !=(const MCP2210State &other) const
+{
+    return !(operator ==(other));
+}
@@ -0,0 +1,40 @@
+/* MCP2210 volatile state for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210STATE_H
+#define MCP2210STATE_H
+
+// Includes
+#include "mcp2210.h"
+
+// Volatile state of an MCP2210, comprising the current chip settings and SPI transfer settings
+// The fields "gpdir" and "gpout" of the chip settings hold the current GPIO directions and output values, rather than their power-up defaults
+struct MCP2210State
+{
+    MCP2210::ChipSettings chipSettings;
+    MCP2210::SPISettings spiSettings;
+
+    quint8 outputMask() const;
+
+    bool operator ==(const MCP2210State &other) const;
+    bool operator !=(const MCP2210State &other) const;
+};
+
+#endif  // MCP2210STATE_H
@@ -0,0 +1,264 @@
+/* MCP2210 statistics for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QDateTime>
+#include <QObject>
+#include "mcp2210.h"
+#include "mcp2210stats.h"
+
+// Definitions
+const quint8 COMMAND_IDS[MCP2210Stats::COMMAND_SLOTS] = {  // Command ID corresponding to each slot (the last slot aggregates unknown commands)
+    MCP2210::GET_CHIP_STATUS, MCP2210::CANCEL_SPI_TRANSFER, MCP2210::GET_EVENT_COUNT, MCP2210::GET_CHIP_SETTINGS, MCP2210::SET_CHIP_SETTINGS,
+    MCP2210::SET_GPIO_VALUES, MCP2210::GET_GPIO_VALUES, MCP2210::SET_GPIO_DIRECTIONS, MCP2210::GET_GPIO_DIRECTIONS, MCP2210::SET_SPI_SETTINGS,
+    MCP2210::GET_SPI_SETTINGS, MCP2210::TRANSFER_SPI_DATA, MCP2210::READ_EEPROM, MCP2210::WRITE_EEPROM, MCP2210::SET_NVRAM_SETTINGS,
+    MCP2210::GET_NVRAM_SETTINGS, MCP2210::SEND_PASSWORD, 0x00
+};
+
+// Returns the slot index corresponding to the given command ID
+static int slotIndex(quint8 command)
+{
+    int index = MCP2210Stats::COMMAND_SLOTS - 1;
+    for (int i = 0; i < MCP2210Stats::COMMAND_SLOTS - 1; ++i) {
+        if (COMMAND_IDS[i] == command) {
+            index = i;
+            break;
+        }
+    }
+    return index;
+}
+
+// Returns the mean of the samples, in microseconds
+double MCP2210Stats::Histogram::mean() const
+{
+    return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+}
+
+// Returns the given percentile (0 to 100) of the samples, in microseconds
+// The returned value is the upper bound of the bucket containing the percentile, and thus is never an underestimate
+quint64 MCP2210Stats::Histogram::percentile(double p) const
+{
+    quint64 retval = 0;
+    if (count > 0) {
+        quint64 target = static_cast<quint64>(p / 100.0 * count + 0.5);
+        if (target == 0) {
+            target = 1;
+        } else if (target > count) {
+            target = count;
+        }
+        quint64 accumulated = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+            accumulated += buckets[i];
+            if (accumulated >= target) {
+                retval = bucketUpperBound(i);
+                break;
+            }
+        }
+    }
+    return retval;
+}
+
+// Returns a human readable summary of the snapshot, one line per command
+QString MCP2210Stats::Snapshot::toString() const
+{
+    QString summary = QObject::tr("Statistics over %1 ms:\n").arg(elapsed);
+    for (const CommandStats &stats : commands) {
+        summary += QObject::tr("0x%1: %2 transfers, %3 timeouts, %4 disconnects, %5 invalid, %6 errors; OUT p50/p99 %7/%8 us; IN p50/p99 %9/%10 us\n")
+                       .arg(stats.command, 2, 16, QChar('0'))
+                       .arg(stats.count)
+                       .arg(stats.timeouts)
+                       .arg(stats.disconnects)
+                       .arg(stats.invalidResponses)
+                       .arg(stats.errors)
+                       .arg(stats.outLatency.percentile(50))
+                       .arg(stats.outLatency.percentile(99))
+                       .arg(stats.inLatency.percentile(50))
+                       .arg(stats.inLatency.percentile(99));
+    }
+    for (int i = 0; i < PRIORITY_CLASSES; ++i) {
+        if (queueDelays[i].count != 0) {
+            summary += QObject::tr("%1 priority: %2 packets queued; p50/p99/max %3/%4/%5 us\n")
+                           .arg(i == PCHIGH ? QObject::tr("High") : QObject::tr("Normal"))
+                           .arg(queueDelays[i].count)
+                           .arg(queueDelays[i].percentile(50))
+                           .arg(queueDelays[i].percentile(99))
+                           .arg(queueDelays[i].percentile(100));
+        }
+    }
+    return summary;
+}
+
+MCP2210Stats::MCP2210Stats() :
+    enabled_(0),
+    resetTime_(QDateTime::currentMSecsSinceEpoch())
+{
+    reset();
+}
+
+// Checks if statistics are being recorded
+bool MCP2210Stats::isEnabled() const
+{
+    return enabled_.loadAcquire() != 0;
+}
+
+// Returns a copy of the current statistics, which can be taken from any thread
+// Since counters are read individually, a snapshot taken during a transfer may be slightly inconsistent (e.g. a count may be ahead of its histogram)
+MCP2210Stats::Snapshot MCP2210Stats::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.elapsed = QDateTime::currentMSecsSinceEpoch() - resetTime_.load();
+    for (int i = 0; i < COMMAND_SLOTS; ++i) {
+        const Slot &slot = slots_[i];
+        if (slot.count.load() != 0) {
+            CommandStats stats;
+            stats.command = COMMAND_IDS[i];
+            stats.count = slot.count.load();
+            stats.timeouts = slot.timeouts.load();
+            stats.disconnects = slot.disconnects.load();
+            stats.invalidResponses = slot.invalidResponses.load();
+            stats.errors = slot.errors.load();
+            copyHistogram(slot.outLatency, stats.outLatency);
+            copyHistogram(slot.inLatency, stats.inLatency);
+            snapshot.commands += stats;
+        }
+    }
+    for (int i = 0; i < PRIORITY_CLASSES; ++i) {
+        copyHistogram(queueDelays_[i], snapshot.queueDelays[i]);
+    }
+    return snapshot;
+}
+
+// Records a HID transfer, given its command ID, the OUT and IN latencies (in nanoseconds) and the outcome
+// A negative latency means that the corresponding transfer was not attempted, and thus it is not sampled
+void MCP2210Stats::record(quint8 command, qint64 outTime, qint64 inTime, int outcome)
+{
+    Slot &slot = slots_[slotIndex(command)];
+    slot.count.fetchAndAddRelaxed(1);
+    if (outTime >= 0) {
+        recordSample(slot.outLatency, outTime / 1000);
+    }
+    if (inTime >= 0) {
+        recordSample(slot.inLatency, inTime / 1000);
+    }
+    if (outcome == OCTIMEOUT) {
+        slot.timeouts.fetchAndAddRelaxed(1);
+    } else if (outcome == OCDISCONNECTED) {
+        slot.disconnects.fetchAndAddRelaxed(1);
+    } else if (outcome == OCINVALID) {
+        slot.invalidResponses.fetchAndAddRelaxed(1);
+    } else if (outcome == OCERROR) {
+        slot.errors.fetchAndAddRelaxed(1);
+    }
+}
+
+// Records the time a packet of the given priority class waited for the USB interface (in nanoseconds)
+void MCP2210Stats::recordQueueDelay(int priorityClass, qint64 delay)
+{
+    if (priorityClass >= 0 && priorityClass < PRIORITY_CLASSES) {
+        recordSample(queueDelays_[priorityClass], delay / 1000);
+    }
+}
+
+// Clears all statistics
+void MCP2210Stats::reset()
+{
+    for (int i = 0; i < COMMAND_SLOTS; ++i) {
+        Slot &slot = slots_[i];
+        slot.count.store(0);
+        slot.timeouts.store(0);
+        slot.disconnects.store(0);
+        slot.invalidResponses.store(0);
+        slot.errors.store(0);
+        resetHistogram(slot.outLatency);
+        resetHistogram(slot.inLatency);
+    }
+    for (int i = 0; i < PRIORITY_CLASSES; ++i) {
+        resetHistogram(queueDelays_[i]);
+    }
+    resetTime_.store(QDateTime::currentMSecsSinceEpoch());
+}
+
+// Enables or disables recording (statistics are preserved while disabled)
+void MCP2210Stats::setEnabled(bool enabled)
+{
+    enabled_.storeRelease(enabled ? 1 : 0);
+}
+
+// Returns the index of the histogram bucket corresponding to the given value
+// Values up to seven are mapped linearly, and every subsequent power of two is split into eight equally sized buckets
+int MCP2210Stats::bucketIndex(quint64 value)
+{
+    int index;
+    if (value < 8) {
+        index = static_cast<int>(value);
+    } else {
+        int msb = 3;  // Position of the most significant bit
+        while (value >> (msb + 1) != 0) {
+            ++msb;
+        }
+        index = 8 * (msb - 2) + static_cast<int>(0x07 & value >> (msb - 3));
+        if (index >= HISTOGRAM_BUCKETS) {
+            index = HISTOGRAM_BUCKETS - 1;
+        }
+    }
+    return index;
+}
+
+// Returns the (exclusive) upper bound of the histogram bucket having the given index
+quint64 MCP2210Stats::bucketUpperBound(int index)
+{
+    quint64 bound;
+    if (index < 8) {
+        bound = static_cast<quint64>(index + 1);
+    } else {
+        int shift = index / 8 - 1;
+        bound = static_cast<quint64>(8 + index % 8 + 1) << shift;
+    }
+    return bound;
+}
+
+// Private helper function that copies the given atomic histogram into a plain one
+void MCP2210Stats::copyHistogram(const AtomicHistogram &source, Histogram &destination)
+{
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        destination.buckets[i] = source.buckets[i].load();
+    }
+    destination.count = source.count.load();
+    destination.sum = source.sum.load();
+}
+
+// Private helper function that records a sample, in microseconds, into the given histogram
+void MCP2210Stats::recordSample(AtomicHistogram &histogram, qint64 value)
+{
+    quint64 sample = static_cast<quint64>(value);
+    histogram.buckets[bucketIndex(sample)].fetchAndAddRelaxed(1);
+    histogram.count.fetchAndAddRelaxed(1);
+    histogram.sum.fetchAndAddRelaxed(sample);
+}
+
+// Private helper function that clears the given histogram
+void MCP2210Stats::resetHistogram(AtomicHistogram &histogram)
+{
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        histogram.buckets[i].store(0);
+    }
+    histogram.count.store(0);
+    histogram.sum.store(0);
+}
@@ -0,0 +1,126 @@
+/* MCP2210 statistics for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210STATS_H
+#define MCP2210STATS_H
+
+// Includes
+#include <QAtomicInteger>
+#include <QString>
+#include <QVector>
+
+// Per-command HID transfer statistics, comprising counters and OUT/IN latency histograms
+// Recording is lock-free (relaxed atomic increments only), so that snapshots can be taken from any thread while transfers are ongoing
+// Histograms are log-linear, having eight sub-buckets per power of two, which keeps the relative error of any percentile under 12.5%
+class MCP2210Stats
+{
+public:
+    // Class definitions
+    static const int HISTOGRAM_BUCKETS = 200;  // Number of buckets per histogram (latencies above 125s fall into the last bucket)
+    static const int COMMAND_SLOTS = 18;       // One slot per known HID command ID, plus one for any other command
+
+    // The following values are applicable to record()
+    static const int OCCOMPLETED = 0;     // Transfer completed successfully
+    static const int OCTIMEOUT = 1;       // Transfer timed out
+    static const int OCDISCONNECTED = 2;  // Device disconnected during the transfer
+    static const int OCINVALID = 3;       // Invalid response received
+    static const int OCERROR = 4;         // Other transfer error
+
+    // Priority classes, applicable to recordQueueDelay() (see MCP2210::setThreadSafe() for details)
+    static const int PCNORMAL = 0;          // Normal priority (all commands not listed below)
+    static const int PCHIGH = 1;            // High priority (GPIO commands and "CANCEL_SPI_TRANSFER")
+    static const int PRIORITY_CLASSES = 2;  // Number of priority classes
+
+    struct Histogram {
+        quint64 buckets[HISTOGRAM_BUCKETS];  // Number of samples per bucket
+        quint64 count;                       // Total number of samples
+        quint64 sum;                         // Sum of all samples, in microseconds
+
+        double mean() const;
+        quint64 percentile(double p) const;
+    };
+
+    struct CommandStats {
+        quint8 command;             // HID command ID (zero for the slot that aggregates unknown commands)
+        quint64 count;              // Number of HID transfers
+        quint64 timeouts;           // Number of transfers that timed out
+        quint64 disconnects;        // Number of transfers that failed due to device disconnection
+        quint64 invalidResponses;   // Number of invalid responses
+        quint64 errors;             // Number of transfers that failed for any other reason
+        Histogram outLatency;       // OUT transfer latencies, in microseconds
+        Histogram inLatency;        // IN transfer latencies, in microseconds
+    };
+
+    struct ReconnectStats {
+        quint64 disconnects;        // Number of outages detected while automatic reconnection was enabled (see MCP2210::setAutoReconnect())
+        quint64 reconnects;         // Number of successful reconnections
+        quint64 failedReconnects;   // Number of outages in which reconnecting timed out, or reconnections that failed to restore the volatile state
+        quint64 resumedOperations;  // Number of interrupted commands that were resent after reconnecting
+        qint64 lastDowntime;        // Duration of the last reconnection attempt, in milliseconds
+        qint64 maxDowntime;         // Longest reconnection attempt, in milliseconds
+        qint64 totalDowntime;       // Total time spent reconnecting, in milliseconds
+    };
+
+    struct Snapshot {
+        qint64 elapsed;                  // Time elapsed since statistics were enabled or last reset, in milliseconds
+        QVector<CommandStats> commands;  // Statistics for each command that was used at least once
+        Histogram queueDelays[PRIORITY_CLASSES];  // Time spent by packets of each priority class waiting for the USB interface, in microseconds (thread-safe mode only)
+
+        QString toString() const;
+    };
+
+    MCP2210Stats();
+    MCP2210Stats(const MCP2210Stats &) = delete;
+
+    MCP2210Stats &operator =(const MCP2210Stats &) = delete;
+
+    bool isEnabled() const;
+    Snapshot snapshot() const;
+
+    void record(quint8 command, qint64 outTime, qint64 inTime, int outcome);
+    void recordQueueDelay(int priorityClass, qint64 delay);
+    void reset();
+    void setEnabled(bool enabled);
+
+    static int bucketIndex(quint64 value);
+    static quint64 bucketUpperBound(int index);
+
+private:
+    struct AtomicHistogram {
+        QAtomicInteger<quint64> buckets[HISTOGRAM_BUCKETS];
+        QAtomicInteger<quint64> count, sum;
+    };
+
+    struct Slot {
+        QAtomicInteger<quint64> count, timeouts, disconnects, invalidResponses, errors;
+        AtomicHistogram outLatency, inLatency;
+    };
+
+    QAtomicInteger<int> enabled_;
+    QAtomicInteger<qint64> resetTime_;
+    Slot slots_[COMMAND_SLOTS];
+    AtomicHistogram queueDelays_[PRIORITY_CLASSES];
+
+    static void copyHistogram(const AtomicHistogram &source, Histogram &destination);
+    static void recordSample(AtomicHistogram &histogram, qint64 value);
+    static void resetHistogram(AtomicHistogram &histogram);
+};
+
+#endif  // MCP2210STATS_H
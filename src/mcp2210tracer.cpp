@@ -0,0 +1,230 @@
+/* MCP2210 tracer for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cstring>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QIODevice>
+#include <QThread>
+#include "mcp2210tracer.h"
+
+// Definitions
+const unsigned long FLUSH_INTERVAL = 50;  // Interval between ring drains, in milliseconds
+
+// Background thread that periodically drains the ring to the trace file
+class MCP2210Tracer::FlushThread : public QThread
+{
+private:
+    MCP2210Tracer *tracer_;
+
+protected:
+    void run()
+    {
+        while (!isInterruptionRequested()) {
+            tracer_->flush();
+            QThread::msleep(FLUSH_INTERVAL);
+        }
+        tracer_->flush();  // Final drain
+    }
+
+public:
+    explicit FlushThread(MCP2210Tracer *tracer) :
+        tracer_(tracer)
+    {
+    }
+};
+
+QAtomicPointer<MCP2210Tracer> MCP2210Tracer::instance_;
+
+// Private constructor, which preallocates the ring (see start())
+MCP2210Tracer::MCP2210Tracer(const QString &fileName, quint64 capacity) :
+    slots_(new Slot[capacity]),
+    capacity_(capacity),
+    head_(0),
+    tail_(0),
+    dropped_(0),
+    file_(fileName),
+    firstEvent_(true),
+    flushThread_(nullptr)
+{
+    for (quint64 i = 0; i < capacity_; ++i) {
+        slots_[i].sequence.store(i);
+    }
+}
+
+MCP2210Tracer::~MCP2210Tracer()
+{
+    delete[] slots_;
+}
+
+// Private function that drains the ring, writing all published events to the trace file (only called from the flush thread)
+void MCP2210Tracer::flush()
+{
+    QByteArray json;
+    for (;;) {
+        Slot &slot = slots_[tail_ & (capacity_ - 1)];
+        if (slot.sequence.loadAcquire() != tail_ + 1) {  // No more published events
+            break;
+        }
+        const Event &event = slot.event;
+        json += firstEvent_ ? "\n" : ",\n";
+        firstEvent_ = false;
+        json += "{\"name\":\"";
+        json += event.name;
+        json += "\",\"cat\":\"";
+        json += event.category;
+        json += "\",\"ph\":\"X\",\"ts\":";
+        json += QByteArray::number(static_cast<double>(event.timestamp) / 1000, 'f', 3);  // Timestamps and durations are expressed in microseconds
+        json += ",\"dur\":";
+        json += QByteArray::number(static_cast<double>(event.duration) / 1000, 'f', 3);
+        json += ",\"pid\":";
+        json += QByteArray::number(QCoreApplication::applicationPid());
+        json += ",\"tid\":";
+        json += QByteArray::number(event.threadID);
+        if (event.arg >= 0) {
+            json += ",\"args\":{\"id\":\"0x";
+            json += QByteArray::number(event.arg, 16).rightJustified(2, '0');
+            json += "\"}";
+        }
+        json += "}";
+        slot.sequence.storeRelease(tail_ + capacity_);  // The slot can now be reused
+        ++tail_;
+    }
+    if (!json.isEmpty()) {
+        file_.write(json);
+        file_.flush();
+    }
+}
+
+// Private function that pushes an event to the ring, or drops it if the ring is full
+void MCP2210Tracer::push(const char *name, const char *category, qint64 timestamp, qint64 duration, int arg)
+{
+    quint64 position = head_.load();
+    Slot *slot;
+    for (;;) {
+        slot = &slots_[position & (capacity_ - 1)];
+        qint64 difference = static_cast<qint64>(slot->sequence.loadAcquire() - position);
+        if (difference == 0) {  // The slot is free, so it can be claimed
+            if (head_.testAndSetRelaxed(position, position + 1)) {
+                break;
+            }
+            position = head_.load();
+        } else if (difference < 0) {  // The ring is full
+            dropped_.fetchAndAddRelaxed(1);
+            return;
+        } else {  // Another thread claimed the slot meanwhile
+            position = head_.load();
+        }
+    }
+    Event &event = slot->event;
+    std::strncpy(event.name, name, sizeof(event.name) - 1);
+    event.name[sizeof(event.name) - 1] = '\0';
+    event.category = category;
+    event.timestamp = timestamp;
+    event.duration = duration;
+    event.threadID = static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    event.arg = arg;
+    slot->sequence.storeRelease(position + 1);  // Publish the event
+}
+
+// Checks if the tracer is running
+bool MCP2210Tracer::isEnabled()
+{
+    return instance_.loadAcquire() != nullptr;
+}
+
+// Returns the current trace time in nanoseconds, or zero if the tracer is not running
+qint64 MCP2210Tracer::now()
+{
+    MCP2210Tracer *tracer = instance_.loadAcquire();
+    return tracer == nullptr ? 0 : tracer->clock_.nsecsElapsed();
+}
+
+// Records a span with the given name and category, starting at the given trace time (see now()) and ending at the present time
+// The name is copied, but the category must be a string literal
+void MCP2210Tracer::record(const char *name, const char *category, qint64 timestamp, int arg)
+{
+    MCP2210Tracer *tracer = instance_.loadAcquire();
+    if (tracer != nullptr) {
+        tracer->push(name, category, timestamp, tracer->clock_.nsecsElapsed() - timestamp, arg);
+    }
+}
+
+// Starts tracing to the given file, using a ring having the given capacity (rounded up to a power of two)
+// Returns false if the tracer is already running or the file could not be created
+bool MCP2210Tracer::start(const QString &fileName, quint64 capacity)
+{
+    bool retval = false;
+    if (instance_.loadAcquire() == nullptr) {
+        quint64 roundedCapacity = 1;
+        while (roundedCapacity < capacity) {
+            roundedCapacity <<= 1;
+        }
+        MCP2210Tracer *tracer = new MCP2210Tracer(fileName, roundedCapacity);
+        if (!tracer->file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            delete tracer;
+        } else {
+            tracer->file_.write("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+            tracer->clock_.start();
+            tracer->flushThread_ = new FlushThread(tracer);
+            tracer->flushThread_->start();
+            instance_.storeRelease(tracer);
+            retval = true;
+        }
+    }
+    return retval;
+}
+
+// Stops tracing, draining any pending events and completing the trace file
+// This should only be called when no other threads are recording events (e.g. before the application exits)
+void MCP2210Tracer::stop()
+{
+    MCP2210Tracer *tracer = instance_.fetchAndStoreOrdered(nullptr);
+    if (tracer != nullptr) {
+        tracer->flushThread_->requestInterruption();
+        tracer->flushThread_->wait();
+        delete tracer->flushThread_;
+        QByteArray footer = "\n],\"otherData\":{\"droppedEvents\":\"";
+        footer += QByteArray::number(tracer->dropped_.load());
+        footer += "\"}}\n";
+        tracer->file_.write(footer);
+        tracer->file_.close();
+        delete tracer;
+    }
+}
+
+// Starts a span, if the tracer is running (the name must outlive the span)
+MCP2210TraceSpan::MCP2210TraceSpan(const char *name, const char *category, int arg) :
+    name_(name),
+    category_(category),
+    enabled_(MCP2210Tracer::isEnabled()),
+    start_(MCP2210Tracer::now()),
+    arg_(arg)
+{
+}
+
+// Ends the span, recording it if the tracer is running and was already running when the span started
+MCP2210TraceSpan::~MCP2210TraceSpan()
+{
+    if (enabled_ && MCP2210Tracer::isEnabled()) {
+        MCP2210Tracer::record(name_, category_, start_, arg_);
+    }
+}
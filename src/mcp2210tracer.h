@@ -0,0 +1,103 @@
+/* MCP2210 tracer for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210TRACER_H
+#define MCP2210TRACER_H
+
+// Includes
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+
+// Optional tracer that records spans of device operations and exports them in the Chrome trace event format (JSON), which can be opened with Perfetto or chrome://tracing
+// Events are stored in a preallocated lock-free ring, which is drained by a background thread, so that recording a span never blocks, allocates or does file I/O
+// If the ring becomes full, new events are dropped (and counted) rather than stalling the caller
+class MCP2210Tracer
+{
+private:
+    class FlushThread;
+
+    struct Event {
+        char name[48];         // Event name (truncated if longer)
+        const char *category;  // Event category (must be a string literal)
+        qint64 timestamp;      // Start time in nanoseconds, relative to the start of the trace
+        qint64 duration;       // Duration in nanoseconds
+        quint64 threadID;      // ID of the thread that recorded the event
+        int arg;               // Optional argument (e.g. HID command ID), or -1 if not used
+    };
+
+    struct Slot {
+        QAtomicInteger<quint64> sequence;
+        Event event;
+    };
+
+    Slot *slots_;
+    quint64 capacity_;
+    QAtomicInteger<quint64> head_;
+    quint64 tail_;
+    QAtomicInteger<quint64> dropped_;
+    QElapsedTimer clock_;
+    QFile file_;
+    bool firstEvent_;
+    FlushThread *flushThread_;
+
+    static QAtomicPointer<MCP2210Tracer> instance_;
+
+    MCP2210Tracer(const QString &fileName, quint64 capacity);
+    ~MCP2210Tracer();
+
+    void flush();
+    void push(const char *name, const char *category, qint64 timestamp, qint64 duration, int arg);
+
+public:
+    static const quint64 DEFAULT_CAPACITY = 65536;  // Default ring capacity in events (must be a power of two)
+
+    MCP2210Tracer(const MCP2210Tracer &) = delete;
+
+    MCP2210Tracer &operator =(const MCP2210Tracer &) = delete;
+
+    static bool isEnabled();
+    static qint64 now();
+    static void record(const char *name, const char *category, qint64 timestamp, int arg = -1);
+    static bool start(const QString &fileName, quint64 capacity = DEFAULT_CAPACITY);
+    static void stop();
+};
+
+// Convenience class that records a span covering its own lifetime, if the tracer is enabled
+class MCP2210TraceSpan
+{
+private:
+    const char *name_;
+    const char *category_;
+    bool enabled_;
+    qint64 start_;
+    int arg_;
+
+public:
+    MCP2210TraceSpan(const char *name, const char *category, int arg = -1);
+    MCP2210TraceSpan(const MCP2210TraceSpan &) = delete;
+    ~MCP2210TraceSpan();
+
+    MCP2210TraceSpan &operator =(const MCP2210TraceSpan &) = delete;
+};
+
+#endif  // MCP2210TRACER_H
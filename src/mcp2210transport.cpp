@@ -0,0 +1,120 @@
+/* MCP2210 transport interface for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+#include "libusbtransport.h"
+#include "mcp2210emulator.h"
+#include "mcp2210transport.h"
+#include "recordingtransport.h"
+#include "replaytransport.h"
+#include "sockettransport.h"
+#ifdef Q_OS_LINUX
+#include "hidrawtransport.h"
+#endif
+
+MCP2210Transport::~MCP2210Transport()
+{
+}
+
+// Enumerates the devices having the given VID and PID, returning their locations and USB strings along with their serial numbers
+// Devices found at the same path and address as one of the "known" devices (i.e. not attached again since) may be reported as such, without being opened to read their strings
+// This default implementation only knows the serial numbers returned by listDevices(), and is kept by transports that cannot obtain more information cheaply
+QVector<MCP2210Transport::DeviceInfo> MCP2210Transport::enumerateDevices(quint16 vid, quint16 pid, const QVector<DeviceInfo> &known, int &errcnt, QString &errstr)
+{
+    Q_UNUSED(known);  // Locations are not known here, so known devices cannot be told apart
+    QStringList serials = listDevices(vid, pid, errcnt, errstr);
+    QVector<DeviceInfo> devices;
+    devices.reserve(serials.size());
+    for (const QString &serial : serials) {
+        DeviceInfo device = DeviceInfo();
+        device.address = -1;
+        device.serial = serial;
+        devices += device;
+    }
+    return devices;
+}
+
+// Checks if several processes can open the same device at once via this transport, in which case no advisory lock is needed to arbitrate access (see MCP2210::open())
+// Transports that claim the device exclusively, such as the libusb and hidraw transports, keep this default implementation
+bool MCP2210Transport::isShared() const
+{
+    return false;
+}
+
+// Creates a new transport of the default type (see defaultType() for details)
+// If the environment variable "MCP2210_RECORD" is set, the transport is wrapped so that all HID traffic gets recorded to the file it names
+// The caller takes ownership of the returned object
+MCP2210Transport *MCP2210Transport::create()
+{
+    MCP2210Transport *transport = create(defaultType());
+    QString recordFile = QFile::decodeName(qgetenv("MCP2210_RECORD"));
+    if (!recordFile.isEmpty()) {
+        transport = new RecordingTransport(transport, recordFile);
+    }
+    return transport;
+}
+
+// Creates a new transport of the given type, falling back to the libusb transport if the type is not supported
+// The caller takes ownership of the returned object
+MCP2210Transport *MCP2210Transport::create(int type)
+{
+    MCP2210Transport *transport;
+    if (type == EMULATOR) {
+        transport = new MCP2210Emulator;
+    } else if (type == REPLAY) {  // The trace to be replayed is given by the environment variable "MCP2210_REPLAY"
+        ReplayTransport *replayTransport = new ReplayTransport;
+        int errcnt = 0;
+        QString errstr;
+        replayTransport->load(QFile::decodeName(qgetenv("MCP2210_REPLAY")), errcnt, errstr);  // On failure, the trace stays empty and no devices are found
+        transport = replayTransport;
+    } else if (type == SOCKET) {
+        transport = new SocketTransport;
+#ifdef Q_OS_LINUX
+    } else if (type == HIDRAW) {
+        transport = new HidrawTransport;
+#endif
+    } else {
+        transport = new LibusbTransport;
+    }
+    return transport;
+}
+
+// Returns the default transport type, which can be chosen per deployment via the "MCP2210_TRANSPORT" environment variable ("libusb", "hidraw", "emulator", "replay" or "socket")
+int MCP2210Transport::defaultType()
+{
+    QByteArray name = qgetenv("MCP2210_TRANSPORT").toLower();
+    int type;
+    if (name == "hidraw") {
+        type = HIDRAW;
+    } else if (name == "emulator") {
+        type = EMULATOR;
+    } else if (name == "replay") {
+        type = REPLAY;
+    } else if (name == "socket") {
+        type = SOCKET;
+    } else {
+        type = LIBUSB;
+    }
+    return type;
+}
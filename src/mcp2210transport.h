@@ -0,0 +1,66 @@
+/* MCP2210 transport interface for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210TRANSPORT_H
+#define MCP2210TRANSPORT_H
+
+// Includes
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Abstract transport used by the MCP2210 class to exchange 64-byte HID reports with the device
+// Implementations must return libusb error codes from interruptTransfer() (e.g. "LIBUSB_ERROR_TIMEOUT" [-7]), and the MCP2210 return codes from open()
+class MCP2210Transport
+{
+public:
+    // Transport types, applicable to create()
+    static const int LIBUSB = 0;  // Transport based on libusb, which detaches the kernel HID driver
+    static const int HIDRAW = 1;  // Transport based on the Linux hidraw interface (no kernel driver detachment required)
+    static const int EMULATOR = 2;  // Software emulated MCP2210, which requires no hardware
+    static const int REPLAY = 3;    // Replay of a trace recorded previously (see RecordingTransport and ReplayTransport)
+    static const int SOCKET = 4;    // Access via the MCP2210 daemon, which allows several processes to share the same device (see SocketTransport)
+
+    // Device found by enumerateDevices()
+    struct DeviceInfo {
+        QString path;          // Physical location of the device, as the bus number followed by the port numbers (e.g. "1-2.3"), or empty if not known
+        int address;           // Device address, which changes whenever the device is attached again (-1 if not known)
+        QString serial;        // Serial number
+        QString manufacturer;  // USB manufacturer string, or empty if not known
+        QString product;       // USB product string, or empty if not known
+    };
+
+    virtual ~MCP2210Transport();
+
+    virtual bool isOpen() const = 0;
+    virtual bool isShared() const;
+
+    virtual void close() = 0;
+    virtual QVector<DeviceInfo> enumerateDevices(quint16 vid, quint16 pid, const QVector<DeviceInfo> &known, int &errcnt, QString &errstr);
+    virtual int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout) = 0;
+    virtual QStringList listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr) = 0;
+    virtual int open(quint16 vid, quint16 pid, const QString &serial) = 0;
+
+    static MCP2210Transport *create();
+    static MCP2210Transport *create(int type);
+    static int defaultType();
+};
+
+#endif  // MCP2210TRANSPORT_H
@@ -0,0 +1,239 @@
+/* MCP2210 health watchdog for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <QElapsedTimer>
+#include <QObject>
+#include "mcp2210watchdog.h"
+
+// Definitions
+const int BASELINE_PROBES = 8;       // Number of successful probes that establish the baseline latency
+const double LATENCY_WEIGHT = 0.25;  // Weight of each new sample in the mean latency
+const int DEFAULT_INTERVAL = 1000;   // Default probing interval, in milliseconds
+
+// Returns a single line summary of the health figures
+QString MCP2210Watchdog::Health::toString() const
+{
+    return QObject::tr("%1 probes (%2 suppressed), %3 failures (%4% recent, %5 consecutive); latency last/mean/baseline %6/%7/%8 us")
+               .arg(probes)
+               .arg(suppressedProbes)
+               .arg(failures)
+               .arg(100 * failureRate, 0, 'f', 1)
+               .arg(consecutiveFailures)
+               .arg(lastLatency)
+               .arg(meanLatency, 0, 'f', 0)
+               .arg(baselineLatency, 0, 'f', 0);
+}
+
+// Private function that determines the health state from the current figures, and emits healthChanged() if it changed
+void MCP2210Watchdog::evaluate()
+{
+    int state;
+    QString reason;
+    if (health_.probes == 0 && health_.suppressedProbes == 0) {
+        state = HSUNKNOWN;
+    } else if (mcp2210_.disconnected()) {
+        state = HSUNRESPONSIVE;
+        reason = tr("Device disconnected.");
+    } else if (health_.consecutiveFailures >= unresponsiveThreshold_) {
+        state = HSUNRESPONSIVE;
+        reason = tr("%1 consecutive probes failed.").arg(health_.consecutiveFailures);
+    } else if (health_.failureRate > failureRateThreshold_) {
+        state = HSDEGRADED;
+        reason = tr("%1% of the recent probes failed.").arg(100 * health_.failureRate, 0, 'f', 1);
+    } else if (health_.baselineLatency > 0 && health_.meanLatency > driftThreshold_ * health_.baselineLatency) {
+        state = HSDEGRADED;
+        reason = tr("Probe latency drifted to %1 us, against a baseline of %2 us.").arg(health_.meanLatency, 0, 'f', 0).arg(health_.baselineLatency, 0, 'f', 0);
+    } else {
+        state = HSHEALTHY;
+        reason = tr("Device responding normally.");
+    }
+    if (state != health_.state) {
+        health_.state = state;
+        emit healthChanged(state, reason);
+    }
+}
+
+// Private function that records the outcome of a liveness check, and updates the failure rate accordingly
+void MCP2210Watchdog::recordOutcome(bool failed)
+{
+    outcomes_[outcomeIndex_] = failed;
+    outcomeIndex_ = (outcomeIndex_ + 1) % FAILURE_WINDOW;
+    if (outcomeCount_ < FAILURE_WINDOW) {
+        ++outcomeCount_;
+    }
+    int failedCount = 0;
+    for (int i = 0; i < outcomeCount_; ++i) {
+        if (outcomes_[i]) {
+            ++failedCount;
+        }
+    }
+    health_.failureRate = static_cast<double>(failedCount) / outcomeCount_;
+}
+
+// Creates a watchdog for the given device, which must remain valid during the lifetime of the watchdog
+// The watchdog is created stopped, with a probing interval of one second
+MCP2210Watchdog::MCP2210Watchdog(MCP2210 &mcp2210, QObject *parent) :
+    QObject(parent),
+    mcp2210_(mcp2210),
+    timer_(this),  // The timer is a child of the watchdog, so that it follows the watchdog when moved to another thread
+    health_(),
+    outcomes_(),
+    outcomeCount_(0),
+    outcomeIndex_(0),
+    baselineSamples_(0),
+    baselineSum_(0),
+    lastExchanges_(0),
+    driftThreshold_(2.0),
+    failureRateThreshold_(0.1),
+    unresponsiveThreshold_(3)
+{
+    health_.state = HSUNKNOWN;
+    timer_.setInterval(DEFAULT_INTERVAL);
+    connect(&timer_, &QTimer::timeout, this, &MCP2210Watchdog::check);
+}
+
+// Returns the ratio between the mean and the baseline latencies above which the device is considered degraded
+double MCP2210Watchdog::driftThreshold() const
+{
+    return driftThreshold_;
+}
+
+// Returns the recent failure rate above which the device is considered degraded
+double MCP2210Watchdog::failureRateThreshold() const
+{
+    return failureRateThreshold_;
+}
+
+// Returns the current health figures
+MCP2210Watchdog::Health MCP2210Watchdog::health() const
+{
+    return health_;
+}
+
+// Returns the probing interval, in milliseconds
+int MCP2210Watchdog::interval() const
+{
+    return timer_.interval();
+}
+
+// Checks if the watchdog is running
+bool MCP2210Watchdog::isActive() const
+{
+    return timer_.isActive();
+}
+
+// Returns the current health state (see "HS" values)
+int MCP2210Watchdog::state() const
+{
+    return health_.state;
+}
+
+// Returns the number of consecutive failed probes above which the device is considered unresponsive
+int MCP2210Watchdog::unresponsiveThreshold() const
+{
+    return unresponsiveThreshold_;
+}
+
+// Discards the baseline latency, so that it gets established again from the next probes (e.g. after changing the USB topology)
+void MCP2210Watchdog::resetBaseline()
+{
+    baselineSamples_ = 0;
+    baselineSum_ = 0;
+    health_.baselineLatency = 0;
+}
+
+// Sets the ratio between the mean and the baseline latencies above which the device is considered degraded (2.0 by default)
+void MCP2210Watchdog::setDriftThreshold(double ratio)
+{
+    driftThreshold_ = ratio < 1.0 ? 1.0 : ratio;
+}
+
+// Sets the recent failure rate above which the device is considered degraded (0.1 by default, so that a single failure among the last 16 probes is tolerated)
+void MCP2210Watchdog::setFailureRateThreshold(double rate)
+{
+    failureRateThreshold_ = rate < 0.0 ? 0.0 : rate;
+}
+
+// Sets the probing interval, in milliseconds
+// Since probes are suppressed whenever other commands succeed in between, an idle device is probed at most once per interval, while a busy one is not probed at all
+void MCP2210Watchdog::setInterval(int interval)
+{
+    timer_.setInterval(interval < 1 ? 1 : interval);
+}
+
+// Sets the number of consecutive failed probes above which the device is considered unresponsive (3 by default)
+void MCP2210Watchdog::setUnresponsiveThreshold(int failures)
+{
+    unresponsiveThreshold_ = failures < 1 ? 1 : failures;
+}
+
+// Starts the watchdog, which checks the device for the first time after one interval
+void MCP2210Watchdog::start()
+{
+    lastExchanges_ = mcp2210_.completedExchanges();
+    timer_.start();
+}
+
+// Stops the watchdog (health figures are preserved)
+void MCP2210Watchdog::stop()
+{
+    timer_.stop();
+}
+
+// Checks the device, probing it only if no other commands succeeded since the last check
+void MCP2210Watchdog::check()
+{
+    quint64 exchanges = mcp2210_.completedExchanges();
+    if (exchanges != lastExchanges_) {  // Other traffic already proved that the device is alive
+        lastExchanges_ = exchanges;
+        ++health_.suppressedProbes;
+        health_.consecutiveFailures = 0;
+        recordOutcome(false);
+    } else {
+        int errcnt = 0;
+        QString errstr;
+        QElapsedTimer timer;
+        timer.start();
+        mcp2210_.getChipStatus(errcnt, errstr);
+        qint64 latency = timer.nsecsElapsed() / 1000;
+        ++health_.probes;
+        if (errcnt > 0) {
+            ++health_.failures;
+            ++health_.consecutiveFailures;
+            recordOutcome(true);
+            emit probeFailed(errstr);
+        } else {
+            health_.consecutiveFailures = 0;
+            health_.lastLatency = latency;
+            health_.meanLatency = health_.meanLatency == 0 ? latency : health_.meanLatency + LATENCY_WEIGHT * (latency - health_.meanLatency);
+            if (baselineSamples_ < BASELINE_PROBES) {
+                baselineSum_ += latency;
+                ++baselineSamples_;
+                if (baselineSamples_ == BASELINE_PROBES) {
+                    health_.baselineLatency = baselineSum_ / BASELINE_PROBES;
+                }
+            }
+            recordOutcome(false);
+        }
+        lastExchanges_ = mcp2210_.completedExchanges();  // The probe itself must not count as other traffic
+    }
+    evaluate();
+}
@@ -0,0 +1,109 @@
+/* MCP2210 health watchdog for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef MCP2210WATCHDOG_H
+#define MCP2210WATCHDOG_H
+
+// Includes
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "mcp2210.h"
+
+// Watchdog that detects hung or dropped devices before production traffic does, by probing idle devices in the background
+// At every interval, the device is probed via "GET_CHIP_STATUS", unless other commands got valid responses since the last check, in which case the probe is suppressed
+// Probe latencies are compared against a baseline taken from the first probes, and failures are tracked over the last probes, so that latency drift and rising failure rates are reported as health changes
+// Since a probe blocks for up to the transfer timeout, the watchdog should live in a worker thread if the device is used by a GUI, in which case the MCP2210 object must be in thread-safe mode
+class MCP2210Watchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Class definitions
+    static const int FAILURE_WINDOW = 16;  // Number of recent probes over which the failure rate is measured
+
+    // The following values are applicable to state() and healthChanged()
+    static const int HSUNKNOWN = 0;       // No probes were sent yet
+    static const int HSHEALTHY = 1;       // The device responds within the expected latency
+    static const int HSDEGRADED = 2;      // Probe latency drifted above the threshold, or some recent probes failed
+    static const int HSUNRESPONSIVE = 3;  // Several consecutive probes failed, or the device was disconnected
+
+    struct Health {
+        int state;                  // Health state (see "HS" values)
+        quint64 probes;             // Number of probes sent
+        quint64 suppressedProbes;   // Number of probes that were not sent, because other traffic proved that the device was alive
+        quint64 failures;           // Number of probes that failed (including timeouts)
+        int consecutiveFailures;    // Number of probes that failed in a row
+        double failureRate;         // Fraction of the last probes (up to FAILURE_WINDOW) that failed
+        qint64 lastLatency;         // Latency of the last successful probe, in microseconds
+        double meanLatency;         // Exponentially weighted mean latency of recent successful probes, in microseconds
+        double baselineLatency;     // Mean latency of the first successful probes, in microseconds (zero until established)
+
+        QString toString() const;
+    };
+
+private:
+    MCP2210 &mcp2210_;
+    QTimer timer_;
+    Health health_;
+    bool outcomes_[FAILURE_WINDOW];  // Failed probes, as a circular buffer
+    int outcomeCount_;
+    int outcomeIndex_;
+    int baselineSamples_;
+    double baselineSum_;
+    quint64 lastExchanges_;
+    double driftThreshold_;
+    double failureRateThreshold_;
+    int unresponsiveThreshold_;
+
+    void evaluate();
+    void recordOutcome(bool failed);
+
+public:
+    explicit MCP2210Watchdog(MCP2210 &mcp2210, QObject *parent = nullptr);
+    MCP2210Watchdog(const MCP2210Watchdog &) = delete;
+
+    MCP2210Watchdog &operator =(const MCP2210Watchdog &) = delete;
+
+    double driftThreshold() const;
+    double failureRateThreshold() const;
+    Health health() const;
+    int interval() const;
+    bool isActive() const;
+    int state() const;
+    int unresponsiveThreshold() const;
+
+    void resetBaseline();
+    void setDriftThreshold(double ratio);
+    void setFailureRateThreshold(double rate);
+    void setInterval(int interval);
+    void setUnresponsiveThreshold(int failures);
+    void start();
+    void stop();
+
+signals:
+    void healthChanged(int state, const QString &reason);
+    void probeFailed(const QString &errstr);
+
+private slots:
+    void check();
+};
+
+#endif  // MCP2210WATCHDOG_H
@@ -0,0 +1,135 @@
+/* HID traffic recording transport for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cstring>
+#include <QDir>
+#include <QFileInfo>
+#include <QIODevice>
+#include "mcp2210.h"
+#include "recordingtransport.h"
+
+// Number of traces created by this process so far
+QAtomicInteger<int> RecordingTransport::traceCount_;
+
+// Wraps the given transport, taking ownership of it
+// The trace file is only created (or truncated) when the device is first opened, so that instances used solely for listing devices leave it untouched
+// Since every instance records to its own trace, only the first trace created by the process gets the given file name (see startTrace())
+RecordingTransport::RecordingTransport(MCP2210Transport *transport, const QString &fileName) :
+    transport_(transport),
+    file_(fileName)
+{
+    stream_.setByteOrder(QDataStream::LittleEndian);
+    stream_.setVersion(QDataStream::Qt_5_0);
+}
+
+RecordingTransport::~RecordingTransport()
+{
+    close();
+    file_.close();  // Also flushes any buffered records
+    delete transport_;
+}
+
+// Checks if the underlying transport is open
+bool RecordingTransport::isOpen() const
+{
+    return transport_->isOpen();
+}
+
+// Checks if the underlying transport is shared among processes
+bool RecordingTransport::isShared() const
+{
+    return transport_->isShared();
+}
+
+// Closes the underlying transport, recording the event
+void RecordingTransport::close()
+{
+    if (transport_->isOpen()) {
+        transport_->close();
+        if (file_.isOpen()) {
+            stream_ << RECORD_CLOSE << static_cast<quint64>(clock_.nsecsElapsed());
+            file_.flush();
+        }
+    }
+}
+
+// Enumerates devices via the underlying transport (not recorded)
+QVector<MCP2210Transport::DeviceInfo> RecordingTransport::enumerateDevices(quint16 vid, quint16 pid, const QVector<DeviceInfo> &known, int &errcnt, QString &errstr)
+{
+    return transport_->enumerateDevices(vid, pid, known, errcnt, errstr);
+}
+
+// Performs an interrupt transfer via the underlying transport, recording the packet as well as the result
+// For IN transfers, the packet is recorded as received, while for OUT transfers it is recorded as sent
+int RecordingTransport::interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    int bytes = 0;
+    int result = transport_->interruptTransfer(endpointAddr, data, length, &bytes, timeout);
+    if (transferred != nullptr) {
+        *transferred = bytes;
+    }
+    if (file_.isOpen()) {
+        unsigned char packet[MCP2210::COMMAND_SIZE] = {0x00};  // Packets are always recorded with 64 bytes, padded with zeros if needed
+        std::memcpy(packet, data, length < static_cast<int>(MCP2210::COMMAND_SIZE) ? static_cast<size_t>(length) : MCP2210::COMMAND_SIZE);
+        stream_ << RECORD_TRANSFER << static_cast<quint64>(clock_.nsecsElapsed()) << endpointAddr << static_cast<qint32>(result) << static_cast<quint8>(bytes);
+        stream_.writeRawData(reinterpret_cast<const char *>(packet), static_cast<int>(MCP2210::COMMAND_SIZE));
+    }
+    return result;
+}
+
+// Lists devices via the underlying transport (not recorded)
+QStringList RecordingTransport::listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr)
+{
+    return transport_->listDevices(vid, pid, errcnt, errstr);
+}
+
+// Opens the device via the underlying transport, recording the event along with its result
+int RecordingTransport::open(quint16 vid, quint16 pid, const QString &serial)
+{
+    int retval = transport_->open(vid, pid, serial);
+    if (file_.isOpen() || startTrace()) {  // Failing to create the trace does not prevent the device from being used
+        stream_ << RECORD_OPEN << static_cast<quint64>(clock_.nsecsElapsed()) << static_cast<qint32>(retval) << vid << pid << serial;
+        file_.flush();
+    }
+    return retval;
+}
+
+// Private function that creates the trace file and writes its header
+// The first trace created by the process uses the given file name, while the following ones get a sequence number appended to their base name (e.g. "session.m2ht", "session-2.m2ht", "session-3.m2ht" and so on), so that no trace overwrites another
+bool RecordingTransport::startTrace()
+{
+    int number = traceCount_.fetchAndAddOrdered(1) + 1;
+    if (number > 1) {
+        QFileInfo fileInfo(file_.fileName());
+        QString fileName = QString("%1-%2").arg(fileInfo.completeBaseName()).arg(number);
+        if (!fileInfo.suffix().isEmpty()) {
+            fileName += "." + fileInfo.suffix();
+        }
+        file_.setFileName(fileInfo.dir().filePath(fileName));
+    }
+    bool retval = file_.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (retval) {
+        stream_.setDevice(&file_);
+        stream_ << TRACE_MAGIC << TRACE_VERSION;
+        clock_.start();
+    }
+    return retval;
+}
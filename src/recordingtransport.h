@@ -0,0 +1,71 @@
+/* HID traffic recording transport for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef RECORDINGTRANSPORT_H
+#define RECORDINGTRANSPORT_H
+
+// Includes
+#include <QAtomicInteger>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include "mcp2210transport.h"
+
+// Transport that wraps another transport, logging every 64-byte OUT/IN packet to a compact binary trace that can be served later by ReplayTransport
+// Trace format (little endian): 4-byte magic, 2-byte version, then a sequence of records, each starting with a 1-byte type and an 8-byte timestamp in nanoseconds
+// - Open record: 4-byte result, 2-byte VID, 2-byte PID, serial number (serialized QString);
+// - Close record: no further fields;
+// - Transfer record: 1-byte endpoint address, 4-byte libusb result, 1-byte transferred length, 64-byte packet.
+class RecordingTransport : public MCP2210Transport
+{
+private:
+    MCP2210Transport *transport_;
+    QFile file_;
+    QDataStream stream_;
+    QElapsedTimer clock_;
+
+    static QAtomicInteger<int> traceCount_;
+
+    bool startTrace();
+
+public:
+    // Trace format constants
+    static const quint32 TRACE_MAGIC = 0x5448324d;  // "M2HT" in little endian
+    static const quint16 TRACE_VERSION = 1;
+    static const quint8 RECORD_OPEN = 0x01;
+    static const quint8 RECORD_CLOSE = 0x02;
+    static const quint8 RECORD_TRANSFER = 0x03;
+
+    RecordingTransport(MCP2210Transport *transport, const QString &fileName);
+    ~RecordingTransport();
+
+    bool isOpen() const;
+    bool isShared() const;
+
+    void close();
+    QVector<DeviceInfo> enumerateDevices(quint16 vid, quint16 pid, const QVector<DeviceInfo> &known, int &errcnt, QString &errstr);
+    int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout);
+    QStringList listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr);
+    int open(quint16 vid, quint16 pid, const QString &serial);
+};
+
+#endif  // RECORDINGTRANSPORT_H
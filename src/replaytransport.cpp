@@ -0,0 +1,211 @@
+/* HID traffic replay transport for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cstring>
+#include <QDataStream>
+#include <QFile>
+#include <QIODevice>
+#include <QObject>
+#include <libusb-1.0/libusb.h>
+#include "mcp2210.h"
+#include "recordingtransport.h"
+#include "replaytransport.h"
+
+ReplayTransport::ReplayTransport() :
+    position_(0),
+    isOpen_(false),
+    looping_(false),
+    mismatches_(0)
+{
+}
+
+// Checks if the replayed device is open
+bool ReplayTransport::isOpen() const
+{
+    return isOpen_;
+}
+
+// Returns the number of OUT packets that differed from the recorded ones, or that were issued out of sequence
+quint32 ReplayTransport::mismatches() const
+{
+    return mismatches_;
+}
+
+// Closes the replayed device
+void ReplayTransport::close()
+{
+    isOpen_ = false;
+}
+
+// Serves the next recorded transfer
+// OUT packets are compared against the recorded ones, and any differences are counted as mismatches (see mismatches()), but the replay carries on
+// When the trace is exhausted, "LIBUSB_ERROR_NO_DEVICE" is returned, unless looping is enabled
+int ReplayTransport::interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    Q_UNUSED(timeout);
+    int result;
+    if (!isOpen_) {
+        result = LIBUSB_ERROR_NO_DEVICE;
+    } else {
+        int recordCount = records_.size();
+        while (position_ < recordCount && records_[position_].type != RecordingTransport::RECORD_TRANSFER) {
+            ++position_;
+        }
+        if (position_ == recordCount && looping_) {  // Restart from the first transfer
+            position_ = 0;
+            while (position_ < recordCount && records_[position_].type != RecordingTransport::RECORD_TRANSFER) {
+                ++position_;
+            }
+        }
+        if (position_ == recordCount) {
+            result = LIBUSB_ERROR_NO_DEVICE;
+        } else {
+            const Record &record = records_[position_];
+            ++position_;
+            size_t size = length < static_cast<int>(MCP2210::COMMAND_SIZE) ? static_cast<size_t>(length) : MCP2210::COMMAND_SIZE;
+            if (record.endpointAddr != endpointAddr) {  // The replay has diverged from the recorded session
+                ++mismatches_;
+                result = LIBUSB_ERROR_IO;
+                if (transferred != nullptr) {
+                    *transferred = 0;
+                }
+            } else {
+                if (endpointAddr < 0x80) {  // OUT direction
+                    if (std::memcmp(data, record.packet, size) != 0) {
+                        ++mismatches_;
+                    }
+                } else {  // IN direction
+                    std::memcpy(data, record.packet, size);
+                }
+                result = record.result;
+                if (transferred != nullptr) {
+                    *transferred = record.transferred;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Lists the serial numbers of the devices opened during the recorded session, for the given VID and PID
+QStringList ReplayTransport::listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr)
+{
+    Q_UNUSED(errcnt);
+    Q_UNUSED(errstr);
+    QStringList devices;
+    for (const Record &record : records_) {
+        if (record.type == RecordingTransport::RECORD_OPEN && record.vid == vid && record.pid == pid && !record.serial.isNull() && !devices.contains(record.serial)) {
+            devices += record.serial;
+        }
+    }
+    return devices;
+}
+
+// Loads a trace produced by RecordingTransport, replacing any previously loaded trace and rewinding the replay
+void ReplayTransport::load(const QString &fileName, int &errcnt, QString &errstr)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        ++errcnt;
+        errstr += QObject::tr("Could not open trace file.\n");
+    } else {
+        QDataStream stream(&file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.setVersion(QDataStream::Qt_5_0);
+        quint32 magic;
+        quint16 version;
+        stream >> magic >> version;
+        if (stream.status() != QDataStream::Ok || magic != RecordingTransport::TRACE_MAGIC || version != RecordingTransport::TRACE_VERSION) {
+            ++errcnt;
+            errstr += QObject::tr("Invalid trace file.\n");
+        } else {
+            QVector<Record> records;
+            while (!stream.atEnd() && stream.status() == QDataStream::Ok) {
+                Record record;
+                std::memset(record.packet, 0x00, sizeof(record.packet));
+                record.result = 0;
+                record.endpointAddr = record.transferred = 0;
+                record.vid = record.pid = 0;
+                stream >> record.type >> record.timestamp;
+                if (record.type == RecordingTransport::RECORD_OPEN) {
+                    stream >> record.result >> record.vid >> record.pid >> record.serial;
+                } else if (record.type == RecordingTransport::RECORD_TRANSFER) {
+                    stream >> record.endpointAddr >> record.result >> record.transferred;
+                    stream.readRawData(reinterpret_cast<char *>(record.packet), static_cast<int>(sizeof(record.packet)));
+                } else if (record.type != RecordingTransport::RECORD_CLOSE) {
+                    stream.setStatus(QDataStream::ReadCorruptData);
+                }
+                if (stream.status() == QDataStream::Ok) {
+                    records.push_back(record);
+                }
+            }
+            if (stream.status() == QDataStream::ReadCorruptData) {  // Note that a truncated final record is tolerated, since the recording may have been interrupted
+                ++errcnt;
+                errstr += QObject::tr("Invalid trace file.\n");
+            } else {
+                records_ = records;
+                isOpen_ = false;
+                rewind();
+            }
+        }
+    }
+}
+
+// Opens the replayed device, returning the result of the next recorded open event
+// If there are no more open events ahead, the replay restarts from the beginning of the trace
+int ReplayTransport::open(quint16 vid, quint16 pid, const QString &serial)
+{
+    int recordCount = records_.size();
+    int index = position_;
+    while (index < recordCount && records_[index].type != RecordingTransport::RECORD_OPEN) {
+        ++index;
+    }
+    if (index == recordCount) {
+        index = 0;
+        while (index < recordCount && records_[index].type != RecordingTransport::RECORD_OPEN) {
+            ++index;
+        }
+    }
+    int retval;
+    if (index == recordCount || records_[index].vid != vid || records_[index].pid != pid || (!serial.isNull() && serial != records_[index].serial)) {
+        retval = MCP2210::ERROR_NOT_FOUND;
+    } else {
+        position_ = index + 1;
+        retval = records_[index].result;
+        isOpen_ = retval == MCP2210::SUCCESS;
+        mismatches_ = 0;
+    }
+    return retval;
+}
+
+// Restarts the replay from the beginning of the trace
+void ReplayTransport::rewind()
+{
+    position_ = 0;
+    mismatches_ = 0;
+}
+
+// Enables or disables looping, which restarts the replay of transfers whenever the end of the trace is reached
+// This is useful for benchmarking, since a short recorded session can then be replayed indefinitely
+void ReplayTransport::setLooping(bool looping)
+{
+    looping_ = looping;
+}
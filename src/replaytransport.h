@@ -0,0 +1,65 @@
+/* HID traffic replay transport for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef REPLAYTRANSPORT_H
+#define REPLAYTRANSPORT_H
+
+// Includes
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "mcp2210transport.h"
+
+// Transport that serves the responses recorded by RecordingTransport, so that a session can be reproduced deterministically without hardware
+// The whole trace is loaded into memory beforehand, in order to keep file I/O out of the measured code paths
+class ReplayTransport : public MCP2210Transport
+{
+private:
+    struct Record {
+        quint8 type;
+        quint64 timestamp;
+        qint32 result;
+        quint8 endpointAddr, transferred;
+        quint16 vid, pid;
+        QString serial;
+        unsigned char packet[64];
+    };
+
+    QVector<Record> records_;
+    int position_;
+    bool isOpen_, looping_;
+    quint32 mismatches_;
+
+public:
+    ReplayTransport();
+
+    bool isOpen() const;
+    quint32 mismatches() const;
+
+    void close();
+    int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout);
+    QStringList listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr);
+    void load(const QString &fileName, int &errcnt, QString &errstr);
+    int open(quint16 vid, quint16 pid, const QString &serial);
+    void rewind();
+    void setLooping(bool looping);
+};
+
+#endif  // REPLAYTRANSPORT_H
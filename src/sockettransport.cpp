@@ -0,0 +1,275 @@
+/* MCP2210 socket transport for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+// Includes
+#include <cstring>
+#include <QFile>
+#include <QObject>
+#include <libusb-1.0/libusb.h>
+#include "mcp2210.h"
+#include "mcp2210protocol.h"
+#include "sockettransport.h"
+
+// Definitions
+const int BATCH_TIMEOUT = 500;     // Time allowed per HID command within a batch, in milliseconds
+const int CONNECT_TIMEOUT = 1000;  // Timeout for connecting to the daemon, in milliseconds
+const int QUEUE_TIMEOUT = 2000;    // Additional time allowed for HID commands, since the daemon may be serving other clients, in milliseconds
+const int REQUEST_TIMEOUT = 5000;  // Timeout for "LIST" and "OPEN" requests, in milliseconds
+
+// Private function that is used to connect to the daemon, if not connected already
+bool SocketTransport::connectToServer()
+{
+    if (socket_.state() != QLocalSocket::ConnectedState) {
+        buffer_.clear();
+        outstanding_ = 0;
+        socket_.connectToServer(serverName_);
+        socket_.waitForConnected(CONNECT_TIMEOUT);
+    }
+    return socket_.state() == QLocalSocket::ConnectedState;
+}
+
+// Private function that is used to wait for an answer of the given type
+// Stale "TRANSFER" answers (i.e., answers to commands that timed out previously) are discarded, so that answers are always matched to the right request
+bool SocketTransport::receiveFrame(quint8 type, QByteArray &payload, int timeout)
+{
+    bool received = false;
+    bool failed = false;
+    while (!received && !failed) {
+        quint8 frameType;
+        int result = MCP2210Protocol::takeFrame(buffer_, frameType, payload);
+        if (result == MCP2210Protocol::FRTAKEN) {
+            if (frameType == MCP2210Protocol::TRANSFER && outstanding_ > 0) {
+                --outstanding_;
+            }
+            received = frameType == type && (type != MCP2210Protocol::TRANSFER || outstanding_ == 0);
+        } else if (result == MCP2210Protocol::FRINVALID || !socket_.waitForReadyRead(timeout)) {
+            failed = true;
+        } else {
+            buffer_ += socket_.readAll();
+        }
+    }
+    return received;
+}
+
+// Uses the server name given by the "MCP2210_SOCKET" environment variable, or the default server name, if the former is not set
+SocketTransport::SocketTransport() :
+    open_(false),
+    outstanding_(0)
+{
+    serverName_ = QFile::decodeName(qgetenv("MCP2210_SOCKET"));
+    if (serverName_.isEmpty()) {
+        serverName_ = MCP2210Protocol::DEFAULT_SERVER;
+    }
+}
+
+// Uses the given server name (either a name or the path of a socket file)
+SocketTransport::SocketTransport(const QString &serverName) :
+    serverName_(serverName),
+    open_(false),
+    outstanding_(0)
+{
+}
+
+SocketTransport::~SocketTransport()
+{
+    close();
+}
+
+// Checks if the device is open, from the perspective of the daemon
+bool SocketTransport::isOpen() const
+{
+    return open_ && socket_.state() == QLocalSocket::ConnectedState;
+}
+
+// Checks if the device is shared among processes, which is always the case, since access is arbitrated by the daemon
+bool SocketTransport::isShared() const
+{
+    return true;
+}
+
+// Returns the name of the server used to reach the daemon
+QString SocketTransport::serverName() const
+{
+    return serverName_;
+}
+
+// Sends a batch of HID commands, which are executed by the daemon atomically (i.e., without interleaving commands from other clients), and returns the responses
+// Each command vector is padded or truncated to 64 bytes, as done by MCP2210::hidTransfer()
+// If an error occurs, the returned vector will be shorter than expected
+QVector<QVector<quint8>> SocketTransport::batchTransfer(const QVector<QVector<quint8>> &commands, int &errcnt, QString &errstr)
+{
+    QVector<QVector<quint8>> responses;
+    int count = commands.size();
+    if (count > MCP2210Protocol::BATCH_MAXSIZE) {
+        ++errcnt;
+        errstr += QObject::tr("In batchTransfer(): batch cannot have more than %1 commands.\n").arg(MCP2210Protocol::BATCH_MAXSIZE);  // Program logic error
+    } else if (!isOpen()) {
+        ++errcnt;
+        errstr += QObject::tr("In batchTransfer(): device is not open.\n");  // Program logic error
+    } else if (count > 0) {
+        QByteArray request(count * MCP2210Protocol::PACKET_SIZE, 0x00);
+        for (int i = 0; i < count; ++i) {
+            int size = qMin(commands[i].size(), MCP2210Protocol::PACKET_SIZE);
+            for (int j = 0; j < size; ++j) {
+                request[i * MCP2210Protocol::PACKET_SIZE + j] = static_cast<char>(commands[i][j]);
+            }
+        }
+        socket_.write(MCP2210Protocol::buildFrame(MCP2210Protocol::TRANSFER, request));
+        socket_.flush();
+        ++outstanding_;
+        QByteArray payload;
+        int answerSize = count * (MCP2210Protocol::RESULT_SIZE + MCP2210Protocol::PACKET_SIZE);
+        if (!receiveFrame(MCP2210Protocol::TRANSFER, payload, count * BATCH_TIMEOUT + QUEUE_TIMEOUT) || payload.size() != answerSize) {
+            ++errcnt;
+            errstr += QObject::tr("Failed batch transfer via the MCP2210 daemon.\n");
+        } else {
+            for (int i = 0; i < count; ++i) {
+                int offset = i * (MCP2210Protocol::RESULT_SIZE + MCP2210Protocol::PACKET_SIZE);
+                if (static_cast<int>(MCP2210Protocol::readUInt32(payload, offset)) != 0) {  // The command failed, so the batch is truncated at this point
+                    ++errcnt;
+                    errstr += QObject::tr("Failed HID command %1 of %2 within batch transfer.\n").arg(i + 1).arg(count);
+                    break;
+                }
+                QVector<quint8> response(MCP2210Protocol::PACKET_SIZE);
+                std::memcpy(response.data(), payload.constData() + offset + MCP2210Protocol::RESULT_SIZE, MCP2210Protocol::PACKET_SIZE);
+                responses += response;
+            }
+        }
+    }
+    return responses;
+}
+
+// Closes the device and disconnects from the daemon
+void SocketTransport::close()
+{
+    if (socket_.state() == QLocalSocket::ConnectedState) {
+        if (open_) {
+            socket_.write(MCP2210Protocol::buildFrame(MCP2210Protocol::CLOSE, QByteArray()));
+            socket_.flush();
+        }
+        socket_.disconnectFromServer();
+    }
+    open_ = false;
+}
+
+// Forwards a HID command to the daemon (OUT direction), or receives the corresponding response (IN direction)
+// Errors are reported using libusb error codes, as required, and the loss of the connection to the daemon is reported as a disconnection
+int SocketTransport::interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+    int result;
+    if (transferred != nullptr) {
+        *transferred = 0;
+    }
+    if (!isOpen()) {
+        result = LIBUSB_ERROR_NO_DEVICE;
+    } else if (endpointAddr < 0x80) {  // OUT direction
+        QByteArray packet(MCP2210Protocol::PACKET_SIZE, 0x00);
+        std::memcpy(packet.data(), data, static_cast<size_t>(qMin(length, MCP2210Protocol::PACKET_SIZE)));
+        socket_.write(MCP2210Protocol::buildFrame(MCP2210Protocol::TRANSFER, packet));
+        socket_.flush();
+        ++outstanding_;
+        if (transferred != nullptr) {
+            *transferred = length;
+        }
+        result = 0;
+    } else if (outstanding_ == 0) {  // No command was sent, so no response will ever arrive
+        result = LIBUSB_ERROR_TIMEOUT;
+    } else {
+        QByteArray payload;
+        if (receiveFrame(MCP2210Protocol::TRANSFER, payload, static_cast<int>(timeout) + QUEUE_TIMEOUT) && payload.size() == MCP2210Protocol::RESULT_SIZE + MCP2210Protocol::PACKET_SIZE) {
+            result = static_cast<int>(MCP2210Protocol::readUInt32(payload, 0));
+            if (result == 0) {
+                int size = qMin(length, MCP2210Protocol::PACKET_SIZE);
+                std::memcpy(data, payload.constData() + MCP2210Protocol::RESULT_SIZE, static_cast<size_t>(size));
+                if (transferred != nullptr) {
+                    *transferred = size;
+                }
+            }
+        } else if (socket_.state() != QLocalSocket::ConnectedState) {
+            open_ = false;
+            result = LIBUSB_ERROR_NO_DEVICE;
+        } else {
+            result = LIBUSB_ERROR_TIMEOUT;  // The answer may still arrive later, in which case it will be discarded
+        }
+    }
+    return result;
+}
+
+// Retrieves the serial numbers of all devices having the given VID and PID, as seen by the daemon
+QStringList SocketTransport::listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr)
+{
+    QStringList devices;
+    bool wasConnected = socket_.state() == QLocalSocket::ConnectedState;
+    if (!connectToServer()) {
+        ++errcnt;
+        errstr += QObject::tr("Could not connect to the MCP2210 daemon.\n");
+    } else {
+        QByteArray request;
+        MCP2210Protocol::appendUInt16(request, vid);
+        MCP2210Protocol::appendUInt16(request, pid);
+        socket_.write(MCP2210Protocol::buildFrame(MCP2210Protocol::LIST, request));
+        socket_.flush();
+        QByteArray payload;
+        if (!receiveFrame(MCP2210Protocol::LIST, payload, REQUEST_TIMEOUT) || payload.isEmpty()) {
+            ++errcnt;
+            errstr += QObject::tr("Failed to retrieve a list of devices from the MCP2210 daemon.\n");
+        } else if (static_cast<quint8>(payload.at(0)) != MCP2210Protocol::STOK) {
+            ++errcnt;
+            errstr += QString::fromUtf8(payload.mid(1));
+        } else if (payload.size() > 1) {
+            devices = QString::fromUtf8(payload.mid(1)).split('\n');
+        }
+        if (!wasConnected) {
+            socket_.disconnectFromServer();
+        }
+    }
+    return devices;
+}
+
+// Opens the device having the given VID, PID and, optionally, the given serial number, via the daemon
+// If the daemon is not running, "ERROR_INIT" [1] is returned, since this is the equivalent of a failed transport initialization
+int SocketTransport::open(quint16 vid, quint16 pid, const QString &serial)
+{
+    int retval;
+    if (isOpen()) {  // Just in case the calling algorithm tries to open a device that was already sucessfully open
+        retval = MCP2210::SUCCESS;
+    } else if (!connectToServer()) {
+        retval = MCP2210::ERROR_INIT;
+    } else {
+        QByteArray request;
+        MCP2210Protocol::appendUInt16(request, vid);
+        MCP2210Protocol::appendUInt16(request, pid);
+        request += serial.toUtf8();
+        socket_.write(MCP2210Protocol::buildFrame(MCP2210Protocol::OPEN, request));
+        socket_.flush();
+        QByteArray payload;
+        if (!receiveFrame(MCP2210Protocol::OPEN, payload, REQUEST_TIMEOUT) || payload.size() != MCP2210Protocol::RESULT_SIZE) {
+            retval = MCP2210::ERROR_INIT;
+        } else {
+            retval = static_cast<int>(MCP2210Protocol::readUInt32(payload, 0));
+        }
+        if (retval == MCP2210::SUCCESS) {
+            open_ = true;
+        } else {
+            socket_.disconnectFromServer();
+        }
+    }
+    return retval;
+}
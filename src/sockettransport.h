@@ -0,0 +1,63 @@
+/* MCP2210 socket transport for Qt - Version 1.0.0
+   Copyright (c) 2024 Samuel Lourenço
+
+   This library is free software: you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+   License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library.  If not, see <https://www.gnu.org/licenses/>.
+
+
+   Please feel free to contact me via e-mail: samuel.fmlourenco@gmail.com */
+
+
+#ifndef SOCKETTRANSPORT_H
+#define SOCKETTRANSPORT_H
+
+// Includes
+#include <QByteArray>
+#include <QLocalSocket>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "mcp2210transport.h"
+
+// Transport that accesses MCP2210 devices through the MCP2210 daemon (mcp2210d), so that several processes can share the same device
+// Each HID command is forwarded to the daemon, which arbitrates between clients and owns the device
+// An MCP2210 object using this transport behaves as a proxy, and can be used exactly as if it was accessing the device directly
+class SocketTransport : public MCP2210Transport
+{
+private:
+    QLocalSocket socket_;
+    QByteArray buffer_;
+    QString serverName_;
+    bool open_;
+    int outstanding_;  // Number of "TRANSFER" requests still awaiting an answer
+
+    bool connectToServer();
+    bool receiveFrame(quint8 type, QByteArray &payload, int timeout);
+
+public:
+    SocketTransport();
+    explicit SocketTransport(const QString &serverName);
+    ~SocketTransport();
+
+    bool isOpen() const;
+    bool isShared() const;
+    QString serverName() const;
+
+    QVector<QVector<quint8>> batchTransfer(const QVector<QVector<quint8>> &commands, int &errcnt, QString &errstr);
+    void close();
+    int interruptTransfer(quint8 endpointAddr, unsigned char *data, int length, int *transferred, unsigned int timeout);
+    QStringList listDevices(quint16 vid, quint16 pid, int &errcnt, QString &errstr);
+    int open(quint16 vid, quint16 pid, const QString &serial);
+};
+
+#endif  // SOCKETTRANSPORT_H
@@ -9,6 +9,11 @@ rmdir --ignore-fail-on-non-empty /usr/local/share/icons/hicolor/128x128
 rmdir --ignore-fail-on-non-empty /usr/local/share/icons/hicolor
 rmdir --ignore-fail-on-non-empty /usr/local/share/icons
 rm -f /usr/local/bin/mcp2210-conf
+rm -f /usr/local/bin/mcp2210d
+echo Removing core library...
+rm -f /usr/local/lib/libmcp2210core.a
+rm -f /usr/local/lib/libmcp2210core.so*
+rm -rf /usr/local/include/mcp2210
 echo Removing source code files...
 rm -rf /usr/local/src/mcp2210-conf
 echo Done!